@@ -38,9 +38,12 @@
 #ifndef LLVM_ANALYSIS_ALIASANALYSIS_H
 #define LLVM_ANALYSIS_ALIASANALYSIS_H
 
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/PassManager.h"
+#include "llvm/IR/ValueHandle.h"
 #include "llvm/Analysis/MemoryLocation.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
 
@@ -185,10 +188,17 @@ class AAResults {
 public:
   // Make these results default constructable and movable. We have to spell
   // these out because MSVC won't synthesize them.
-  AAResults(const TargetLibraryInfo &TLI) : TLI(TLI) {}
+  AAResults(const TargetLibraryInfo &TLI);
   AAResults(AAResults &&Arg);
   ~AAResults();
 
+  /// Handle invalidation events in the new pass manager.
+  ///
+  /// The query cache is dropped whenever the function may have changed, even
+  /// if the pass claimed to preserve the alias analysis results.
+  bool invalidate(Function &F, const PreservedAnalyses &PA,
+                  FunctionAnalysisManager::Invalidator &Inv);
+
   /// Register a specific AA result.
   template <typename AAResultT> void addAAResult(AAResultT &AAResult) {
     // FIXME: We should use a much lighter weight system than the usual
@@ -257,6 +267,38 @@ public:
     return pointsToConstantMemory(MemoryLocation(P), OrLocal);
   }
 
+  /// @}
+  //===--------------------------------------------------------------------===//
+  /// \name Alias query cache
+  /// @{
+
+  /// Enable or disable caching of top-level \c alias results.
+  ///
+  /// While enabled, the result of each top-level \c alias query is remembered
+  /// until the function is modified, so repeated queries from one or more
+  /// passes are answered without walking the chain of AA results. The initial
+  /// setting comes from the -enable-aa-query-cache option.
+  ///
+  /// The results built for the legacy pass manager start with the cache
+  /// disabled: a legacy pass that preserves the alias analysis may still
+  /// change the IR without telling it. Clients that enable the cache on such
+  /// results must call \c clearQueryCache after changing the IR.
+  void setQueryCacheEnabled(bool Enable) {
+    QueryCacheEnabled = Enable;
+    if (!Enable)
+      clearQueryCache();
+  }
+
+  /// Return true if top-level \c alias results are being cached.
+  bool isQueryCacheEnabled() const { return QueryCacheEnabled; }
+
+  /// Drop all cached alias results.
+  ///
+  /// Transformations that mutate instructions in place in a way that changes
+  /// the memory they refer to, while preserving the alias analysis, must call
+  /// this. Deleting a queried value clears the cache automatically.
+  void clearQueryCache();
+
   /// @}
   //===--------------------------------------------------------------------===//
   /// \name Simple mod/ref information
@@ -606,9 +648,49 @@ private:
 
   template <typename T> friend class AAResultBase;
 
+  /// A value handle that marks the query cache stale once a value used as a
+  /// key is deleted, so that a new value at the same address cannot pick up
+  /// a stale result.
+  class QueryCacheVH final : public CallbackVH {
+    AAResults *AAR;
+
+    void deleted() override {
+      AAR->QueryCacheStale = true;
+      CallbackVH::deleted();
+    }
+
+  public:
+    QueryCacheVH(const Value *V, AAResults *AAR)
+        : CallbackVH(const_cast<Value *>(V)), AAR(AAR) {}
+  };
+
+  /// Make sure the deletion of \p V invalidates the query cache.
+  void trackQueryCacheValue(const Value *V);
+
+  /// Ask each registered AA result in turn, bypassing the query cache.
+  AliasResult aliasUncached(const MemoryLocation &LocA,
+                            const MemoryLocation &LocB);
+
   const TargetLibraryInfo &TLI;
 
   std::vector<std::unique_ptr<Concept>> AAs;
+
+  typedef std::pair<MemoryLocation, MemoryLocation> LocPair;
+  SmallDenseMap<LocPair, AliasResult, 8> AliasQueryCache;
+
+  /// The pointers used in AliasQueryCache keys and their deletion handles.
+  SmallPtrSet<const Value *, 16> QueryCacheValues;
+  std::vector<QueryCacheVH> QueryCacheHandles;
+
+  /// Nesting depth of \c alias calls. AA results may issue nested queries
+  /// whose answers depend on their own in-flight assumptions, so only
+  /// queries made at depth zero are cached.
+  unsigned QueryDepth;
+
+  bool QueryCacheEnabled;
+
+  /// Set when a value used in a cache key was deleted.
+  bool QueryCacheStale;
 };
 
 /// Temporary typedef for legacy code that uses a generic \c AliasAnalysis
@@ -67,6 +67,23 @@ namespace llvm {
 
     /// \brief (re)compute li's spill weight and allocation hint.
     void calculateSpillWeightAndHint(LiveInterval &li);
+
+    /// \brief Compute li's allocation hint and sum up the use/def weight of
+    /// the instructions using it. This only reads shared analyses, so it may
+    /// run concurrently for different intervals with one VirtRegAuxInfo per
+    /// thread.
+    ///
+    /// Returns true if li is spillable and its weight must still be finished
+    /// by finishSpillWeight(), in which case \p TotalWeight and \p NumInstr
+    /// hold the partial results.
+    bool weightCalcHelper(LiveInterval &li, float &TotalWeight,
+                          unsigned &NumInstr);
+
+    /// \brief Complete li's spill weight from the partial results of
+    /// weightCalcHelper(). This may query alias analysis and must not run
+    /// concurrently with other weight computations.
+    void finishSpillWeight(LiveInterval &li, float TotalWeight,
+                           unsigned NumInstr);
   };
 
   /// \brief Compute spill weights and allocation hints for all virtual register
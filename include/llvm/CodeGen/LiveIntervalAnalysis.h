@@ -276,6 +276,11 @@ extern cl::opt<bool> UseSegmentSetForPhysRegs;
     /// print - Implement the dump method.
     void print(raw_ostream &O, const Module* = nullptr) const override;
 
+    /// verifyAnalysis - With -verify-live-intervals, check that the live
+    /// intervals of the virtual registers, as updated by the passes that
+    /// preserve this analysis, match a full recomputation.
+    void verifyAnalysis() const override;
+
     /// intervalIsInOneMBB - If LI is confined to a single basic block, return
     /// a pointer to that block.  If LI is live in to or out of any block,
     /// return NULL.
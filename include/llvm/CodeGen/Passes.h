@@ -151,6 +151,13 @@ namespace llvm {
   ///
   FunctionPass *createBasicRegisterAllocator();
 
+  /// LinearScanRegisterAllocation Pass - This pass allocates live intervals in
+  /// order of their start point, spilling instead of splitting. It is meant for
+  /// compile-time sensitive clients that want better code than the fast
+  /// allocator produces.
+  ///
+  FunctionPass *createLinearScanRegisterAllocator();
+
   /// Greedy register allocation pass - This pass implements a global register
   /// allocator for optimized builds.
   ///
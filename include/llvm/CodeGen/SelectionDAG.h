@@ -193,10 +193,16 @@ class SelectionDAG {
   /// CSE with existing nodes when a duplicate is requested.
   FoldingSet<SDNode> CSEMap;
 
-  /// Pool allocation for machine-opcode SDNode operands.
+  /// Pool allocation for machine-opcode SDNode operands. Every operand array
+  /// is handed back to OperandRecycler when its node is deallocated, so the
+  /// pool is kept across clear() and reused by later blocks and functions.
   BumpPtrAllocator OperandAllocator;
   ArrayRecycler<SDUse> OperandRecycler;
 
+  /// Pool allocation for shuffle masks, which are not recycled and are
+  /// released by clear().
+  BumpPtrAllocator ShuffleMaskAllocator;
+
   /// Pool allocation for misc. objects that are created once per SelectionDAG.
   BumpPtrAllocator Allocator;
 
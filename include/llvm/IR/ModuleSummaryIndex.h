@@ -133,9 +133,14 @@ public:
   };
 
 private:
+  // Fields are ordered to avoid padding; the combined index of a large
+  // ThinLTO link holds millions of these.
+
   /// Kind of summary for use in dyn_cast<> et al.
   SummaryKind Kind;
 
+  GVFlags Flags;
+
   /// This is the hash of the name of the symbol in the original file. It is
   /// identical to the GUID for global symbols, but differs for local since the
   /// GUID includes the module level id in the hash.
@@ -150,8 +155,6 @@ private:
   /// module path string table.
   StringRef ModulePath;
 
-  GVFlags Flags;
-
   /// List of values referenced by this global value's definition
   /// (either by the initializer of a global variable, or referenced
   /// from within a function). This does not include functions called, which
@@ -233,10 +236,15 @@ public:
   /// Record a reference from this global value to each global value identified
   /// in \p RefEdges.
   void addRefEdges(DenseSet<const Value *> &RefEdges) {
+    reserveRefEdges(RefEdgeList.size() + RefEdges.size());
     for (auto &RI : RefEdges)
       addRefEdge(RI);
   }
 
+  /// Reserve room for \p N references, so that a list whose final size is
+  /// known up front is allocated exactly once and without slack.
+  void reserveRefEdges(size_t N) { RefEdgeList.reserve(N); }
+
   /// Return the list of values referenced by this global value definition.
   std::vector<ValueInfo> &refs() { return RefEdgeList; }
   const std::vector<ValueInfo> &refs() const { return RefEdgeList; }
@@ -306,6 +314,7 @@ public:
   /// in \p CallGraphEdges.
   void
   addCallGraphEdges(DenseMap<GlobalValue::GUID, CalleeInfo> &CallGraphEdges) {
+    reserveCallGraphEdges(CallGraphEdgeList.size() + CallGraphEdges.size());
     for (auto &EI : CallGraphEdges)
       addCallGraphEdge(EI.first, EI.second);
   }
@@ -320,10 +329,15 @@ public:
   /// Record a call graph edge from this function to each function recorded
   /// in \p CallGraphEdges.
   void addCallGraphEdges(DenseMap<const Value *, CalleeInfo> &CallGraphEdges) {
+    reserveCallGraphEdges(CallGraphEdgeList.size() + CallGraphEdges.size());
     for (auto &EI : CallGraphEdges)
       addCallGraphEdge(EI.first, EI.second);
   }
 
+  /// Reserve room for \p N call graph edges, so that a list whose final size
+  /// is known up front is allocated exactly once and without slack.
+  void reserveCallGraphEdges(size_t N) { CallGraphEdgeList.reserve(N); }
+
   /// Return the list of <CalleeValueInfo, CalleeInfo> pairs.
   std::vector<EdgeTy> &calls() { return CallGraphEdgeList; }
   const std::vector<EdgeTy> &calls() const { return CallGraphEdgeList; }
@@ -534,6 +548,10 @@ public:
   /// Summary).
   void collectDefinedGVSummariesPerModule(
       StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries) const;
+
+  /// Print an estimate of the memory held by this index, broken down by the
+  /// data structures that hold it. Allocated sizes include unused capacity.
+  void printMemoryUsage(raw_ostream &OS) const;
 };
 
 } // End llvm namespace
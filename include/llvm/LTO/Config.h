@@ -68,6 +68,10 @@ struct Config {
   bool ShouldDiscardValueNames = true;
   DiagnosticHandlerFunction DiagHandler;
 
+  /// The number of threads used to compute the ThinLTO import and export lists
+  /// during the thin link. Zero means one thread per physical core.
+  unsigned ThinLinkThreads = 0;
+
   /// If this field is set, LTO will write input file paths and symbol
   /// resolutions here in llvm-lto2 command line flag format. This can be
   /// used for testing and for running the LTO pipeline outside of the linker
@@ -282,6 +282,22 @@ ThinBackend createWriteIndexesThinBackend(std::string OldPrefix,
                                           bool ShouldEmitImportsFiles,
                                           std::string LinkedObjectsFile);
 
+/// This ThinBackend runs each individual backend job in a separate process,
+/// at most \p ParallelismLevel at a time. Every job writes the module's
+/// individual index to a temporary file and invokes
+///
+///   WorkerPath WorkerArgs... -thinlto-index=<index> -o <object> <module>
+///
+/// which is the interface of llvm-lto2's backend mode. The resulting object
+/// file is then passed to the AddStream or cache stream as usual. The input
+/// modules, and the modules they import from, must be available on disk at
+/// their module paths. If \p MemoryLimitMB is non-zero, each worker is
+/// killed once it allocates more than that many megabytes.
+ThinBackend createOutOfProcessThinBackend(unsigned ParallelismLevel,
+                                          std::string WorkerPath,
+                                          std::vector<std::string> WorkerArgs,
+                                          unsigned MemoryLimitMB = 0);
+
 /// This class implements a resolution-based interface to LLVM's LTO
 /// functionality. It supports regular LTO, parallel LTO code generation and
 /// ThinLTO. You can use it from a linker in the following way:
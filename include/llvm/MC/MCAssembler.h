@@ -131,6 +131,10 @@ private:
   /// By default it's 0, which means bundling is disabled.
   unsigned BundleAlignSize;
 
+  /// The fragments of each section, indexed by section layout order, whose
+  /// size may still change during relaxation. Only valid during layout().
+  std::vector<std::vector<MCFragment *>> RelaxationWorklist;
+
   unsigned RelaxAll : 1;
   unsigned SubsectionsViaSymbols : 1;
   unsigned IncrementalLinkerCompatible : 1;
@@ -171,7 +175,8 @@ private:
   bool fixupNeedsRelaxation(const MCFixup &Fixup, const MCRelaxableFragment *DF,
                             const MCAsmLayout &Layout) const;
 
-  /// Check whether the given fragment needs relaxation.
+  /// Check whether the given fragment needs relaxation. The fragment's
+  /// instruction must be one that may need relaxation.
   bool fragmentNeedsRelaxation(const MCRelaxableFragment *IF,
                                const MCAsmLayout &Layout) const;
 
@@ -180,9 +185,13 @@ private:
   bool layoutOnce(MCAsmLayout &Layout);
 
   /// \brief Perform one layout iteration of the given section and return true
-  /// if any offsets were adjusted.
+  /// if any offsets were adjusted. Only the fragments on the section's
+  /// relaxation worklist are visited.
   bool layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec);
 
+  /// Return true if relaxation may still change the size of \p F.
+  bool mayChangeSize(const MCFragment &F) const;
+
   bool relaxInstruction(MCAsmLayout &Layout, MCRelaxableFragment &IF);
 
   bool relaxLEB(MCAsmLayout &Layout, MCLEBFragment &IF);
@@ -16,6 +16,7 @@
 #include "llvm/ADT/iterator.h"
 #include "llvm/MC/MCFixup.h"
 #include "llvm/MC/MCInst.h"
+#include <memory>
 
 namespace llvm {
 class MCSection;
@@ -243,13 +244,19 @@ public:
   }
 };
 
-/// A relaxable fragment holds on to its MCInst, since it may need to be
+/// A relaxable fragment holds on to its instruction, since it may need to be
 /// relaxed during the assembler layout and relaxation stage.
 ///
+/// The instruction is stored without the inline operand storage of MCInst,
+/// since a large assembly file can have a relaxable fragment for every branch.
+///
 class MCRelaxableFragment : public MCEncodedFragmentWithFixups<8, 1> {
 
-  /// Inst - The instruction this is a fragment for.
-  MCInst Inst;
+  /// The instruction this is a fragment for.
+  unsigned Opcode = 0;
+  unsigned NumOperands = 0;
+  SMLoc Loc;
+  std::unique_ptr<MCOperand[]> Operands;
 
   /// STI - The MCSubtargetInfo in effect when the instruction was encoded.
   const MCSubtargetInfo &STI;
@@ -257,11 +264,30 @@ class MCRelaxableFragment : public MCEncodedFragmentWithFixups<8, 1> {
 public:
   MCRelaxableFragment(const MCInst &Inst, const MCSubtargetInfo &STI,
                       MCSection *Sec = nullptr)
-      : MCEncodedFragmentWithFixups(FT_Relaxable, true, Sec),
-        Inst(Inst), STI(STI) {}
+      : MCEncodedFragmentWithFixups(FT_Relaxable, true, Sec), STI(STI) {
+    setInst(Inst);
+  }
+
+  /// Return a copy of the instruction this is a fragment for.
+  MCInst getInst() const {
+    MCInst Inst;
+    Inst.setOpcode(Opcode);
+    Inst.setLoc(Loc);
+    for (unsigned I = 0; I != NumOperands; ++I)
+      Inst.addOperand(Operands[I]);
+    return Inst;
+  }
+  void setInst(const MCInst &Value) {
+    Opcode = Value.getOpcode();
+    Loc = Value.getLoc();
+    if (Value.getNumOperands() != NumOperands) {
+      NumOperands = Value.getNumOperands();
+      Operands.reset(NumOperands ? new MCOperand[NumOperands] : nullptr);
+    }
+    std::copy(Value.begin(), Value.end(), Operands.get());
+  }
 
-  const MCInst &getInst() const { return Inst; }
-  void setInst(const MCInst &Value) { Inst = Value; }
+  unsigned getOpcode() const { return Opcode; }
 
   const MCSubtargetInfo &getSubtargetInfo() { return STI; }
 
@@ -14,6 +14,7 @@
 #ifndef LLVM_OBJECT_ARCHIVE_H
 #define LLVM_OBJECT_ARCHIVE_H
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/iterator_range.h"
@@ -23,6 +24,8 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
+#include <atomic>
+#include <mutex>
 
 namespace llvm {
 namespace object {
@@ -166,6 +169,7 @@ public:
   };
 
   class Symbol {
+    friend Archive;
     const Archive *Parent;
     uint32_t SymbolIndex;
     uint32_t StringIndex; // Extra index to the string.
@@ -237,9 +241,14 @@ public:
     return v->isArchive();
   }
 
-  // check if a symbol is in the archive
+  // check if a symbol is in the archive. Safe to call from several threads.
   Expected<Optional<Child>> findSym(StringRef name) const;
 
+  /// Look up several symbols at once. Element I of the result is the member
+  /// defining Names[I], or None if no member does.
+  Expected<std::vector<Optional<Child>>>
+  findSyms(ArrayRef<StringRef> Names) const;
+
   bool isEmpty() const;
   bool hasSymbolTable() const;
   StringRef getSymbolTable() const { return SymbolTable; }
@@ -261,6 +270,16 @@ private:
   unsigned Format : 3;
   unsigned IsThin : 1;
   mutable std::vector<std::unique_ptr<MemoryBuffer>> ThinBuffers;
+
+  /// Maps a symbol name to the symbol and string table indices of its first
+  /// entry in the symbol table. Built on the first call to findSym, so that
+  /// resolving many symbols doesn't scan the symbol table each time.
+  /// SymbolMapLock guards building it; it is read-only once SymbolMapBuilt
+  /// is set.
+  mutable DenseMap<StringRef, std::pair<uint32_t, uint32_t>> SymbolMap;
+  mutable std::atomic<bool> SymbolMapBuilt{false};
+  mutable std::mutex SymbolMapLock;
+  void buildSymbolMap() const;
 };
 
 }
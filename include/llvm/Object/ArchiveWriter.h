@@ -36,10 +36,15 @@ struct NewArchiveMember {
                                             bool Deterministic);
 };
 
+/// Write an archive named \p ArcName. If \p OldArchiveBuf is the archive
+/// being replaced, the symbol table entries of the members copied unchanged
+/// from it may be reused. The symbols of the other members are read on up to
+/// \p Threads threads.
 std::pair<StringRef, std::error_code>
 writeArchive(StringRef ArcName, std::vector<NewArchiveMember> &NewMembers,
              bool WriteSymtab, object::Archive::Kind Kind, bool Deterministic,
-             bool Thin, std::unique_ptr<MemoryBuffer> OldArchiveBuf = nullptr);
+             bool Thin, std::unique_ptr<MemoryBuffer> OldArchiveBuf = nullptr,
+             unsigned Threads = 1);
 }
 
 #endif
@@ -16,6 +16,7 @@
 
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator_range.h"
@@ -35,7 +36,9 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include <cassert>
 #include <cstdint>
+#include <memory>
 #include <system_error>
+#include <vector>
 
 namespace llvm {
 namespace object {
@@ -69,6 +72,24 @@ public:
 
   elf_symbol_iterator_range symbols() const;
 
+  /// Returns the first section named \p Name, or section_end() if there is
+  /// none. The lookup table is built on the first call, so concurrent first
+  /// calls on one object are not thread-safe.
+  virtual section_iterator findSectionByName(StringRef Name) const = 0;
+
+  /// Returns all the sections named \p Name, in section table order.
+  virtual ArrayRef<SectionRef> findSectionsByName(StringRef Name) const = 0;
+
+  /// Returns the relocation sections that apply to \p Sec, in section table
+  /// order. This is the inverse of SectionRef::getRelocatedSection(). Like
+  /// findSectionByName(), it shares a table built on the first call.
+  virtual ArrayRef<SectionRef> getRelocationSections(SectionRef Sec) const = 0;
+
+  /// Returns the relocation sections that apply to any of \p Secs, in section
+  /// table order.
+  SmallVector<SectionRef, 2>
+  getRelocationSectionsFor(ArrayRef<SectionRef> Secs) const;
+
   static inline bool classof(const Binary *v) { return v->isELF(); }
 
   SubtargetFeatures getFeatures() const override;
@@ -210,6 +231,20 @@ protected:
   const Elf_Shdr *DotSymtabSec = nullptr; // Symbol table section.
   ArrayRef<Elf_Word> ShndxTable;
 
+  /// Lookup tables over the section header table, built on first use so that
+  /// clients that only iterate don't pay for them. Building them is not
+  /// synchronized: clients sharing an object between threads must make the
+  /// first lookup before doing so.
+  struct SectionIndex {
+    StringMap<SmallVector<SectionRef, 1>> ByName;
+    /// The relocation sections that apply to the section with index I are
+    /// RelocSections[RelocBegin[I]] up to RelocSections[RelocBegin[I + 1]].
+    std::vector<uint32_t> RelocBegin;
+    std::vector<SectionRef> RelocSections;
+  };
+  mutable std::unique_ptr<SectionIndex> SecIndex;
+  const SectionIndex &getSectionIndex() const;
+
   void moveSymbolNext(DataRefImpl &Symb) const override;
   Expected<StringRef> getSymbolName(DataRefImpl Symb) const override;
   Expected<uint64_t> getSymbolAddress(DataRefImpl Symb) const override;
@@ -366,6 +401,10 @@ public:
 
   elf_symbol_iterator_range getDynamicSymbolIterators() const override;
 
+  section_iterator findSectionByName(StringRef Name) const override;
+  ArrayRef<SectionRef> findSectionsByName(StringRef Name) const override;
+  ArrayRef<SectionRef> getRelocationSections(SectionRef Sec) const override;
+
   bool isRelocatableObject() const override;
 };
 
@@ -713,6 +752,85 @@ ELFObjectFile<ELFT>::getRelocatedSection(DataRefImpl Sec) const {
   return section_iterator(SectionRef(toDRI(*R), this));
 }
 
+template <class ELFT>
+const typename ELFObjectFile<ELFT>::SectionIndex &
+ELFObjectFile<ELFT>::getSectionIndex() const {
+  if (SecIndex)
+    return *SecIndex;
+  SecIndex.reset(new SectionIndex());
+  auto SectionsOrErr = EF.sections();
+  if (!SectionsOrErr) {
+    consumeError(SectionsOrErr.takeError());
+    return *SecIndex;
+  }
+  auto Sections = *SectionsOrErr;
+  bool IsRel = EF.getHeader()->e_type == ELF::ET_REL;
+
+  // Count the relocation sections of each target section, then place them in
+  // section table order. Relocation sections with an out of range sh_info are
+  // left out.
+  std::vector<uint32_t> &Begin = SecIndex->RelocBegin;
+  Begin.assign(Sections.size() + 1, 0);
+  for (const Elf_Shdr &Sec : Sections) {
+    if (Expected<StringRef> NameOrErr = EF.getSectionName(&Sec))
+      SecIndex->ByName[*NameOrErr].push_back(SectionRef(toDRI(&Sec), this));
+    else
+      consumeError(NameOrErr.takeError());
+    if (IsRel &&
+        (Sec.sh_type == ELF::SHT_REL || Sec.sh_type == ELF::SHT_RELA) &&
+        Sec.sh_info < Sections.size())
+      ++Begin[Sec.sh_info + 1];
+  }
+  for (size_t I = 1, E = Begin.size(); I != E; ++I)
+    Begin[I] += Begin[I - 1];
+
+  SecIndex->RelocSections.resize(Begin.back());
+  std::vector<uint32_t> Next(Begin.begin(), Begin.end() - 1);
+  for (const Elf_Shdr &Sec : Sections)
+    if (IsRel &&
+        (Sec.sh_type == ELF::SHT_REL || Sec.sh_type == ELF::SHT_RELA) &&
+        Sec.sh_info < Sections.size())
+      SecIndex->RelocSections[Next[Sec.sh_info]++] =
+          SectionRef(toDRI(&Sec), this);
+  return *SecIndex;
+}
+
+template <class ELFT>
+section_iterator
+ELFObjectFile<ELFT>::findSectionByName(StringRef Name) const {
+  ArrayRef<SectionRef> Sections = findSectionsByName(Name);
+  if (Sections.empty())
+    return section_end();
+  return section_iterator(Sections.front());
+}
+
+template <class ELFT>
+ArrayRef<SectionRef>
+ELFObjectFile<ELFT>::findSectionsByName(StringRef Name) const {
+  const SectionIndex &Index = getSectionIndex();
+  auto I = Index.ByName.find(Name);
+  if (I == Index.ByName.end())
+    return None;
+  return I->second;
+}
+
+template <class ELFT>
+ArrayRef<SectionRef>
+ELFObjectFile<ELFT>::getRelocationSections(SectionRef Sec) const {
+  const SectionIndex &Index = getSectionIndex();
+  auto SectionsOrErr = EF.sections();
+  if (!SectionsOrErr) {
+    consumeError(SectionsOrErr.takeError());
+    return None;
+  }
+  size_t SecNum = getSection(Sec.getRawDataRefImpl()) - SectionsOrErr->begin();
+  if (SecNum + 1 >= Index.RelocBegin.size())
+    return None;
+  return makeArrayRef(Index.RelocSections)
+      .slice(Index.RelocBegin[SecNum],
+             Index.RelocBegin[SecNum + 1] - Index.RelocBegin[SecNum]);
+}
+
 // Relocations
 template <class ELFT>
 void ELFObjectFile<ELFT>::moveRelocationNext(DataRefImpl &Rel) const {
@@ -18,6 +18,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/ADT/iterator.h"
@@ -308,6 +309,14 @@ class FunctionRecordIterator
   ArrayRef<FunctionRecord> Records;
   ArrayRef<FunctionRecord>::iterator Current;
   StringRef Filename;
+  /// \brief If UseIndices is set, only the records at these indices are
+  /// visited.
+  const unsigned *NextIndex = nullptr;
+  const unsigned *EndIndex = nullptr;
+  bool UseIndices = false;
+
+  /// \brief Move to the next candidate record.
+  void advance();
 
   /// \brief Skip records whose primary file is not \c Filename.
   void skipOtherFiles();
@@ -319,6 +328,17 @@ public:
     skipOtherFiles();
   }
 
+  /// \brief Visit only the records in \p Records_ at \p RecordIndices, which
+  /// must be in increasing order.
+  FunctionRecordIterator(ArrayRef<FunctionRecord> Records_,
+                         ArrayRef<unsigned> RecordIndices, StringRef Filename)
+      : Records(Records_), Current(Records.end()), Filename(Filename),
+        NextIndex(RecordIndices.begin()), EndIndex(RecordIndices.end()),
+        UseIndices(true) {
+    advance();
+    skipOtherFiles();
+  }
+
   FunctionRecordIterator() : Current(Records.begin()) {}
 
   bool operator==(const FunctionRecordIterator &RHS) const {
@@ -329,7 +349,7 @@ public:
 
   FunctionRecordIterator &operator++() {
     assert(Current != Records.end() && "incremented past end");
-    ++Current;
+    advance();
     skipOtherFiles();
     return *this;
   }
@@ -424,6 +444,14 @@ class CoverageMapping {
   std::vector<FunctionRecord> Functions;
   unsigned MismatchedFunctionCount;
 
+  /// \brief The indices of the functions that have regions in each file, in
+  /// increasing order. Per-file queries use this instead of scanning every
+  /// function, which matters for reports over many files.
+  StringMap<std::vector<unsigned>> FileFunctions;
+
+  /// \brief Get the indices of the functions that have regions in \p Filename.
+  ArrayRef<unsigned> getFunctionIndices(StringRef Filename) const;
+
   CoverageMapping() : MismatchedFunctionCount(0) {}
 
   CoverageMapping(const CoverageMapping &) = delete;
@@ -480,7 +508,10 @@ public:
   /// \brief Gets all of the functions in a particular file.
   iterator_range<FunctionRecordIterator>
   getCoveredFunctions(StringRef Filename) const {
-    return make_range(FunctionRecordIterator(Functions, Filename),
+    if (Filename.empty())
+      return getCoveredFunctions();
+    return make_range(FunctionRecordIterator(
+                          Functions, getFunctionIndices(Filename), Filename),
                       FunctionRecordIterator());
   }
 
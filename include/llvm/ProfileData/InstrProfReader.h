@@ -252,6 +252,23 @@ namespace IndexedInstrProf {
 enum class HashT : uint32_t;
 }
 
+/// A profile record of an indexed profile that refers directly into the
+/// profile data instead of copying it out. The counters are stored unaligned
+/// and in little-endian order, so they are read through support::ulittle64_t.
+/// The value profile data is only decoded by materialize().
+struct InstrProfRecordView {
+  StringRef Name;
+  uint64_t Hash = 0;
+  ArrayRef<support::ulittle64_t> Counts;
+  /// The serialized value profile data, empty for format versions that have
+  /// none.
+  ArrayRef<unsigned char> ValueData;
+  support::endianness ValueDataEndianness = support::little;
+
+  /// Copy the counters and decode the value profile data into \p Record.
+  Error materialize(InstrProfRecord &Record) const;
+};
+
 /// Trait for lookups into the on-disk hash table for the binary instrprof
 /// format.
 class InstrProfLookupTrait {
@@ -297,6 +314,12 @@ public:
                               const unsigned char *const End);
   data_type ReadData(StringRef K, const unsigned char *D, offset_type N);
 
+  /// Find the record with hash \p Hash in the data \p D of length \p N that
+  /// belongs to key \p K, without copying the counters or decoding any value
+  /// profile data.
+  Error findRecordView(StringRef K, const unsigned char *D, offset_type N,
+                       uint64_t Hash, InstrProfRecordView &View) const;
+
   // Used for testing purpose only.
   void setValueProfDataEndianness(support::endianness Endianness) {
     ValueProfDataEndianness = Endianness;
@@ -310,6 +333,10 @@ struct InstrProfReaderIndexBase {
   // Read all the profile records with the key equal to FuncName
   virtual Error getRecords(StringRef FuncName,
                                      ArrayRef<InstrProfRecord> &Data) = 0;
+  // Find the profile record with the key equal to FuncName and the given
+  // hash, referring to the profile data in place.
+  virtual Error getRecordView(StringRef FuncName, uint64_t FuncHash,
+                              InstrProfRecordView &View) = 0;
   virtual void advanceToNextKey() = 0;
   virtual bool atEnd() const = 0;
   virtual void setValueProfDataEndianness(support::endianness Endianness) = 0;
@@ -339,6 +366,8 @@ public:
   Error getRecords(ArrayRef<InstrProfRecord> &Data) override;
   Error getRecords(StringRef FuncName,
                    ArrayRef<InstrProfRecord> &Data) override;
+  Error getRecordView(StringRef FuncName, uint64_t FuncHash,
+                      InstrProfRecordView &View) override;
   void advanceToNextKey() override { RecordIterator++; }
   bool atEnd() const override {
     return RecordIterator == HashTable->data_end();
@@ -394,6 +423,11 @@ public:
   Expected<InstrProfRecord> getInstrProfRecord(StringRef FuncName,
                                                uint64_t FuncHash);
 
+  /// Find the record associated with FuncName and FuncHash without copying
+  /// it out of the profile. The view is valid as long as the reader is.
+  Error getInstrProfRecordView(StringRef FuncName, uint64_t FuncHash,
+                               InstrProfRecordView &View);
+
   /// Fill Counts with the profile data for the given function name.
   Error getFunctionCounts(StringRef FuncName, uint64_t FuncHash,
                           std::vector<uint64_t> &Counts);
@@ -67,11 +67,22 @@ namespace llvm {
 
 namespace sampleprof {
 
-static inline uint64_t SPMagic() {
+enum SampleProfileFormat {
+  SPF_None = 0,
+  SPF_Text,
+  SPF_Binary,
+  SPF_GCC,
+  SPF_Compact_Binary
+};
+
+/// The binary formats share the first seven bytes of their magic number and
+/// differ in the last one.
+static inline uint64_t SPMagic(SampleProfileFormat Format = SPF_Binary) {
   return uint64_t('S') << (64 - 8) | uint64_t('P') << (64 - 16) |
          uint64_t('R') << (64 - 24) | uint64_t('O') << (64 - 32) |
          uint64_t('F') << (64 - 40) | uint64_t('4') << (64 - 48) |
-         uint64_t('2') << (64 - 56) | uint64_t(0xff);
+         uint64_t('2') << (64 - 56) |
+         (Format == SPF_Binary ? uint64_t(0xff) : uint64_t(Format));
 }
 
 static inline uint64_t SPVersion() { return 103; }
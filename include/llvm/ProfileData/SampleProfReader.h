@@ -204,6 +204,31 @@
 //          in the text format documentation above).
 //        FUNCTION BODY
 //          A FUNCTION BODY entry describing the inlined function.
+//
+// COMPACT BINARY FORMAT
+// ---------------------
+//
+// This is the binary format with two changes that let the compiler load only
+// the functions of the module it compiles:
+//
+// MAGIC (uint64_t)
+//    Computed by SPMagic(SPF_Compact_Binary).
+//
+// NAME TABLE
+//    SIZE (uint32_t)
+//        Number of entries in the name table.
+//    NAMES
+//        SIZE MD5 hashes (uint64_t) of the function names. Functions are
+//        looked up by the decimal string of the hash.
+//
+// FUNCTION OFFSET TABLE (after the last FUNCTION BODY)
+//    SIZE (uint64_t)
+//        Number of top-level functions.
+//    ENTRIES
+//        NAME_IDX (uint32_t) and OFFSET (uint64_t) of each function's
+//        FUNCTION BODY, from the start of the file.
+//    TABLE_OFFSET (fixed 8 bytes, little-endian)
+//        Offset of the function offset table from the start of the file.
 //===----------------------------------------------------------------------===//
 #ifndef LLVM_PROFILEDATA_SAMPLEPROFREADER_H
 #define LLVM_PROFILEDATA_SAMPLEPROFREADER_H
@@ -273,14 +298,23 @@ public:
   /// \brief Print all the profiles on stream \p OS.
   void dump(raw_ostream &OS = dbgs());
 
+  /// \brief Restrict the profiles that read() loads to the functions
+  /// defined in \p M. Formats that can't load functions selectively read
+  /// everything anyway.
+  virtual void collectFuncsToUse(const Module &M) {}
+
   /// \brief Return the samples collected for function \p F.
-  FunctionSamples *getSamplesFor(const Function &F) {
+  virtual FunctionSamples *getSamplesFor(const Function &F) {
     return &Profiles[F.getName()];
   }
 
   /// \brief Return all the profiles.
   StringMap<FunctionSamples> &getProfiles() { return Profiles; }
 
+  /// \brief Return true if the profiles are keyed by the decimal MD5 hash of
+  /// each function name rather than by the name itself.
+  virtual bool useMD5() const { return false; }
+
   /// \brief Report a parse error message.
   void reportError(int64_t LineNumber, Twine Msg) const {
     Ctx.diagnose(DiagnosticInfoSampleProfile(Buffer->getBufferIdentifier(),
@@ -368,6 +402,15 @@ protected:
   /// Read a string indirectly via the name table.
   ErrorOr<StringRef> readStringFromTable();
 
+  /// Check the magic number of the file.
+  virtual std::error_code verifySPMagic(uint64_t Magic);
+
+  /// Read the name table into NameTable.
+  virtual std::error_code readNameTable();
+
+  /// Read the profile of one top-level function at the current position.
+  std::error_code readFuncProfile();
+
   /// \brief Return true if we've reached the end of file.
   bool at_eof() const { return Data >= End; }
 
@@ -390,6 +433,55 @@ private:
   std::error_code readSummary();
 };
 
+/// \brief Reader for the compact binary format written by
+/// SampleProfileWriterCompactBinary.
+///
+/// Profiles are keyed by the decimal MD5 hash of the function name. After
+/// collectFuncsToUse(), read() only decodes the functions of that module,
+/// using the function offset table at the end of the file.
+class SampleProfileReaderCompactBinary : public SampleProfileReaderBinary {
+public:
+  SampleProfileReaderCompactBinary(std::unique_ptr<MemoryBuffer> B,
+                                   LLVMContext &C)
+      : SampleProfileReaderBinary(std::move(B), C) {}
+
+  /// \brief Read and validate the file header and the function offset table.
+  std::error_code readHeader() override;
+
+  /// \brief Read the profiles of the collected functions, or of all functions
+  /// if none were collected.
+  std::error_code read() override;
+
+  void collectFuncsToUse(const Module &M) override;
+
+  FunctionSamples *getSamplesFor(const Function &F) override {
+    return &Profiles[getMD5Name(F.getName())];
+  }
+
+  bool useMD5() const override { return true; }
+
+  /// \brief Return true if \p Buffer is in the format supported by this class.
+  static bool hasFormat(const MemoryBuffer &Buffer);
+
+  /// \brief Return the name under which the profile of \p Name is stored.
+  static std::string getMD5Name(StringRef Name);
+
+private:
+  std::error_code verifySPMagic(uint64_t Magic) override;
+  std::error_code readNameTable() override;
+  std::error_code readFuncOffsetTable();
+
+  /// Storage for the decimal MD5 names that NameTable refers to.
+  std::vector<std::string> MD5Names;
+
+  /// Offset of each function's profile from the start of the buffer.
+  StringMap<uint64_t> FuncOffsetTable;
+
+  /// The functions to load, unless UseAllFuncs is set.
+  std::vector<std::string> FuncsToUse;
+  bool UseAllFuncs = true;
+};
+
 typedef SmallVector<FunctionSamples *, 10> InlineCallStack;
 
 // Supported histogram types in GCC.  Currently, we only need support for
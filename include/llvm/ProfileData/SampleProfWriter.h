@@ -25,8 +25,6 @@ namespace llvm {
 
 namespace sampleprof {
 
-enum SampleProfileFormat { SPF_None = 0, SPF_Text, SPF_Binary, SPF_GCC };
-
 /// \brief Sample-based profile writer. Base class.
 class SampleProfileWriter {
 public:
@@ -40,7 +38,7 @@ public:
   /// Write all the sample profiles in the given map of samples.
   ///
   /// \returns status code of the file update operation.
-  std::error_code write(const StringMap<FunctionSamples> &ProfileMap) {
+  virtual std::error_code write(const StringMap<FunctionSamples> &ProfileMap) {
     if (std::error_code EC = writeHeader(ProfileMap))
       return EC;
     for (const auto &I : ProfileMap) {
@@ -53,6 +51,10 @@ public:
 
   raw_ostream &getOutputStream() { return *OutputStream; }
 
+  /// Tell the writer that the profiles it is given are keyed by MD5 hashes,
+  /// as read from a compact binary profile, rather than by function names.
+  virtual void setUseMD5() {}
+
   /// Profile writer factory.
   ///
   /// Create a new file writer based on the value of \p Format.
@@ -118,15 +120,46 @@ protected:
 
   std::error_code
   writeHeader(const StringMap<FunctionSamples> &ProfileMap) override;
+  virtual void writeMagicIdent();
+  virtual void writeNameTable();
   std::error_code writeSummary();
   std::error_code writeNameIdx(StringRef FName);
   std::error_code writeBody(const FunctionSamples &S);
 
+  MapVector<StringRef, uint32_t> NameTable;
+
 private:
   void addName(StringRef FName);
   void addNames(const FunctionSamples &S);
 
-  MapVector<StringRef, uint32_t> NameTable;
+  friend ErrorOr<std::unique_ptr<SampleProfileWriter>>
+  SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
+                              SampleProfileFormat Format);
+};
+
+/// \brief Sample-based profile writer (compact binary format).
+///
+/// Function names are replaced by their MD5 hashes, and the function bodies
+/// are followed by a table of their offsets so that a reader can load only
+/// the functions it needs.
+class SampleProfileWriterCompactBinary : public SampleProfileWriterBinary {
+public:
+  std::error_code
+  write(const StringMap<FunctionSamples> &ProfileMap) override;
+  using SampleProfileWriterBinary::write;
+
+  void setUseMD5() override { UseMD5 = true; }
+
+protected:
+  SampleProfileWriterCompactBinary(std::unique_ptr<raw_ostream> &OS)
+      : SampleProfileWriterBinary(OS) {}
+
+  void writeMagicIdent() override;
+  void writeNameTable() override;
+
+private:
+  /// True if the names are already the decimal MD5 hashes to be written.
+  bool UseMD5 = false;
 
   friend ErrorOr<std::unique_ptr<SampleProfileWriter>>
   SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
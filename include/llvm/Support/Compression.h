@@ -43,6 +43,18 @@ bool isAvailable();
 Status compress(StringRef InputBuffer, SmallVectorImpl<char> &CompressedBuffer,
                 CompressionLevel Level = DefaultCompression);
 
+/// Compresses \p InputBuffer into a single zlib stream like compress(), but
+/// deflates it in chunks of \p ChunkSize bytes on up to \p Threads threads
+/// (0 means one per hardware thread). Each chunk is primed with the 32KB of
+/// input that precedes it, so the ratio stays close to that of compress().
+/// The output only depends on the input, \p Level and \p ChunkSize, not on
+/// the number of threads. Inputs of at most one chunk are compressed with
+/// compress().
+Status compressParallel(StringRef InputBuffer,
+                        SmallVectorImpl<char> &CompressedBuffer,
+                        CompressionLevel Level = DefaultCompression,
+                        unsigned Threads = 0, size_t ChunkSize = 1 << 20);
+
 Status uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                   size_t &UncompressedSize);
 
@@ -24,6 +24,7 @@
 #ifndef LLVM_SUPPORT_GENERICDOMTREE_H
 #define LLVM_SUPPORT_GENERICDOMTREE_H
 
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/GraphTraits.h"
@@ -33,6 +34,7 @@
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <queue>
 
 namespace llvm {
 
@@ -92,6 +94,7 @@ template <class NodeT> class DomTreeNodeBase {
   NodeT *TheBB;
   DomTreeNodeBase<NodeT> *IDom;
   std::vector<DomTreeNodeBase<NodeT> *> Children;
+  unsigned Level;
   mutable int DFSNumIn, DFSNumOut;
 
   template <class N> friend class DominatorTreeBase;
@@ -113,8 +116,13 @@ public:
     return Children;
   }
 
+  /// getLevel - Return the depth of this node in the tree. The root is at
+  /// level 0.
+  unsigned getLevel() const { return Level; }
+
   DomTreeNodeBase(NodeT *BB, DomTreeNodeBase<NodeT> *iDom)
-      : TheBB(BB), IDom(iDom), DFSNumIn(-1), DFSNumOut(-1) {}
+      : TheBB(BB), IDom(iDom), Level(IDom ? IDom->Level + 1 : 0),
+        DFSNumIn(-1), DFSNumOut(-1) {}
 
   std::unique_ptr<DomTreeNodeBase<NodeT>>
   addChild(std::unique_ptr<DomTreeNodeBase<NodeT>> C) {
@@ -157,6 +165,8 @@ public:
       // Switch to new dominator
       IDom = NewIDom;
       IDom->Children.push_back(this);
+
+      UpdateLevel();
     }
   }
 
@@ -173,6 +183,24 @@ private:
     return this->DFSNumIn >= other->DFSNumIn &&
            this->DFSNumOut <= other->DFSNumOut;
   }
+
+  // Recompute the levels of this node and of its descendants after its
+  // immediate dominator changed.
+  void UpdateLevel() {
+    assert(IDom);
+    if (Level == IDom->Level + 1)
+      return;
+
+    SmallVector<DomTreeNodeBase<NodeT> *, 64> WorkStack(1, this);
+    while (!WorkStack.empty()) {
+      DomTreeNodeBase<NodeT> *Current = WorkStack.pop_back_val();
+      Current->Level = Current->IDom->Level + 1;
+
+      for (DomTreeNodeBase<NodeT> *C : *Current)
+        if (C->Level != Current->Level + 1)
+          WorkStack.push_back(C);
+    }
+  }
 };
 
 template <class NodeT>
@@ -206,6 +234,19 @@ void Calculate(DominatorTreeBaseByGraphTraits<GraphTraits<N>> &DT, FuncT &F);
 /// This class is a generic template over graph nodes. It is instantiated for
 /// various graphs in the LLVM IR or in the code generator.
 template <class NodeT> class DominatorTreeBase : public DominatorBase<NodeT> {
+public:
+  /// \brief The kind of a CFG edge update passed to applyUpdates().
+  enum class UpdateKind : unsigned char { Insert, Delete };
+
+  /// \brief A CFG edge From -> To that was inserted into or deleted from the
+  /// underlying graph.
+  struct UpdateType {
+    UpdateKind Kind;
+    NodeT *From;
+    NodeT *To;
+  };
+
+private:
   DominatorTreeBase(const DominatorTreeBase &) = delete;
   DominatorTreeBase &operator=(const DominatorTreeBase &) = delete;
 
@@ -230,9 +271,630 @@ template <class NodeT> class DominatorTreeBase : public DominatorBase<NodeT> {
     IDoms.clear();
     Vertex.clear();
     Info.clear();
+    PendingUpdates.clear();
     RootNode = nullptr;
   }
 
+  /// \brief Fold the recorded CFG edge updates into the tree.
+  ///
+  /// The net updates are applied one at a time with the incremental
+  /// algorithms below. A post-dominator update that changes the set of exits
+  /// is not handled by them, and recomputes the tree once from the current
+  /// graph instead, which already reflects every update in the batch.
+  ///
+  /// \post PendingUpdates.empty().
+  void applyPendingUpdates() const {
+    // Bail out early if there is nothing to do.
+    if (LLVM_LIKELY(PendingUpdates.empty()))
+      return;
+
+    // Take the updates out first: the queries made while applying them must
+    // see a tree with nothing pending.
+    SmallVector<UpdateType, 4> Updates;
+    std::swap(Updates, PendingUpdates);
+    legalizeUpdates(Updates);
+    if (Updates.empty())
+      return;
+
+    auto *DT = const_cast<DominatorTreeBase *>(this);
+    DT->applyUpdatesIncrementally(*Updates.front().From->getParent(), Updates);
+  }
+
+  /// \brief Replace \p Updates by the net update of each edge, in the order
+  /// the edges were first seen. An insertion and a deletion of the same edge
+  /// cancel out.
+  static void legalizeUpdates(SmallVectorImpl<UpdateType> &Updates) {
+    SmallDenseMap<std::pair<NodeT *, NodeT *>, int, 4> NetCount;
+    for (const UpdateType &U : Updates)
+      NetCount[std::make_pair(U.From, U.To)] +=
+          U.Kind == UpdateKind::Insert ? 1 : -1;
+
+    SmallVector<UpdateType, 4> Result;
+    for (const UpdateType &U : Updates) {
+      int &Count = NetCount[std::make_pair(U.From, U.To)];
+      if (Count == 0)
+        continue;
+      Result.push_back(
+          {Count > 0 ? UpdateKind::Insert : UpdateKind::Delete, U.From, U.To});
+      Count = 0;
+    }
+    Updates.swap(Result);
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Incremental updates.
+  //
+  // Insertions use the depth-based search of Georgiadis et al., "An
+  // Experimental Study of Dynamic Dominators": only nodes reachable from the
+  // new edge's target through nodes at least as deep get a new immediate
+  // dominator. Deletions check whether the target is still reachable. If it
+  // is, the subtree below the nearest common dominator of the edge is
+  // recomputed with SemiNCA. If not, the target's subtree is erased, and the
+  // nodes it had edges to are fixed up the same way.
+  //
+  // All of this runs on the graph the tree is built on: the CFG for
+  // dominators, and the reverse CFG for post-dominators, whose virtual exit
+  // (the node for the null block) has an edge to every root.
+
+  typedef SmallDenseMap<NodeT *, SmallVector<std::pair<NodeT *, UpdateKind>, 2>,
+                        4>
+      FutureUpdateMapType;
+
+  /// \brief The part of a batch that has not been applied yet, indexed by
+  /// both ends of each edge. The CFG already reflects the whole batch, so
+  /// these edges are undone whenever the successors or predecessors of a
+  /// block are enumerated.
+  struct BatchUpdateInfo {
+    FutureUpdateMapType FutureSuccessors;
+    FutureUpdateMapType FuturePredecessors;
+  };
+
+  /// \brief Scratch state of a SemiNCA computation over the nodes reached by
+  /// one depth-first search.
+  struct SemiNCAInfo {
+    struct NodeInfo {
+      unsigned DFSNum = 0;
+      unsigned Parent = 0;
+      unsigned Semi = 0;
+      NodeT *Label = nullptr;
+      NodeT *IDom = nullptr;
+      SmallVector<NodeT *, 2> ReverseChildren;
+    };
+
+    // NumToNode[0] is unused, the search root has number 1.
+    std::vector<NodeT *> NumToNode;
+    DenseMap<NodeT *, NodeInfo> NodeToInfo;
+
+    SemiNCAInfo() : NumToNode(1, nullptr) {}
+
+    /// Number the nodes reachable from \p Root in depth-first order, only
+    /// descending along the edges From -> To for which Descend(From, To)
+    /// holds.
+    template <typename DescendCondition>
+    void runDFS(const DominatorTreeBase &DT, const BatchUpdateInfo &BUI,
+                NodeT *Root, DescendCondition Descend) {
+      SmallVector<NodeT *, 32> WorkList(1, Root);
+      SmallVector<NodeT *, 8> Succs;
+      NodeToInfo[Root];
+
+      while (!WorkList.empty()) {
+        NodeT *BB = WorkList.pop_back_val();
+        NodeInfo &BBInfo = NodeToInfo[BB];
+        if (BBInfo.DFSNum != 0)
+          continue;
+        const unsigned BBNum = NumToNode.size();
+        BBInfo.DFSNum = BBInfo.Semi = BBNum;
+        BBInfo.Label = BB;
+        NumToNode.push_back(BB);
+
+        DT.getTreeSuccessors(BB, BUI, Succs);
+        for (NodeT *Succ : Succs) {
+          auto SIT = NodeToInfo.find(Succ);
+          // Don't visit nodes twice, but remember every edge between visited
+          // nodes.
+          if (SIT != NodeToInfo.end() && SIT->second.DFSNum != 0) {
+            if (Succ != BB)
+              SIT->second.ReverseChildren.push_back(BB);
+            continue;
+          }
+
+          if (!Descend(BB, Succ))
+            continue;
+
+          NodeInfo &SuccInfo = NodeToInfo[Succ];
+          WorkList.push_back(Succ);
+          SuccInfo.Parent = BBNum;
+          SuccInfo.ReverseChildren.push_back(BB);
+        }
+      }
+    }
+
+    NodeT *eval(NodeT *VIn, unsigned LastLinked) {
+      NodeInfo &VInInfo = NodeToInfo[VIn];
+      if (VInInfo.DFSNum < LastLinked)
+        return VIn;
+
+      SmallVector<NodeT *, 32> Work;
+      SmallPtrSet<NodeT *, 32> Visited;
+
+      if (VInInfo.Parent >= LastLinked)
+        Work.push_back(VIn);
+
+      while (!Work.empty()) {
+        NodeT *V = Work.back();
+        NodeInfo &VInfo = NodeToInfo[V];
+        NodeT *VAncestor = NumToNode[VInfo.Parent];
+
+        // Process the ancestor first.
+        if (Visited.insert(VAncestor).second && VInfo.Parent >= LastLinked) {
+          Work.push_back(VAncestor);
+          continue;
+        }
+        Work.pop_back();
+
+        // Update VInfo based on the ancestor info.
+        if (VInfo.Parent < LastLinked)
+          continue;
+
+        NodeInfo &VAInfo = NodeToInfo[VAncestor];
+        NodeT *VAncestorLabel = VAInfo.Label;
+        NodeT *VLabel = VInfo.Label;
+        if (NodeToInfo[VAncestorLabel].Semi < NodeToInfo[VLabel].Semi)
+          VInfo.Label = VAncestorLabel;
+        VInfo.Parent = VAInfo.Parent;
+      }
+
+      return VInInfo.Label;
+    }
+
+    /// Compute the immediate dominator of every node numbered by runDFS()
+    /// except the root, considering only the edges seen by the search.
+    void runSemiNCA() {
+      const unsigned NextDFSNum = NumToNode.size();
+
+      // Initialize the immediate dominators to the spanning tree parents.
+      for (unsigned i = 2; i < NextDFSNum; ++i) {
+        NodeInfo &VInfo = NodeToInfo[NumToNode[i]];
+        VInfo.IDom = NumToNode[VInfo.Parent];
+      }
+
+      // Compute the semidominators, in reverse preorder.
+      for (unsigned i = NextDFSNum - 1; i >= 2; --i) {
+        NodeInfo &WInfo = NodeToInfo[NumToNode[i]];
+        WInfo.Semi = WInfo.Parent;
+        for (NodeT *N : WInfo.ReverseChildren) {
+          unsigned SemiU = NodeToInfo[eval(N, i + 1)].Semi;
+          if (SemiU < WInfo.Semi)
+            WInfo.Semi = SemiU;
+        }
+      }
+
+      // The immediate dominator is the nearest ancestor in the spanning tree
+      // whose number is not greater than the semidominator's.
+      for (unsigned i = 2; i < NextDFSNum; ++i) {
+        NodeInfo &WInfo = NodeToInfo[NumToNode[i]];
+        NodeT *WIDomCandidate = WInfo.IDom;
+        while (NodeToInfo[WIDomCandidate].DFSNum > WInfo.Semi)
+          WIDomCandidate = NodeToInfo[WIDomCandidate].IDom;
+        WInfo.IDom = WIDomCandidate;
+      }
+    }
+  };
+
+  /// \brief Apply the legalized \p Updates to the tree of \p F one at a
+  /// time, recomputing the tree instead if one of them cannot be handled.
+  template <class FT>
+  void applyUpdatesIncrementally(FT &F, ArrayRef<UpdateType> Updates) {
+    BatchUpdateInfo BUI;
+    for (const UpdateType &U : Updates) {
+      BUI.FutureSuccessors[U.From].push_back(std::make_pair(U.To, U.Kind));
+      BUI.FuturePredecessors[U.To].push_back(std::make_pair(U.From, U.Kind));
+    }
+
+    for (const UpdateType &U : Updates) {
+      // From here on, the graph seen by the algorithms includes U.
+      forgetFutureUpdate(BUI.FutureSuccessors, U.From, U.To);
+      forgetFutureUpdate(BUI.FuturePredecessors, U.To, U.From);
+
+      if (!applyUpdate(U, BUI)) {
+        recalculate(F);
+        return;
+      }
+    }
+
+    if (this->IsPostDominators && !hasExpectedPostDomRoot(F))
+      recalculate(F);
+  }
+
+  static void forgetFutureUpdate(FutureUpdateMapType &Map, NodeT *N,
+                                 NodeT *Other) {
+    auto &List = Map[N];
+    List.erase(std::find_if(List.begin(), List.end(),
+                            [Other](const std::pair<NodeT *, UpdateKind> &P) {
+                              return P.first == Other;
+                            }));
+  }
+
+  /// \brief Apply \p U to the tree. Return false if the tree has to be
+  /// recomputed instead.
+  bool applyUpdate(const UpdateType &U, const BatchUpdateInfo &BUI) {
+    if (!this->IsPostDominators) {
+      if (U.Kind == UpdateKind::Insert)
+        insertTreeEdge(U.From, U.To, BUI);
+      else
+        deleteTreeEdge(U.From, U.To, BUI);
+      return true;
+    }
+
+    // The roots of a post-dominator tree are the exits of the graph. Updates
+    // that change which blocks are exits are not handled incrementally.
+    if (isExit(U.From, BUI) != is_contained(this->Roots, U.From) ||
+        isExit(U.To, BUI) != is_contained(this->Roots, U.To))
+      return false;
+
+    // Neither are trees that leave out their only exit, see
+    // hasExpectedPostDomRoot().
+    if (this->Roots.size() == 1 && !lookupNode(this->Roots.front()))
+      return false;
+
+    if (U.Kind == UpdateKind::Insert)
+      insertTreeEdge(U.To, U.From, BUI);
+    else
+      deleteTreeEdge(U.To, U.From, BUI);
+    return true;
+  }
+
+  /// \brief Return true if the root of the post-dominator tree is the one a
+  /// fresh computation for \p F would pick: the single exit, or the virtual
+  /// exit if there are several exits or blocks that cannot reach any exit.
+  template <class FT> bool hasExpectedPostDomRoot(FT &F) const {
+    if (!RootNode)
+      return this->Roots.empty();
+
+    bool HasVirtualRoot = RootNode->getBlock() == nullptr;
+    size_t NumBlocks = DomTreeNodes.size() - (HasVirtualRoot ? 1 : 0);
+
+    // Below a virtual exit, Calculate() only creates a node for the only real
+    // exit if some other block reaches it.
+    if (HasVirtualRoot && this->Roots.size() == 1 && NumBlocks == 1)
+      return false;
+
+    bool NeedsVirtualRoot = this->Roots.size() > 1 ||
+                            NumBlocks != GraphTraits<FT *>::size(&F);
+    return HasVirtualRoot == NeedsVirtualRoot;
+  }
+
+  /// \brief Return in \p Out the successors of \p N in the CFG, or its
+  /// predecessors if \p Reverse is true, before the rest of the batch.
+  static void getCFGChildren(NodeT *N, bool Reverse,
+                             const BatchUpdateInfo &BUI,
+                             SmallVectorImpl<NodeT *> &Out) {
+    Out.clear();
+    if (Reverse)
+      Out.append(GraphTraits<Inverse<NodeT *>>::child_begin(N),
+                 GraphTraits<Inverse<NodeT *>>::child_end(N));
+    else
+      Out.append(GraphTraits<NodeT *>::child_begin(N),
+                 GraphTraits<NodeT *>::child_end(N));
+
+    const FutureUpdateMapType &Future =
+        Reverse ? BUI.FuturePredecessors : BUI.FutureSuccessors;
+    auto FI = Future.find(N);
+    if (FI == Future.end())
+      return;
+
+    // An edge inserted later in the batch is not there yet, and an edge
+    // deleted later in the batch is still there.
+    for (const auto &U : FI->second) {
+      if (U.second == UpdateKind::Insert)
+        Out.erase(std::remove(Out.begin(), Out.end(), U.first), Out.end());
+      else
+        Out.push_back(U.first);
+    }
+  }
+
+  static bool isExit(NodeT *N, const BatchUpdateInfo &BUI) {
+    SmallVector<NodeT *, 8> Succs;
+    getCFGChildren(N, /*Reverse=*/false, BUI, Succs);
+    return Succs.empty();
+  }
+
+  /// \brief Return in \p Out the successors of \p N in the graph the tree is
+  /// built on.
+  void getTreeSuccessors(NodeT *N, const BatchUpdateInfo &BUI,
+                         SmallVectorImpl<NodeT *> &Out) const {
+    if (!this->IsPostDominators)
+      return getCFGChildren(N, /*Reverse=*/false, BUI, Out);
+
+    if (!N) {
+      Out.clear();
+      Out.append(this->Roots.begin(), this->Roots.end());
+      return;
+    }
+    getCFGChildren(N, /*Reverse=*/true, BUI, Out);
+  }
+
+  /// \brief Return in \p Out the predecessors of \p N in the graph the tree
+  /// is built on.
+  void getTreePredecessors(NodeT *N, const BatchUpdateInfo &BUI,
+                           SmallVectorImpl<NodeT *> &Out) const {
+    if (!this->IsPostDominators)
+      return getCFGChildren(N, /*Reverse=*/true, BUI, Out);
+
+    getCFGChildren(N, /*Reverse=*/false, BUI, Out);
+    if (RootNode && !RootNode->getBlock() && is_contained(this->Roots, N))
+      Out.push_back(nullptr);
+  }
+
+  /// \brief Like getNode(), without applying pending updates.
+  DomTreeNodeBase<NodeT> *lookupNode(NodeT *BB) const {
+    auto I = DomTreeNodes.find(BB);
+    return I != DomTreeNodes.end() ? I->second.get() : nullptr;
+  }
+
+  /// \brief Return the nearest common dominator of \p A and \p B, using the
+  /// node levels only.
+  static DomTreeNodeBase<NodeT> *
+  findNCDByLevel(DomTreeNodeBase<NodeT> *A, DomTreeNodeBase<NodeT> *B) {
+    while (A != B) {
+      if (A->getLevel() < B->getLevel())
+        std::swap(A, B);
+      A = A->IDom;
+    }
+    return A;
+  }
+
+  /// \brief Make \p NewIDom the immediate dominator of \p TN without updating
+  /// the levels.
+  static void reattach(DomTreeNodeBase<NodeT> *TN,
+                       DomTreeNodeBase<NodeT> *NewIDom) {
+    if (TN->IDom == NewIDom)
+      return;
+    auto &Siblings = TN->IDom->Children;
+    Siblings.erase(find(Siblings, TN));
+    TN->IDom = NewIDom;
+    NewIDom->Children.push_back(TN);
+  }
+
+  /// \brief Recompute the levels of the proper descendants of \p TN.
+  static void updateLevels(DomTreeNodeBase<NodeT> *TN) {
+    SmallVector<DomTreeNodeBase<NodeT> *, 32> WorkList(1, TN);
+    while (!WorkList.empty()) {
+      DomTreeNodeBase<NodeT> *Current = WorkList.pop_back_val();
+      for (DomTreeNodeBase<NodeT> *C : *Current) {
+        C->Level = Current->Level + 1;
+        WorkList.push_back(C);
+      }
+    }
+  }
+
+  /// \brief Erase \p Nodes from the tree. Every descendant of a node in
+  /// \p Nodes must be in \p Nodes as well.
+  void eraseNodes(ArrayRef<DomTreeNodeBase<NodeT> *> Nodes) {
+    SmallPtrSet<DomTreeNodeBase<NodeT> *, 16> Erased(Nodes.begin(),
+                                                     Nodes.end());
+    for (DomTreeNodeBase<NodeT> *TN : Nodes)
+      if (!Erased.count(TN->IDom)) {
+        auto &Siblings = TN->IDom->Children;
+        Siblings.erase(find(Siblings, TN));
+      }
+    for (DomTreeNodeBase<NodeT> *TN : Nodes)
+      DomTreeNodes.erase(TN->getBlock());
+  }
+
+  /// \brief Update the tree for the new edge From -> To of the graph it is
+  /// built on.
+  void insertTreeEdge(NodeT *From, NodeT *To, const BatchUpdateInfo &BUI) {
+    // Edges out of unreachable blocks do not change dominance.
+    DomTreeNodeBase<NodeT> *FromTN = lookupNode(From);
+    if (!FromTN)
+      return;
+
+    if (DomTreeNodeBase<NodeT> *ToTN = lookupNode(To))
+      insertReachable(FromTN, ToTN, BUI);
+    else
+      insertUnreachable(FromTN, To, BUI);
+  }
+
+  void insertReachable(DomTreeNodeBase<NodeT> *FromTN,
+                       DomTreeNodeBase<NodeT> *ToTN,
+                       const BatchUpdateInfo &BUI) {
+    // Every new path to To goes through the nearest common dominator, so
+    // nothing changes if that already dominates To's immediate dominator.
+    DomTreeNodeBase<NodeT> *NCD = findNCDByLevel(FromTN, ToTN);
+    if (NCD == ToTN || NCD == ToTN->IDom)
+      return;
+
+    DFSInfoValid = false;
+
+    // The affected nodes are the ones deeper than NCD's children that can be
+    // reached from To through nodes at least as deep as themselves. Their
+    // new immediate dominator is NCD. Visit them from the deepest up, and
+    // search through the deeper, unaffected nodes on the way.
+    typedef std::pair<unsigned, DomTreeNodeBase<NodeT> *> BucketElementTy;
+    std::priority_queue<BucketElementTy, SmallVector<BucketElementTy, 8>,
+                        less_first>
+        Bucket;
+    SmallPtrSet<DomTreeNodeBase<NodeT> *, 16> Visited;
+    SmallVector<DomTreeNodeBase<NodeT> *, 16> Affected;
+    SmallVector<DomTreeNodeBase<NodeT> *, 16> UnaffectedStack;
+    SmallVector<NodeT *, 8> Succs;
+    const unsigned NCDLevel = NCD->getLevel();
+
+    Bucket.push(std::make_pair(ToTN->getLevel(), ToTN));
+    Visited.insert(ToTN);
+    while (!Bucket.empty()) {
+      DomTreeNodeBase<NodeT> *TN = Bucket.top().second;
+      Bucket.pop();
+      Affected.push_back(TN);
+
+      const unsigned CurrentLevel = TN->getLevel();
+      while (true) {
+        getTreeSuccessors(TN->getBlock(), BUI, Succs);
+        for (NodeT *Succ : Succs) {
+          DomTreeNodeBase<NodeT> *SuccTN = lookupNode(Succ);
+          assert(SuccTN && "Successor of a reachable node is unreachable?");
+          const unsigned SuccLevel = SuccTN->getLevel();
+          if (SuccLevel <= NCDLevel + 1 || !Visited.insert(SuccTN).second)
+            continue;
+
+          if (SuccLevel > CurrentLevel)
+            UnaffectedStack.push_back(SuccTN);
+          else
+            Bucket.push(std::make_pair(SuccLevel, SuccTN));
+        }
+
+        if (UnaffectedStack.empty())
+          break;
+        TN = UnaffectedStack.pop_back_val();
+      }
+    }
+
+    for (DomTreeNodeBase<NodeT> *TN : Affected)
+      reattach(TN, NCD);
+    for (DomTreeNodeBase<NodeT> *TN : Affected)
+      TN->UpdateLevel();
+  }
+
+  void insertUnreachable(DomTreeNodeBase<NodeT> *FromTN, NodeT *To,
+                         const BatchUpdateInfo &BUI) {
+    // Compute the tree of the nodes that become reachable through To, and
+    // remember the edges from them to nodes that were reachable already.
+    SmallVector<std::pair<NodeT *, DomTreeNodeBase<NodeT> *>, 8> Connecting;
+    SemiNCAInfo SNCA;
+    SNCA.runDFS(*this, BUI, To, [&](NodeT *Pred, NodeT *Succ) {
+      if (DomTreeNodeBase<NodeT> *SuccTN = lookupNode(Succ)) {
+        Connecting.push_back(std::make_pair(Pred, SuccTN));
+        return false;
+      }
+      return true;
+    });
+    SNCA.runSemiNCA();
+
+    // The only way into the new nodes is From -> To, so they form a subtree
+    // of From. Immediate dominators come before their children in DFS order.
+    DFSInfoValid = false;
+    for (unsigned i = 1, e = SNCA.NumToNode.size(); i != e; ++i) {
+      NodeT *N = SNCA.NumToNode[i];
+      DomTreeNodeBase<NodeT> *IDomTN =
+          i == 1 ? FromTN : lookupNode(SNCA.NodeToInfo[N].IDom);
+      DomTreeNodes[N] = IDomTN->addChild(
+          llvm::make_unique<DomTreeNodeBase<NodeT>>(N, IDomTN));
+    }
+
+    for (const auto &Edge : Connecting)
+      insertReachable(lookupNode(Edge.first), Edge.second, BUI);
+  }
+
+  /// \brief Update the tree for the deleted edge From -> To of the graph it
+  /// is built on.
+  void deleteTreeEdge(NodeT *From, NodeT *To, const BatchUpdateInfo &BUI) {
+    // Edges out of or into unreachable blocks do not change dominance.
+    DomTreeNodeBase<NodeT> *FromTN = lookupNode(From);
+    DomTreeNodeBase<NodeT> *ToTN = lookupNode(To);
+    if (!FromTN || !ToTN)
+      return;
+
+    // Every path through a back edge already went through its target.
+    DomTreeNodeBase<NodeT> *NCD = findNCDByLevel(FromTN, ToTN);
+    if (NCD == ToTN)
+      return;
+
+    DFSInfoValid = false;
+
+    // To is still reachable if From was not its immediate dominator, or if it
+    // has another predecessor it does not dominate. Then only nodes dominated
+    // by NCD can get a new immediate dominator.
+    if (FromTN != ToTN->IDom || hasProperSupport(ToTN, BUI))
+      rebuildSubtree(NCD, BUI);
+    else
+      deleteUnreachable(ToTN, BUI);
+  }
+
+  bool hasProperSupport(DomTreeNodeBase<NodeT> *TN,
+                        const BatchUpdateInfo &BUI) const {
+    SmallVector<NodeT *, 8> Preds;
+    getTreePredecessors(TN->getBlock(), BUI, Preds);
+    for (NodeT *Pred : Preds) {
+      DomTreeNodeBase<NodeT> *PredTN = lookupNode(Pred);
+      if (PredTN && findNCDByLevel(TN, PredTN) != TN)
+        return true;
+    }
+    return false;
+  }
+
+  /// \brief Erase the subtree of \p ToTN, which became unreachable, and fix
+  /// up the nodes it used to have edges to.
+  void deleteUnreachable(DomTreeNodeBase<NodeT> *ToTN,
+                         const BatchUpdateInfo &BUI) {
+    // The search from To through deeper nodes stays within its subtree.
+    // Nodes outside of it that the subtree has edges to, and that do not
+    // dominate To, lose incoming paths: their new immediate dominator is
+    // dominated by their nearest common dominator with To.
+    DomTreeNodeBase<NodeT> *MinNode = ToTN;
+    const unsigned Level = ToTN->getLevel();
+    SmallVector<DomTreeNodeBase<NodeT> *, 16> Subtree(1, ToTN);
+    SmallPtrSet<DomTreeNodeBase<NodeT> *, 16> Visited;
+    SmallVector<NodeT *, 8> Succs;
+    Visited.insert(ToTN);
+    for (unsigned i = 0; i != Subtree.size(); ++i) {
+      getTreeSuccessors(Subtree[i]->getBlock(), BUI, Succs);
+      for (NodeT *Succ : Succs) {
+        DomTreeNodeBase<NodeT> *SuccTN = lookupNode(Succ);
+        if (!SuccTN)
+          continue;
+        if (SuccTN->getLevel() > Level) {
+          if (Visited.insert(SuccTN).second)
+            Subtree.push_back(SuccTN);
+          continue;
+        }
+
+        DomTreeNodeBase<NodeT> *NCD = findNCDByLevel(SuccTN, ToTN);
+        if (NCD != SuccTN && NCD->getLevel() < MinNode->getLevel())
+          MinNode = NCD;
+      }
+    }
+
+    if (MinNode != ToTN)
+      return rebuildSubtree(MinNode, BUI);
+
+    SmallVector<DomTreeNodeBase<NodeT> *, 16> Erased(1, ToTN);
+    for (unsigned i = 0; i != Erased.size(); ++i)
+      Erased.append(Erased[i]->begin(), Erased[i]->end());
+    eraseNodes(Erased);
+  }
+
+  /// \brief Recompute the subtree of \p TN, erasing the nodes that are no
+  /// longer reachable.
+  void rebuildSubtree(DomTreeNodeBase<NodeT> *TN, const BatchUpdateInfo &BUI) {
+    // Every edge into a node dominated by TN comes from TN or from another
+    // node dominated by TN, and all of those are deeper than TN.
+    const unsigned Level = TN->getLevel();
+    SemiNCAInfo SNCA;
+    SNCA.runDFS(*this, BUI, TN->getBlock(), [&](NodeT *, NodeT *Succ) {
+      DomTreeNodeBase<NodeT> *SuccTN = lookupNode(Succ);
+      return SuccTN && SuccTN->getLevel() > Level;
+    });
+    SNCA.runSemiNCA();
+
+    SmallVector<DomTreeNodeBase<NodeT> *, 16> Unreachable;
+    SmallVector<DomTreeNodeBase<NodeT> *, 16> WorkList(TN->begin(),
+                                                       TN->end());
+    while (!WorkList.empty()) {
+      DomTreeNodeBase<NodeT> *Current = WorkList.pop_back_val();
+      WorkList.append(Current->begin(), Current->end());
+      if (!SNCA.NodeToInfo.count(Current->getBlock()))
+        Unreachable.push_back(Current);
+    }
+
+    for (unsigned i = 2, e = SNCA.NumToNode.size(); i != e; ++i) {
+      NodeT *N = SNCA.NumToNode[i];
+      reattach(lookupNode(N), lookupNode(SNCA.NodeToInfo[N].IDom));
+    }
+    eraseNodes(Unreachable);
+    updateLevels(TN);
+  }
+
 protected:
   typedef DenseMap<NodeT *, std::unique_ptr<DomTreeNodeBase<NodeT>>>
       DomTreeNodeMapType;
@@ -241,6 +903,7 @@ protected:
 
   mutable bool DFSInfoValid;
   mutable unsigned int SlowQueries;
+
   // Information record used during immediate dominators computation.
   struct InfoRec {
     unsigned DFSNum;
@@ -259,11 +922,16 @@ protected:
   // Info - Collection of information used during the computation of idoms.
   DenseMap<NodeT *, InfoRec> Info;
 
+  /// \brief CFG edge updates recorded by applyUpdates() that have not been
+  /// folded into the tree yet.
+  mutable SmallVector<UpdateType, 4> PendingUpdates;
+
   void reset() {
     DomTreeNodes.clear();
     IDoms.clear();
     this->Roots.clear();
     Vertex.clear();
+    PendingUpdates.clear();
     RootNode = nullptr;
     DFSInfoValid = false;
     SlowQueries = 0;
@@ -345,7 +1013,8 @@ public:
         RootNode(std::move(Arg.RootNode)),
         DFSInfoValid(std::move(Arg.DFSInfoValid)),
         SlowQueries(std::move(Arg.SlowQueries)), IDoms(std::move(Arg.IDoms)),
-        Vertex(std::move(Arg.Vertex)), Info(std::move(Arg.Info)) {
+        Vertex(std::move(Arg.Vertex)), Info(std::move(Arg.Info)),
+        PendingUpdates(std::move(Arg.PendingUpdates)) {
     Arg.wipe();
   }
   DominatorTreeBase &operator=(DominatorTreeBase &&RHS) {
@@ -358,6 +1027,7 @@ public:
     IDoms = std::move(RHS.IDoms);
     Vertex = std::move(RHS.Vertex);
     Info = std::move(RHS.Info);
+    PendingUpdates = std::move(RHS.PendingUpdates);
     RHS.wipe();
     return *this;
   }
@@ -365,6 +1035,8 @@ public:
   /// compare - Return false if the other dominator tree base matches this
   /// dominator tree base. Otherwise return true.
   bool compare(const DominatorTreeBase &Other) const {
+    applyPendingUpdates();
+    Other.applyPendingUpdates();
 
     const DomTreeNodeMapType &OtherDomTreeNodes = Other.DomTreeNodes;
     if (DomTreeNodes.size() != OtherDomTreeNodes.size())
@@ -394,6 +1066,7 @@ public:
   /// may (but is not required to) be null for a forward (backwards)
   /// statically unreachable block.
   DomTreeNodeBase<NodeT> *getNode(NodeT *BB) const {
+    applyPendingUpdates();
     auto I = DomTreeNodes.find(BB);
     if (I != DomTreeNodes.end())
       return I->second.get();
@@ -410,8 +1083,21 @@ public:
   /// post-dominance information must be capable of dealing with this
   /// possibility.
   ///
-  DomTreeNodeBase<NodeT> *getRootNode() { return RootNode; }
-  const DomTreeNodeBase<NodeT> *getRootNode() const { return RootNode; }
+  DomTreeNodeBase<NodeT> *getRootNode() {
+    applyPendingUpdates();
+    return RootNode;
+  }
+  const DomTreeNodeBase<NodeT> *getRootNode() const {
+    applyPendingUpdates();
+    return RootNode;
+  }
+
+  /// getRoots - Return the root blocks of the current CFG, after applying any
+  /// pending updates. See DominatorBase::getRoots.
+  const std::vector<NodeT *> &getRoots() const {
+    applyPendingUpdates();
+    return this->Roots;
+  }
 
   /// Get all nodes dominated by R, including R itself.
   void getDescendants(NodeT *R, SmallVectorImpl<NodeT *> &Result) const {
@@ -458,6 +1144,8 @@ public:
   ///
   bool dominates(const DomTreeNodeBase<NodeT> *A,
                  const DomTreeNodeBase<NodeT> *B) const {
+    applyPendingUpdates();
+
     // A node trivially dominates itself.
     if (B == A)
       return true;
@@ -495,6 +1183,7 @@ public:
   bool dominates(const NodeT *A, const NodeT *B) const;
 
   NodeT *getRoot() const {
+    applyPendingUpdates();
     assert(this->Roots.size() == 1 && "Should always have entry node!");
     return this->Roots[0];
   }
@@ -571,10 +1260,40 @@ public:
   // API to update (Post)DominatorTree information based on modifications to
   // the CFG...
 
+  /// applyUpdates - Inform the tree about a batch of edge insertions and
+  /// deletions that have already been made to the CFG. The updates are
+  /// applied lazily and incrementally on the next query, so a transform can
+  /// keep the tree alive across many CFG changes without recomputing it.
+  /// Each update must record an edge that appeared in or disappeared from
+  /// the CFG, and the CFG must not change further before the updates are
+  /// applied. Tree
+  /// nodes obtained before the updates are applied may be invalidated.
+  void applyUpdates(ArrayRef<UpdateType> Updates) {
+    PendingUpdates.append(Updates.begin(), Updates.end());
+  }
+
+  /// insertEdge - Record that the edge From -> To was added to the CFG.
+  void insertEdge(NodeT *From, NodeT *To) {
+    PendingUpdates.push_back({UpdateKind::Insert, From, To});
+  }
+
+  /// deleteEdge - Record that the edge From -> To was removed from the CFG.
+  void deleteEdge(NodeT *From, NodeT *To) {
+    PendingUpdates.push_back({UpdateKind::Delete, From, To});
+  }
+
+  /// hasPendingUpdates - Return true if there are edge updates that have not
+  /// been applied to the tree yet.
+  bool hasPendingUpdates() const { return !PendingUpdates.empty(); }
+
+  /// flush - Apply all pending edge updates now instead of on the next query.
+  void flush() { applyPendingUpdates(); }
+
   /// addNewBlock - Add a new node to the dominator tree information.  This
   /// creates a new node as a child of DomBB dominator node,linking it into
   /// the children list of the immediate dominator.
   DomTreeNodeBase<NodeT> *addNewBlock(NodeT *BB, NodeT *DomBB) {
+    assert(!hasPendingUpdates() && "Flush edge updates before point updates!");
     assert(getNode(BB) == nullptr && "Block already in dominator tree!");
     DomTreeNodeBase<NodeT> *IDomNode = getNode(DomBB);
     assert(IDomNode && "Not immediate dominator specified for block!");
@@ -589,6 +1308,7 @@ public:
   void changeImmediateDominator(DomTreeNodeBase<NodeT> *N,
                                 DomTreeNodeBase<NodeT> *NewIDom) {
     assert(N && NewIDom && "Cannot change null node pointers!");
+    assert(!hasPendingUpdates() && "Flush edge updates before point updates!");
     DFSInfoValid = false;
     N->setIDom(NewIDom);
   }
@@ -601,6 +1321,7 @@ public:
   /// dominate any other blocks. Removes node from its immediate dominator's
   /// children list. Deletes dominator node associated with basic block BB.
   void eraseNode(NodeT *BB) {
+    assert(!hasPendingUpdates() && "Flush edge updates before point updates!");
     DomTreeNodeBase<NodeT> *Node = getNode(BB);
     assert(Node && "Removing node that isn't in dominator tree.");
     assert(Node->getChildren().empty() && "Node is not a leaf node.");
@@ -622,6 +1343,7 @@ public:
   /// splitBlock - BB is split and now it has one successor. Update dominator
   /// tree to reflect this change.
   void splitBlock(NodeT *NewBB) {
+    assert(!hasPendingUpdates() && "Flush edge updates before point updates!");
     if (this->IsPostDominators)
       this->Split<Inverse<NodeT *>, GraphTraits<Inverse<NodeT *>>>(*this,
                                                                    NewBB);
@@ -632,6 +1354,7 @@ public:
   /// print - Convert to human readable form
   ///
   void print(raw_ostream &o) const {
+    applyPendingUpdates();
     o << "=============================--------------------------------\n";
     if (this->isPostDominator())
       o << "Inorder PostDominator Tree: ";
@@ -685,6 +1408,7 @@ public:
   /// updateDFSNumbers - Assign In and Out numbers to the nodes while walking
   /// dominator tree in dfs order.
   void updateDFSNumbers() const {
+    applyPendingUpdates();
 
     if (DFSInfoValid) {
       SlowQueries = 0;
@@ -204,6 +204,12 @@ ModulePass *createMergeFunctionsPass();
 ///
 ModulePass *createPartialInliningPass();
 
+//===----------------------------------------------------------------------===//
+/// createFunctionOrderingPass - This pass reorders functions so that hot
+/// callers and callees are placed close together, using profile counts.
+///
+ModulePass *createFunctionOrderingPass();
+
 //===----------------------------------------------------------------------===//
 // createMetaRenamerPass - Rename everything with metasyntatic names.
 //
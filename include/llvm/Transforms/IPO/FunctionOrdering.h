@@ -0,0 +1,34 @@
+//===- FunctionOrdering.h - Profile guided function ordering ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reorders the functions of a module so that hot callers and their
+// callees end up close to each other, using profile counts and the call-chain
+// clustering (C3) heuristic.
+//
+// It is not part of any default pipeline. Run it with
+// 'opt -function-ordering' (or '-passes=function-ordering'), optionally with
+// -function-order-file=<file> to also write a linker symbol ordering file.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TRANSFORMS_IPO_FUNCTIONORDERING_H
+#define LLVM_TRANSFORMS_IPO_FUNCTIONORDERING_H
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+
+/// Pass to lay out functions by call-graph affinity.
+class FunctionOrderingPass : public PassInfoMixin<FunctionOrderingPass> {
+public:
+  PreservedAnalyses run(Module &M, ModuleAnalysisManager &AM);
+};
+}
+#endif // LLVM_TRANSFORMS_IPO_FUNCTIONORDERING_H
@@ -25,6 +25,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/BasicAliasAnalysis.h"
 #include "llvm/Analysis/CFG.h"
 #include "llvm/Analysis/CFLAndersAliasAnalysis.h"
@@ -48,12 +49,34 @@
 #include "llvm/Pass.h"
 using namespace llvm;
 
+#define DEBUG_TYPE "aa"
+
+STATISTIC(NumAliasQueryCacheHits, "Number of alias queries answered from the "
+                                  "query cache");
+STATISTIC(NumAliasQueryCacheMisses, "Number of alias queries not found in the "
+                                    "query cache");
+
 /// Allow disabling BasicAA from the AA results. This is particularly useful
 /// when testing to isolate a single AA implementation.
 static cl::opt<bool> DisableBasicAA("disable-basicaa", cl::Hidden,
                                     cl::init(false));
 
-AAResults::AAResults(AAResults &&Arg) : TLI(Arg.TLI), AAs(std::move(Arg.AAs)) {
+/// Cache top-level alias query results for as long as the function is not
+/// modified. Only the new pass manager tells AAResults when a pass changes the
+/// function, so the legacy pass manager never caches.
+static cl::opt<bool> EnableAAQueryCache(
+    "enable-aa-query-cache", cl::Hidden, cl::init(false),
+    cl::desc("Cache alias query results across queries and passes (new pass "
+             "manager only)"));
+
+AAResults::AAResults(const TargetLibraryInfo &TLI)
+    : TLI(TLI), QueryDepth(0), QueryCacheEnabled(EnableAAQueryCache),
+      QueryCacheStale(false) {}
+
+// The query cache is not moved along: its value handles point back at Arg.
+AAResults::AAResults(AAResults &&Arg)
+    : TLI(Arg.TLI), AAs(std::move(Arg.AAs)), QueryDepth(0),
+      QueryCacheEnabled(Arg.QueryCacheEnabled), QueryCacheStale(false) {
   for (auto &AA : AAs)
     AA->setAAResults(this);
 }
@@ -69,18 +92,69 @@ AAResults::~AAResults() {
 #endif
 }
 
+bool AAResults::invalidate(Function &F, const PreservedAnalyses &PA,
+                           FunctionAnalysisManager::Invalidator &Inv) {
+  if (!PA.areAllPreserved())
+    clearQueryCache();
+  return !PA.preserved<AAManager>();
+}
+
+//===----------------------------------------------------------------------===//
+// Alias query cache
+//===----------------------------------------------------------------------===//
+
+void AAResults::clearQueryCache() {
+  AliasQueryCache.clear();
+  QueryCacheValues.clear();
+  QueryCacheHandles.clear();
+  QueryCacheStale = false;
+}
+
+void AAResults::trackQueryCacheValue(const Value *V) {
+  if (V && QueryCacheValues.insert(V).second)
+    QueryCacheHandles.emplace_back(V, this);
+}
+
 //===----------------------------------------------------------------------===//
 // Default chaining methods
 //===----------------------------------------------------------------------===//
 
 AliasResult AAResults::alias(const MemoryLocation &LocA,
                              const MemoryLocation &LocB) {
+  if (!QueryCacheEnabled || QueryDepth != 0)
+    return aliasUncached(LocA, LocB);
+
+  if (QueryCacheStale)
+    clearQueryCache();
+
+  // Alias queries are symmetric, so order the key.
+  LocPair Locs =
+      LocB.Ptr < LocA.Ptr ? LocPair(LocB, LocA) : LocPair(LocA, LocB);
+  auto CacheIt = AliasQueryCache.find(Locs);
+  if (CacheIt != AliasQueryCache.end()) {
+    ++NumAliasQueryCacheHits;
+    return CacheIt->second;
+  }
+  ++NumAliasQueryCacheMisses;
+
+  AliasResult Result = aliasUncached(LocA, LocB);
+  AliasQueryCache[Locs] = Result;
+  trackQueryCacheValue(LocA.Ptr);
+  trackQueryCacheValue(LocB.Ptr);
+  return Result;
+}
+
+AliasResult AAResults::aliasUncached(const MemoryLocation &LocA,
+                                     const MemoryLocation &LocB) {
+  AliasResult Result = MayAlias;
+  ++QueryDepth;
   for (const auto &AA : AAs) {
-    auto Result = AA->alias(LocA, LocB);
+    Result = AA->alias(LocA, LocB);
     if (Result != MayAlias)
-      return Result;
+      break;
   }
-  return MayAlias;
+  --QueryDepth;
+  return Result;
 }
 
 bool AAResults::pointsToConstantMemory(const MemoryLocation &Loc,
@@ -590,6 +664,10 @@ bool AAResultsWrapperPass::runOnFunction(Function &F) {
   AAR.reset(
       new AAResults(getAnalysis<TargetLibraryInfoWrapperPass>().getTLI()));
 
+  // Passes that change the IR may preserve this pass without invalidating
+  // anything, so cached alias results could go stale.
+  AAR->setQueryCacheEnabled(false);
+
   // BasicAA is always available for function analyses. Also, we add it first
   // so that it can trump TBAA results when it proves MustAlias.
   // FIXME: TBAA should have an explicit mode to support this and then we
@@ -645,6 +723,7 @@ void AAResultsWrapperPass::getAnalysisUsage(AnalysisUsage &AU) const {
 AAResults llvm::createLegacyPMAAResults(Pass &P, Function &F,
                                         BasicAAResult &BAR) {
   AAResults AAR(P.getAnalysis<TargetLibraryInfoWrapperPass>().getTLI());
+  AAR.setQueryCacheEnabled(false);
 
   // Add in our explicitly constructed BasicAA results.
   if (!DisableBasicAA)
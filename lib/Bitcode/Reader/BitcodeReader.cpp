@@ -6143,6 +6143,19 @@ Error ModuleSummaryIndexBitcodeReader::parseModule(StringRef ModulePath) {
   }
 }
 
+/// Return the number of call graph edges encoded in the \p NumFields record
+/// fields that follow the reference list, following the layout decoded by
+/// readCallGraphEdge.
+static unsigned getNumCallGraphEdges(unsigned NumFields,
+                                     bool IsOldProfileFormat, bool HasProfile) {
+  unsigned FieldsPerEdge = 1;
+  if (IsOldProfileFormat)
+    FieldsPerEdge += HasProfile ? 2 : 1;
+  else if (HasProfile)
+    FieldsPerEdge += 1;
+  return NumFields / FieldsPerEdge;
+}
+
 // Eagerly parse the entire summary block. This populates the GlobalValueSummary
 // objects in the index.
 Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(
@@ -6231,12 +6244,16 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(
       int CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
       assert(Record.size() >= RefListStartIndex + NumRefs &&
              "Record size inconsistent with number of references");
+      FS->reserveRefEdges(NumRefs);
       for (unsigned I = 4, E = CallGraphEdgeStartIndex; I != E; ++I) {
         unsigned RefValueId = Record[I];
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
         FS->addRefEdge(RefGUID);
       }
       bool HasProfile = (BitCode == bitc::FS_PERMODULE_PROFILE);
+      FS->reserveCallGraphEdges(
+          getNumCallGraphEdges(Record.size() - CallGraphEdgeStartIndex,
+                               IsOldProfileFormat, HasProfile));
       for (unsigned I = CallGraphEdgeStartIndex, E = Record.size(); I != E;
            ++I) {
         CalleeInfo::HotnessType Hotness;
@@ -6285,6 +6302,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(
       std::unique_ptr<GlobalVarSummary> FS =
           llvm::make_unique<GlobalVarSummary>(Flags);
       FS->setModulePath(TheIndex.addModulePath(ModulePath, 0)->first());
+      FS->reserveRefEdges(Record.size() - 2);
       for (unsigned I = 2, E = Record.size(); I != E; ++I) {
         unsigned RefValueId = Record[I];
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
@@ -6315,6 +6333,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(
       int CallGraphEdgeStartIndex = RefListStartIndex + NumRefs;
       assert(Record.size() >= RefListStartIndex + NumRefs &&
              "Record size inconsistent with number of references");
+      FS->reserveRefEdges(NumRefs);
       for (unsigned I = RefListStartIndex, E = CallGraphEdgeStartIndex; I != E;
            ++I) {
         unsigned RefValueId = Record[I];
@@ -6322,6 +6341,9 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(
         FS->addRefEdge(RefGUID);
       }
       bool HasProfile = (BitCode == bitc::FS_COMBINED_PROFILE);
+      FS->reserveCallGraphEdges(
+          getNumCallGraphEdges(Record.size() - CallGraphEdgeStartIndex,
+                               IsOldProfileFormat, HasProfile));
       for (unsigned I = CallGraphEdgeStartIndex, E = Record.size(); I != E;
            ++I) {
         CalleeInfo::HotnessType Hotness;
@@ -6370,6 +6392,7 @@ Error ModuleSummaryIndexBitcodeReader::parseEntireSummary(
           llvm::make_unique<GlobalVarSummary>(Flags);
       LastSeenSummary = FS.get();
       FS->setModulePath(ModuleIdMap[ModuleId]);
+      FS->reserveRefEdges(Record.size() - 3);
       for (unsigned I = 3, E = Record.size(); I != E; ++I) {
         unsigned RefValueId = Record[I];
         GlobalValue::GUID RefGUID = getGUIDFromValueId(RefValueId).first;
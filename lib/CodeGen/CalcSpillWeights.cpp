@@ -14,7 +14,9 @@
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetInstrInfo.h"
 #include "llvm/Target/TargetRegisterInfo.h"
@@ -23,6 +25,15 @@ using namespace llvm;
 
 #define DEBUG_TYPE "calcspillweights"
 
+static cl::opt<unsigned> SpillWeightThreads(
+    "spill-weight-threads", cl::Hidden, cl::init(1),
+    cl::desc("Number of threads used to compute the initial spill weights "
+             "and hints before register allocation (experimental)"));
+
+static cl::opt<unsigned> SpillWeightChunkSize(
+    "spill-weight-chunk-size", cl::Hidden, cl::init(512),
+    cl::desc("Number of live intervals handed to each spill weight task"));
+
 void llvm::calculateSpillWeightsAndHints(LiveIntervals &LIS,
                            MachineFunction &MF,
                            VirtRegMap *VRM,
@@ -34,12 +45,53 @@ void llvm::calculateSpillWeightsAndHints(LiveIntervals &LIS,
 
   MachineRegisterInfo &MRI = MF.getRegInfo();
   VirtRegAuxInfo VRAI(MF, LIS, VRM, MLI, MBFI, norm);
+
+  // Materialize all the intervals up front. LIS.getInterval() may compute a
+  // missing interval, which must not happen from the worker threads.
+  SmallVector<LiveInterval *, 64> Intervals;
   for (unsigned i = 0, e = MRI.getNumVirtRegs(); i != e; ++i) {
     unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
     if (MRI.reg_nodbg_empty(Reg))
       continue;
-    VRAI.calculateSpillWeightAndHint(LIS.getInterval(Reg));
+    Intervals.push_back(&LIS.getInterval(Reg));
+  }
+
+  // Smaller functions aren't worth the cost of going through the thread pool.
+  unsigned ChunkSize = std::max(1u, unsigned(SpillWeightChunkSize));
+  unsigned NumChunks = (Intervals.size() + ChunkSize - 1) / ChunkSize;
+  unsigned NumThreads = std::min<unsigned>(SpillWeightThreads, NumChunks);
+  if (NumThreads <= 1) {
+    for (LiveInterval *LI : Intervals)
+      VRAI.calculateSpillWeightAndHint(*LI);
+    return;
+  }
+
+  // Walking the uses of each interval is independent of every other
+  // interval, so farm it out in chunks. Each task gets its own
+  // VirtRegAuxInfo since the hint map is scratch state.
+  std::vector<float> TotalWeights(Intervals.size());
+  std::vector<unsigned> NumInstrs(Intervals.size());
+  std::vector<char> NeedsFinish(Intervals.size());
+  {
+    ThreadPool Pool(NumThreads);
+    for (unsigned Begin = 0, E = Intervals.size(); Begin < E;
+         Begin += ChunkSize) {
+      unsigned End = std::min(Begin + ChunkSize, E);
+      Pool.async([&, Begin, End]() {
+        VirtRegAuxInfo TaskVRAI(MF, LIS, VRM, MLI, MBFI, norm);
+        for (unsigned I = Begin; I != End; ++I)
+          NeedsFinish[I] = TaskVRAI.weightCalcHelper(
+              *Intervals[I], TotalWeights[I], NumInstrs[I]);
+      });
+    }
+    Pool.wait();
   }
+
+  // The rematerialization check may query alias analysis, which isn't
+  // thread-safe, so finish the weights on this thread in the usual order.
+  for (unsigned I = 0, E = Intervals.size(); I != E; ++I)
+    if (NeedsFinish[I])
+      VRAI.finishSpillWeight(*Intervals[I], TotalWeights[I], NumInstrs[I]);
 }
 
 // Return the preferred allocation register for reg, given a COPY instruction.
@@ -129,6 +181,14 @@ static bool isRematerializable(const LiveInterval &LI,
 
 void
 VirtRegAuxInfo::calculateSpillWeightAndHint(LiveInterval &li) {
+  float totalWeight;
+  unsigned numInstr;
+  if (weightCalcHelper(li, totalWeight, numInstr))
+    finishSpillWeight(li, totalWeight, numInstr);
+}
+
+bool VirtRegAuxInfo::weightCalcHelper(LiveInterval &li, float &TotalWeight,
+                                      unsigned &NumInstr) {
   MachineRegisterInfo &mri = MF.getRegInfo();
   const TargetRegisterInfo &tri = *MF.getSubtarget().getRegisterInfo();
   MachineBasicBlock *mbb = nullptr;
@@ -214,7 +274,7 @@ VirtRegAuxInfo::calculateSpillWeightAndHint(LiveInterval &li) {
 
   // If the live interval was already unspillable, leave it that way.
   if (!Spillable)
-    return;
+    return false;
 
   // Mark li as unspillable if all live ranges are tiny and the interval
   // is not live at any reg mask.  If the interval is live at a reg mask
@@ -222,9 +282,16 @@ VirtRegAuxInfo::calculateSpillWeightAndHint(LiveInterval &li) {
   if (li.isZeroLength(LIS.getSlotIndexes()) &&
       !li.isLiveAtIndexes(LIS.getRegMaskSlots())) {
     li.markNotSpillable();
-    return;
+    return false;
   }
 
+  TotalWeight = totalWeight;
+  NumInstr = numInstr;
+  return true;
+}
+
+void VirtRegAuxInfo::finishSpillWeight(LiveInterval &li, float totalWeight,
+                                       unsigned numInstr) {
   // If all of the definitions of the interval are re-materializable,
   // it is a preferred candidate for spilling.
   // FIXME: this gets much more complicated once we support non-trivial
@@ -141,6 +141,9 @@ bool InstructionSelect::runOnMachineFunction(MachineFunction &MF) {
   // register class.
   for (auto &VRegToType : MRI.getVRegToType()) {
     unsigned VReg = VRegToType.first;
+    // The selector may have erased every instruction that referred to VReg.
+    if (MRI.reg_empty(VReg))
+      continue;
     auto *RC = MRI.getRegClassOrNull(VReg);
     auto *MI = MRI.def_instr_begin(VReg) == MRI.def_instr_end()
                    ? nullptr
@@ -39,8 +39,18 @@ bool InstructionSelector::constrainSelectedInstRegOperands(
     DEBUG(dbgs() << "Converting operand: " << MO << '\n');
     assert(MO.isReg() && "Unsupported non-reg operand");
 
-    // Physical registers don't need to be constrained.
-    if (TRI.isPhysicalRegister(MO.getReg()))
+    // Tie uses to defs as the MCInstrDesc requires, so that two-address
+    // instructions selected by mutating a generic one are rewritten
+    // correctly.
+    if (MO.isUse()) {
+      int DefIdx = I.getDesc().getOperandConstraint(OpI, MCOI::TIED_TO);
+      if (DefIdx != -1 && !I.isRegTiedToUseOperand(DefIdx))
+        I.tieOperands(DefIdx, OpI);
+    }
+
+    // Physical registers don't need to be constrained, and neither do unused
+    // register slots such as the index of an X86 memory reference.
+    if (!MO.getReg() || TRI.isPhysicalRegister(MO.getReg()))
       continue;
 
     const TargetRegisterClass *RC = TII.getRegClass(I.getDesc(), OpI, &TRI, MF);
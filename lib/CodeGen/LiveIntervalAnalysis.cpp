@@ -58,6 +58,11 @@ static cl::opt<bool> EnablePrecomputePhysRegs(
 static bool EnablePrecomputePhysRegs = false;
 #endif // NDEBUG
 
+static cl::opt<bool> VerifyLiveIntervals(
+    "verify-live-intervals", cl::Hidden,
+    cl::desc("Verify that preserved live intervals match a full recompute "
+             "(time consuming)"));
+
 namespace llvm {
 cl::opt<bool> UseSegmentSetForPhysRegs(
     "use-segment-set-for-physregs", cl::Hidden, cl::init(true),
@@ -159,6 +164,108 @@ void LiveIntervals::print(raw_ostream &OS, const Module* ) const {
   printInstrs(OS);
 }
 
+/// Append the segments of LR to Out, merging adjacent segments. Segments can
+/// be split at value boundaries differently depending on how the range was
+/// built, which doesn't matter for liveness. Dead PHI values are skipped like
+/// computeDeadValues() and shrinkToUses() drop them.
+static void getCoveredRanges(const LiveRange &LR,
+                             SmallVectorImpl<LiveRange::Segment> &Out) {
+  Out.clear();
+  for (const LiveRange::Segment &S : LR.segments) {
+    if (S.valno->isPHIDef() && S.start == S.valno->def &&
+        S.end == S.valno->def.getDeadSlot())
+      continue;
+    if (!Out.empty() && Out.back().end == S.start)
+      Out.back().end = S.end;
+    else
+      Out.push_back(LiveRange::Segment(S.start, S.end, nullptr));
+  }
+}
+
+/// Return true if \p A and \p B cover the same slots.
+static bool coverSameRanges(const LiveRange &A, const LiveRange &B) {
+  SmallVector<LiveRange::Segment, 16> CoveredA, CoveredB;
+  getCoveredRanges(A, CoveredA);
+  getCoveredRanges(B, CoveredB);
+  if (CoveredA.size() != CoveredB.size())
+    return false;
+  for (unsigned I = 0, E = CoveredA.size(); I != E; ++I)
+    if (CoveredA[I].start != CoveredB[I].start ||
+        CoveredA[I].end != CoveredB[I].end)
+      return false;
+  return true;
+}
+
+/// Return the range that holds the liveness of \p Lane in \p LI. Without
+/// subranges, the main range stands for every lane.
+static const LiveRange &getRangeForLane(const LiveInterval &LI,
+                                        LaneBitmask Lane,
+                                        const LiveRange &Empty) {
+  if (!LI.hasSubRanges())
+    return LI;
+  for (const LiveInterval::SubRange &SR : LI.subranges())
+    if (SR.LaneMask & Lane)
+      return SR;
+  return Empty;
+}
+
+/// Return true if \p A and \p B have the same liveness for every lane. The
+/// lanes may be grouped into subranges differently, or not split at all.
+static bool coverSameLanes(const LiveInterval &A, const LiveInterval &B) {
+  LaneBitmask Lanes = 0;
+  for (const LiveInterval::SubRange &SR : A.subranges())
+    Lanes |= SR.LaneMask;
+  for (const LiveInterval::SubRange &SR : B.subranges())
+    Lanes |= SR.LaneMask;
+
+  const LiveRange Empty;
+  for (LaneBitmask Lane = 1; Lanes; Lane <<= 1) {
+    if (!(Lanes & Lane))
+      continue;
+    Lanes &= ~Lane;
+    if (!coverSameRanges(getRangeForLane(A, Lane, Empty),
+                         getRangeForLane(B, Lane, Empty)))
+      return false;
+  }
+  return true;
+}
+
+void LiveIntervals::verifyAnalysis() const {
+  if (!VerifyLiveIntervals)
+    return;
+
+  // Recompute each interval with a scratch calculator and allocator so the
+  // preserved state, including the dead flags on operands, is left untouched.
+  VNInfo::Allocator Allocator;
+  LiveRangeCalc Calc;
+  Calc.reset(MF, Indexes, DomTree, &Allocator);
+
+  bool Failed = false;
+  for (unsigned i = 0, e = MRI->getNumVirtRegs(); i != e; ++i) {
+    unsigned Reg = TargetRegisterInfo::index2VirtReg(i);
+    if (!hasInterval(Reg) || MRI->reg_nodbg_empty(Reg))
+      continue;
+    const LiveInterval &LI = getInterval(Reg);
+
+    bool TrackSubRegs = MRI->shouldTrackSubRegLiveness(Reg);
+    LiveInterval Fresh(Reg, 0.0F);
+    Calc.calculate(Fresh, TrackSubRegs);
+
+    if (coverSameRanges(LI, Fresh) &&
+        (!TrackSubRegs || coverSameLanes(LI, Fresh)))
+      continue;
+
+    errs() << "Live interval of " << PrintReg(Reg) << " is not up to date!\n"
+           << "Preserved: " << LI << "\nComputed:  " << Fresh << '\n';
+    Failed = true;
+  }
+
+  if (Failed) {
+    printInstrs(errs());
+    report_fatal_error("LiveIntervals is not up to date!");
+  }
+}
+
 void LiveIntervals::printInstrs(raw_ostream &OS) const {
   OS << "********** MACHINEINSTRS **********\n";
   MF->print(OS, Indexes);
@@ -14,6 +14,7 @@
 
 #include "llvm/CodeGen/MachineScheduler.h"
 #include "llvm/ADT/PriorityQueue.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
 #include "llvm/CodeGen/LiveIntervalAnalysis.h"
 #include "llvm/CodeGen/MachineDominators.h"
@@ -35,6 +36,9 @@ using namespace llvm;
 
 #define DEBUG_TYPE "misched"
 
+STATISTIC(NumClippedRegions,
+          "Number of scheduling regions clipped by -misched-region-limit");
+
 namespace llvm {
 cl::opt<bool> ForceTopDown("misched-topdown", cl::Hidden,
                            cl::desc("Force top-down list scheduling"));
@@ -70,6 +74,13 @@ static bool ViewMISchedDAGs = false;
 static cl::opt<unsigned> ReadyListLimit("misched-limit", cl::Hidden,
   cl::desc("Limit ready list to N instructions"), cl::init(256));
 
+/// Bound the cost of building the scheduling DAG, which is superlinear in the
+/// number of memory operations, by splitting large regions. The instruction at
+/// each split point is left in place, like a scheduling boundary.
+static cl::opt<unsigned> RegionSizeLimit("misched-region-limit", cl::Hidden,
+  cl::desc("Split scheduling regions after N instructions (0 = unlimited)"),
+  cl::init(0));
+
 static cl::opt<bool> EnableRegPressure("misched-regpressure", cl::Hidden,
   cl::desc("Enable register pressure scheduling."), cl::init(true));
 
@@ -452,6 +463,10 @@ void MachineSchedulerBase::scheduleRegions(ScheduleDAGInstrs &Scheduler,
         MachineInstr &MI = *std::prev(I);
         if (isSchedBoundary(&MI, &*MBB, MF, TII))
           break;
+        if (RegionSizeLimit && NumRegionInstrs == RegionSizeLimit) {
+          ++NumClippedRegions;
+          break;
+        }
         if (!MI.isDebugValue())
           ++NumRegionInstrs;
       }
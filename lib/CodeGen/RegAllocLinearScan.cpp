@@ -0,0 +1,476 @@
+//===-- RegAllocLinearScan.cpp - Linear Scan Register Allocator -----------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the RALinearScan function pass, a linear scan register
+// allocator built on the RegAllocBase framework.
+//
+// Live intervals are visited in order of increasing start point. As the scan
+// moves forward, the assigned intervals that are still live are kept on an
+// active list, and those that are in a lifetime hole on an inactive list;
+// intervals that have ended are dropped. Interference with other virtual
+// registers is read off these lists instead of the LiveIntervalUnions, so each
+// step costs time proportional to the number of live intervals.
+//
+// Each interval is assigned the first interference-free register in its
+// allocation order. When there is none, the physical register whose
+// interfering intervals have the smallest total spill weight is freed by
+// spilling them, unless the current interval is cheaper to spill itself.
+// Intervals are never split or evicted for reassignment. Spilling an earlier
+// interval may create small intervals that start before the scan position;
+// those are assigned through the LiveRegMatrix instead.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/CodeGen/Passes.h"
+#include "AllocationOrder.h"
+#include "LiveDebugVariables.h"
+#include "RegAllocBase.h"
+#include "Spiller.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/CodeGen/CalcSpillWeights.h"
+#include "llvm/CodeGen/LiveIntervalAnalysis.h"
+#include "llvm/CodeGen/LiveRangeEdit.h"
+#include "llvm/CodeGen/LiveRegMatrix.h"
+#include "llvm/CodeGen/LiveStackAnalysis.h"
+#include "llvm/CodeGen/MachineBlockFrequencyInfo.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/RegAllocRegistry.h"
+#include "llvm/CodeGen/VirtRegMap.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetRegisterInfo.h"
+#include <functional>
+#include <queue>
+
+using namespace llvm;
+
+#define DEBUG_TYPE "regalloc"
+
+STATISTIC(NumEvictionSpills, "Number of intervals spilled to free a register");
+STATISTIC(NumSelfSpills, "Number of intervals spilled on visit");
+
+static RegisterRegAlloc
+    linearScanRegAlloc("linearscan", "linear scan register allocator",
+                       createLinearScanRegisterAllocator);
+
+namespace {
+class RALinearScan : public MachineFunctionPass, public RegAllocBase {
+  // context
+  MachineFunction *MF;
+
+  // state
+  std::unique_ptr<Spiller> SpillerInstance;
+  // Intervals are keyed by their start point when enqueued, with ties broken
+  // by register number to keep the allocation deterministic. The key is a
+  // snapshot since the spiller may change the interval while it is queued.
+  typedef std::pair<SlotIndex, unsigned> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry>> Queue;
+
+  // An assigned interval and its physical register. The register is recorded
+  // here because selectOrSplit() returns before the VirtRegMap is updated.
+  typedef std::pair<LiveInterval *, unsigned> Assignment;
+
+  // The start point of the last interval visited in order.
+  SlotIndex ScanPos;
+  // Assigned intervals live at ScanPos.
+  SmallVector<Assignment, 16> Active;
+  // Assigned intervals that start before ScanPos and end after it, but are
+  // not live at ScanPos.
+  SmallVector<Assignment, 16> Inactive;
+  // The number of Active intervals using each register unit.
+  SmallVector<unsigned, 0> ActiveUnits;
+
+  // Scratch space.  Allocated here to avoid repeated malloc calls in
+  // selectOrSplit().
+  BitVector InactiveUnits;
+  SmallVector<LiveInterval *, 8> Intfs;
+  SmallVector<LiveInterval *, 8> BestIntfs;
+
+public:
+  RALinearScan();
+
+  /// Return the pass name.
+  StringRef getPassName() const override {
+    return "Linear Scan Register Allocator";
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override;
+
+  void releaseMemory() override;
+
+  Spiller &spiller() override { return *SpillerInstance; }
+
+  void enqueue(LiveInterval *LI) override {
+    SlotIndex Start = LI->empty() ? LIS->getSlotIndexes()->getZeroIndex()
+                                  : LI->beginIndex();
+    Queue.push(std::make_pair(Start, LI->reg));
+  }
+
+  LiveInterval *dequeue() override {
+    if (Queue.empty())
+      return nullptr;
+    unsigned Reg = Queue.top().second;
+    Queue.pop();
+    return &LIS->getInterval(Reg);
+  }
+
+  unsigned selectOrSplit(LiveInterval &VirtReg,
+                         SmallVectorImpl<unsigned> &SplitVRegs) override;
+
+  /// Perform register allocation.
+  bool runOnMachineFunction(MachineFunction &mf) override;
+
+  MachineFunctionProperties getRequiredProperties() const override {
+    return MachineFunctionProperties().set(
+        MachineFunctionProperties::Property::NoPHIs);
+  }
+
+  static char ID;
+
+private:
+  void aboutToRemoveInterval(LiveInterval &LI) override { forget(LI); }
+
+  /// Move the scan position to Pos, expiring the intervals that end before
+  /// it and moving the others between Active and Inactive.
+  void advanceTo(SlotIndex Pos);
+
+  /// Record that LI is assigned PhysReg, for the intervals visited later.
+  void track(LiveInterval &LI, unsigned PhysReg);
+
+  /// Drop LI from Active or Inactive.
+  void forget(LiveInterval &LI);
+
+  void addActiveUnits(unsigned PhysReg, int Delta);
+
+  /// Return true if no Active interval, and no Inactive interval marked in
+  /// InactiveUnits, uses a unit of PhysReg.
+  bool isFreeInLists(unsigned PhysReg) const;
+
+  /// Collect the Active intervals, and the Inactive intervals overlapping
+  /// VirtReg, that are assigned PhysReg or an alias into Intfs, and return
+  /// their total spill weight. Return false if any of them can't be spilled.
+  bool collectInterferences(LiveInterval &VirtReg, unsigned PhysReg,
+                            float &Weight);
+
+  /// Like collectInterferences(), but query the LiveRegMatrix. This is used
+  /// for intervals that start before the scan position.
+  bool collectMatrixInterferences(LiveInterval &VirtReg, unsigned PhysReg,
+                                  float &Weight);
+
+  /// Spill the intervals in BestIntfs to make room for VirtReg.
+  void spillInterferences(SmallVectorImpl<unsigned> &SplitVRegs);
+};
+
+char RALinearScan::ID = 0;
+
+} // end anonymous namespace
+
+RALinearScan::RALinearScan() : MachineFunctionPass(ID) {
+  initializeLiveDebugVariablesPass(*PassRegistry::getPassRegistry());
+  initializeLiveIntervalsPass(*PassRegistry::getPassRegistry());
+  initializeSlotIndexesPass(*PassRegistry::getPassRegistry());
+  initializeRegisterCoalescerPass(*PassRegistry::getPassRegistry());
+  initializeMachineSchedulerPass(*PassRegistry::getPassRegistry());
+  initializeLiveStacksPass(*PassRegistry::getPassRegistry());
+  initializeMachineDominatorTreePass(*PassRegistry::getPassRegistry());
+  initializeMachineLoopInfoPass(*PassRegistry::getPassRegistry());
+  initializeVirtRegMapPass(*PassRegistry::getPassRegistry());
+  initializeLiveRegMatrixPass(*PassRegistry::getPassRegistry());
+}
+
+void RALinearScan::getAnalysisUsage(AnalysisUsage &AU) const {
+  AU.setPreservesCFG();
+  AU.addRequired<AAResultsWrapperPass>();
+  AU.addPreserved<AAResultsWrapperPass>();
+  AU.addRequired<LiveIntervals>();
+  AU.addPreserved<LiveIntervals>();
+  AU.addPreserved<SlotIndexes>();
+  AU.addRequired<LiveDebugVariables>();
+  AU.addPreserved<LiveDebugVariables>();
+  AU.addRequired<LiveStacks>();
+  AU.addPreserved<LiveStacks>();
+  AU.addRequired<MachineBlockFrequencyInfo>();
+  AU.addPreserved<MachineBlockFrequencyInfo>();
+  AU.addRequiredID(MachineDominatorsID);
+  AU.addPreservedID(MachineDominatorsID);
+  AU.addRequired<MachineLoopInfo>();
+  AU.addPreserved<MachineLoopInfo>();
+  AU.addRequired<VirtRegMap>();
+  AU.addPreserved<VirtRegMap>();
+  AU.addRequired<LiveRegMatrix>();
+  AU.addPreserved<LiveRegMatrix>();
+  MachineFunctionPass::getAnalysisUsage(AU);
+}
+
+void RALinearScan::releaseMemory() {
+  SpillerInstance.reset();
+  Active.clear();
+  Inactive.clear();
+  ActiveUnits.clear();
+}
+
+void RALinearScan::addActiveUnits(unsigned PhysReg, int Delta) {
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units)
+    ActiveUnits[*Units] += Delta;
+}
+
+void RALinearScan::advanceTo(SlotIndex Pos) {
+  assert(ScanPos <= Pos && "The scan can't move backwards");
+  ScanPos = Pos;
+
+  unsigned NumInactive = Inactive.size();
+  unsigned Kept = 0;
+  for (const Assignment &A : Active) {
+    if (A.first->expiredAt(Pos) || !A.first->liveAt(Pos)) {
+      addActiveUnits(A.second, -1);
+      if (!A.first->expiredAt(Pos))
+        Inactive.push_back(A);
+      continue;
+    }
+    Active[Kept++] = A;
+  }
+  Active.resize(Kept);
+
+  // The intervals just moved to Inactive are not live at Pos.
+  Kept = 0;
+  for (unsigned I = 0, E = Inactive.size(); I != E; ++I) {
+    const Assignment A = Inactive[I];
+    if (I < NumInactive) {
+      if (A.first->expiredAt(Pos))
+        continue;
+      if (A.first->liveAt(Pos)) {
+        addActiveUnits(A.second, 1);
+        Active.push_back(A);
+        continue;
+      }
+    }
+    Inactive[Kept++] = A;
+  }
+  Inactive.resize(Kept);
+}
+
+void RALinearScan::track(LiveInterval &LI, unsigned PhysReg) {
+  if (LI.empty() || LI.expiredAt(ScanPos))
+    return;
+  if (LI.liveAt(ScanPos)) {
+    addActiveUnits(PhysReg, 1);
+    Active.push_back(std::make_pair(&LI, PhysReg));
+  } else {
+    Inactive.push_back(std::make_pair(&LI, PhysReg));
+  }
+}
+
+void RALinearScan::forget(LiveInterval &LI) {
+  for (unsigned I = 0, E = Active.size(); I != E; ++I) {
+    if (Active[I].first != &LI)
+      continue;
+    addActiveUnits(Active[I].second, -1);
+    Active.erase(Active.begin() + I);
+    return;
+  }
+  for (unsigned I = 0, E = Inactive.size(); I != E; ++I) {
+    if (Inactive[I].first != &LI)
+      continue;
+    Inactive.erase(Inactive.begin() + I);
+    return;
+  }
+}
+
+bool RALinearScan::isFreeInLists(unsigned PhysReg) const {
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units)
+    if (ActiveUnits[*Units] || InactiveUnits.test(*Units))
+      return false;
+  return true;
+}
+
+bool RALinearScan::collectInterferences(LiveInterval &VirtReg,
+                                        unsigned PhysReg, float &Weight) {
+  Intfs.clear();
+  Weight = 0;
+  // Active intervals are live at the start of VirtReg, so they interfere
+  // whenever their register overlaps PhysReg.
+  for (const Assignment &A : Active) {
+    if (!TRI->regsOverlap(A.second, PhysReg))
+      continue;
+    if (!A.first->isSpillable())
+      return false;
+    Intfs.push_back(A.first);
+    Weight += A.first->weight;
+  }
+  for (const Assignment &A : Inactive) {
+    if (!TRI->regsOverlap(A.second, PhysReg) || !A.first->overlaps(VirtReg))
+      continue;
+    if (!A.first->isSpillable())
+      return false;
+    Intfs.push_back(A.first);
+    Weight += A.first->weight;
+  }
+  return !Intfs.empty();
+}
+
+bool RALinearScan::collectMatrixInterferences(LiveInterval &VirtReg,
+                                              unsigned PhysReg, float &Weight) {
+  Intfs.clear();
+  Weight = 0;
+  for (MCRegUnitIterator Units(PhysReg, TRI); Units.isValid(); ++Units) {
+    LiveIntervalUnion::Query &Q = Matrix->query(VirtReg, *Units);
+    Q.collectInterferingVRegs();
+    if (Q.seenUnspillableVReg())
+      return false;
+    for (LiveInterval *Intf : Q.interferingVRegs()) {
+      if (!Intf->isSpillable())
+        return false;
+      // The same interval may be seen through several register units.
+      if (is_contained(Intfs, Intf))
+        continue;
+      Intfs.push_back(Intf);
+      Weight += Intf->weight;
+    }
+  }
+  return !Intfs.empty();
+}
+
+void RALinearScan::spillInterferences(SmallVectorImpl<unsigned> &SplitVRegs) {
+  for (LiveInterval *Spill : BestIntfs) {
+    // Spilling an earlier interference may have taken care of this one.
+    if (!VRM->hasPhys(Spill->reg))
+      continue;
+    DEBUG(dbgs() << "spilling interference " << *Spill << '\n');
+    forget(*Spill);
+    // A LiveInterval instance may not be in a union during modification!
+    Matrix->unassign(*Spill);
+    LiveRangeEdit LRE(Spill, SplitVRegs, *MF, *LIS, VRM, nullptr, &DeadRemats);
+    spiller().spill(LRE);
+    ++NumEvictionSpills;
+  }
+}
+
+unsigned RALinearScan::selectOrSplit(LiveInterval &VirtReg,
+                                     SmallVectorImpl<unsigned> &SplitVRegs) {
+  // Candidates whose only interference comes from virtual registers.
+  SmallVector<unsigned, 8> PhysRegSpillCands;
+
+  // Intervals that start before the scan position come from spilling an
+  // earlier interval. The lists only describe the intervals live from
+  // ScanPos on, so ask the LiveRegMatrix instead.
+  bool InOrder = !VirtReg.empty() && ScanPos <= VirtReg.beginIndex();
+  if (InOrder) {
+    advanceTo(VirtReg.beginIndex());
+    InactiveUnits.reset();
+    for (const Assignment &A : Inactive)
+      if (A.first->overlaps(VirtReg))
+        for (MCRegUnitIterator Units(A.second, TRI); Units.isValid(); ++Units)
+          InactiveUnits.set(*Units);
+  }
+
+  // Take the first free register. AllocationOrder yields hints first.
+  AllocationOrder Order(VirtReg.reg, *VRM, RegClassInfo, Matrix);
+  while (unsigned PhysReg = Order.next()) {
+    if (InOrder) {
+      if (Matrix->checkRegMaskInterference(VirtReg, PhysReg) ||
+          Matrix->checkRegUnitInterference(VirtReg, PhysReg))
+        continue;
+      if (isFreeInLists(PhysReg)) {
+        track(VirtReg, PhysReg);
+        return PhysReg;
+      }
+      PhysRegSpillCands.push_back(PhysReg);
+      continue;
+    }
+
+    switch (Matrix->checkInterference(VirtReg, PhysReg)) {
+    case LiveRegMatrix::IK_Free:
+      track(VirtReg, PhysReg);
+      return PhysReg;
+    case LiveRegMatrix::IK_VirtReg:
+      PhysRegSpillCands.push_back(PhysReg);
+      continue;
+    default:
+      // RegMask or RegUnit interference.
+      continue;
+    }
+  }
+
+  // No register is free. Find the candidate whose interferences are cheapest
+  // to spill.
+  unsigned BestPhysReg = 0;
+  float BestWeight = 0;
+  for (unsigned PhysReg : PhysRegSpillCands) {
+    float Weight;
+    if (InOrder ? !collectInterferences(VirtReg, PhysReg, Weight)
+                : !collectMatrixInterferences(VirtReg, PhysReg, Weight))
+      continue;
+    if (BestPhysReg && Weight >= BestWeight)
+      continue;
+    BestPhysReg = PhysReg;
+    BestWeight = Weight;
+    BestIntfs = Intfs;
+  }
+
+  // Spill the interferences if that is cheaper than spilling VirtReg itself,
+  // or if VirtReg can't be spilled at all.
+  if (BestPhysReg && (!VirtReg.isSpillable() || BestWeight < VirtReg.weight)) {
+    DEBUG(dbgs() << "freeing " << TRI->getName(BestPhysReg) << " for "
+                 << VirtReg << '\n');
+    spillInterferences(SplitVRegs);
+    assert(!Matrix->checkInterference(VirtReg, BestPhysReg) &&
+           "Interference after spill.");
+    track(VirtReg, BestPhysReg);
+    return BestPhysReg;
+  }
+
+  DEBUG(dbgs() << "spilling: " << VirtReg << '\n');
+  if (!VirtReg.isSpillable())
+    return ~0u;
+  LiveRangeEdit LRE(&VirtReg, SplitVRegs, *MF, *LIS, VRM, nullptr, &DeadRemats);
+  spiller().spill(LRE);
+  ++NumSelfSpills;
+
+  // The live virtual register requesting allocation was spilled, so tell
+  // the caller not to allocate anything during this round.
+  return 0;
+}
+
+bool RALinearScan::runOnMachineFunction(MachineFunction &mf) {
+  DEBUG(dbgs() << "********** LINEAR SCAN REGISTER ALLOCATION **********\n"
+               << "********** Function: " << mf.getName() << '\n');
+
+  MF = &mf;
+  RegAllocBase::init(getAnalysis<VirtRegMap>(),
+                     getAnalysis<LiveIntervals>(),
+                     getAnalysis<LiveRegMatrix>());
+
+  calculateSpillWeightsAndHints(*LIS, *MF, VRM,
+                                getAnalysis<MachineLoopInfo>(),
+                                getAnalysis<MachineBlockFrequencyInfo>());
+
+  ScanPos = LIS->getSlotIndexes()->getZeroIndex();
+  ActiveUnits.assign(TRI->getNumRegUnits(), 0);
+  InactiveUnits.resize(TRI->getNumRegUnits());
+
+  SpillerInstance.reset(createInlineSpiller(*this, *MF, *VRM));
+
+  allocatePhysRegs();
+  postOptimization();
+
+  // Diagnostic output before rewriting
+  DEBUG(dbgs() << "Post alloc VirtRegMap:\n" << *VRM << "\n");
+
+  releaseMemory();
+  return true;
+}
+
+FunctionPass *llvm::createLinearScanRegisterAllocator() {
+  return new RALinearScan();
+}
@@ -959,9 +959,12 @@ SDNode *SelectionDAG::FindNodeOrInsertPos(const FoldingSetNodeID &ID,
 }
 
 void SelectionDAG::clear() {
+  // Deallocating the nodes returns their operand arrays to OperandRecycler.
+  // Keep both it and OperandAllocator so the next DAG can reuse that storage
+  // instead of going back to malloc. CSEMap likewise keeps its buckets, so it
+  // starts out sized for the largest DAG seen so far.
   allnodes_clear();
-  OperandRecycler.clear(OperandAllocator);
-  OperandAllocator.Reset();
+  ShuffleMaskAllocator.Reset();
   CSEMap.clear();
 
   ExtendedValueTypeNodes.clear();
@@ -1606,8 +1609,8 @@ SDValue SelectionDAG::getVectorShuffle(EVT VT, const SDLoc &dl, SDValue N1,
 
   // Allocate the mask array for the node out of the BumpPtrAllocator, since
   // SDNode doesn't have access to it.  This memory will be "leaked" when
-  // the node is deallocated, but recovered when the NodeAllocator is released.
-  int *MaskAlloc = OperandAllocator.Allocate<int>(NElts);
+  // the node is deallocated, but recovered when the DAG is cleared.
+  int *MaskAlloc = ShuffleMaskAllocator.Allocate<int>(NElts);
   std::copy(MaskVec.begin(), MaskVec.end(), MaskAlloc);
 
   auto *N = newSDNode<ShuffleVectorSDNode>(VT, dl.getIROrder(),
@@ -13,6 +13,7 @@
 
 #include "SymbolizableObjectFile.h"
 #include "llvm/Object/COFF.h"
+#include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Object/SymbolSize.h"
 #include "llvm/Support/DataExtractor.h"
 #include "llvm/DebugInfo/DWARF/DWARFContext.h"
@@ -38,18 +39,15 @@ SymbolizableObjectFile::create(object::ObjectFile *Obj,
   // Find the .opd (function descriptor) section if any, for big-endian
   // PowerPC64 ELF.
   if (Obj->getArch() == Triple::ppc64) {
-    for (section_iterator Section : Obj->sections()) {
-      StringRef Name;
-      StringRef Data;
-      if (auto EC = Section->getName(Name))
-        return EC;
-      if (Name == ".opd") {
+    if (auto *ELFObj = dyn_cast<ELFObjectFileBase>(Obj)) {
+      section_iterator Section = ELFObj->findSectionByName(".opd");
+      if (Section != Obj->section_end()) {
+        StringRef Data;
         if (auto EC = Section->getContents(Data))
           return EC;
         OpdExtractor.reset(new DataExtractor(Data, Obj->isLittleEndian(),
                                              Obj->getBytesInAddress()));
         OpdAddress = Section->getAddress();
-        break;
       }
     }
   }
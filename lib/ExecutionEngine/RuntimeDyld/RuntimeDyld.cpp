@@ -525,19 +525,27 @@ unsigned RuntimeDyldImpl::computeSectionStubBufSize(const ObjectFile &Obj,
   if (StubSize == 0) {
     return 0;
   }
-  // FIXME: this is an inefficient way to handle this. We should computed the
-  // necessary section allocation size in loadObject by walking all the sections
-  // once.
   unsigned StubBufSize = 0;
-  for (section_iterator SI = Obj.section_begin(), SE = Obj.section_end();
-       SI != SE; ++SI) {
-    section_iterator RelSecI = SI->getRelocatedSection();
-    if (!(RelSecI == Section))
-      continue;
-
-    for (const RelocationRef &Reloc : SI->relocations())
+  auto CountStubs = [&](const SectionRef &RelSec) {
+    for (const RelocationRef &Reloc : RelSec.relocations())
       if (relocationNeedsStub(Reloc))
         StubBufSize += StubSize;
+  };
+  if (auto *ELFObj = dyn_cast<ELFObjectFileBase>(&Obj)) {
+    // ELF objects keep an index from sections to their relocation sections,
+    // which avoids walking every section for each section we allocate.
+    for (const SectionRef &RelSec : ELFObj->getRelocationSections(Section))
+      CountStubs(RelSec);
+  } else {
+    // FIXME: this is an inefficient way to handle this. We should computed
+    // the necessary section allocation size in loadObject by walking all the
+    // sections once.
+    for (section_iterator SI = Obj.section_begin(), SE = Obj.section_end();
+         SI != SE; ++SI) {
+      section_iterator RelSecI = SI->getRelocatedSection();
+      if (RelSecI == Section)
+        CountStubs(*SI);
+    }
   }
 
   // Get section data size and alignment
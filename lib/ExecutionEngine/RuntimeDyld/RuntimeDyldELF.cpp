@@ -825,21 +825,12 @@ Error RuntimeDyldELF::findOPDEntrySection(const ELFObjectFileBase &Obj,
                                           RelocationValueRef &Rel) {
   // Get the ELF symbol value (st_value) to compare with Relocation offset in
   // .opd entries
-  for (section_iterator si = Obj.section_begin(), se = Obj.section_end();
-       si != se; ++si) {
-    section_iterator RelSecI = si->getRelocatedSection();
-    if (RelSecI == Obj.section_end())
-      continue;
-
-    StringRef RelSectionName;
-    if (auto EC = RelSecI->getName(RelSectionName))
-      return errorCodeToError(EC);
-
-    if (RelSectionName != ".opd")
-      continue;
-
-    for (elf_relocation_iterator i = si->relocation_begin(),
-                                 e = si->relocation_end();
+  // Visit the relocation sections of every section named .opd, in section
+  // table order.
+  for (const SectionRef &RelSec :
+       Obj.getRelocationSectionsFor(Obj.findSectionsByName(".opd"))) {
+    for (elf_relocation_iterator i = RelSec.relocation_begin(),
+                                 e = RelSec.relocation_end();
          i != e;) {
       // The R_PPC64_ADDR64 relocation indicates the first field
       // of a .opd entry
@@ -14,6 +14,7 @@
 
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/raw_ostream.h"
 using namespace llvm;
 
 // Create the combined module index/summary from multiple
@@ -104,3 +105,60 @@ ModuleSummaryIndex::getGlobalValueSummary(uint64_t ValueGUID,
   auto &Summary = SummaryList->second[0];
   return Summary.get();
 }
+
+void ModuleSummaryIndex::printMemoryUsage(raw_ostream &OS) const {
+  // A std::map node carries three links and a color next to its value.
+  const size_t MapNodeOverhead = 4 * sizeof(void *);
+
+  size_t NumFunctions = 0, NumVariables = 0, NumAliases = 0;
+  size_t NumRefs = 0, RefCapacity = 0, NumCalls = 0, CallCapacity = 0;
+  size_t SummaryListBytes = 0;
+  for (auto &GlobalList : GlobalValueMap) {
+    SummaryListBytes += GlobalList.second.capacity() *
+                        sizeof(GlobalValueSummaryList::value_type);
+    for (auto &Summary : GlobalList.second) {
+      NumRefs += Summary->refs().size();
+      RefCapacity += Summary->refs().capacity();
+      if (auto *FS = dyn_cast<FunctionSummary>(Summary.get())) {
+        ++NumFunctions;
+        NumCalls += FS->calls().size();
+        CallCapacity += FS->calls().capacity();
+      } else if (isa<GlobalVarSummary>(Summary.get()))
+        ++NumVariables;
+      else
+        ++NumAliases;
+    }
+  }
+
+  size_t GUIDMapBytes =
+      GlobalValueMap.size() *
+      (MapNodeOverhead + sizeof(GlobalValueSummaryMapTy::value_type));
+  size_t SummaryBytes = NumFunctions * sizeof(FunctionSummary) +
+                        NumVariables * sizeof(GlobalVarSummary) +
+                        NumAliases * sizeof(AliasSummary);
+  size_t RefBytes = RefCapacity * sizeof(ValueInfo);
+  size_t CallBytes = CallCapacity * sizeof(FunctionSummary::EdgeTy);
+  size_t ModulePathBytes =
+      ModulePathStringTable.getNumBuckets() * sizeof(void *) * 2;
+  for (auto &MPI : ModulePathStringTable)
+    ModulePathBytes += sizeof(ModulePathStringTableTy::MapEntryTy) +
+                       MPI.getKeyLength() + 1;
+
+  OS << "Module summary index memory usage:\n";
+  OS << "  GUID map:       " << GUIDMapBytes << " bytes ("
+     << GlobalValueMap.size() << " entries)\n";
+  OS << "  Summary lists:  " << SummaryListBytes << " bytes\n";
+  OS << "  Summaries:      " << SummaryBytes << " bytes (" << NumFunctions
+     << " functions, " << NumVariables << " variables, " << NumAliases
+     << " aliases)\n";
+  OS << "  Reference list: " << RefBytes << " bytes (" << NumRefs << " of "
+     << RefCapacity << " slots used)\n";
+  OS << "  Call edges:     " << CallBytes << " bytes (" << NumCalls << " of "
+     << CallCapacity << " slots used)\n";
+  OS << "  Module paths:   " << ModulePathBytes << " bytes ("
+     << ModulePathStringTable.size() << " modules)\n";
+  OS << "  Total:          "
+     << GUIDMapBytes + SummaryListBytes + SummaryBytes + RefBytes + CallBytes +
+            ModulePathBytes
+     << " bytes\n";
+}
@@ -23,9 +23,11 @@
 #include "llvm/LTO/LTOBackend.h"
 #include "llvm/Linker/IRMover.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
+#include "llvm/Support/FileUtilities.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SHA1.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
@@ -807,6 +809,154 @@ ThinBackend lto::createWriteIndexesThinBackend(std::string OldPrefix,
   };
 }
 
+namespace {
+class OutOfProcessThinBackend : public ThinBackendProc {
+  ThreadPool BackendThreadPool;
+  AddStreamFn AddStream;
+  NativeObjectCache Cache;
+  std::string WorkerPath;
+  std::vector<std::string> WorkerArgs;
+  unsigned MemoryLimitMB;
+
+  Optional<Error> Err;
+  std::mutex ErrMu;
+
+public:
+  OutOfProcessThinBackend(
+      Config &Conf, ModuleSummaryIndex &CombinedIndex,
+      unsigned ThinLTOParallelismLevel,
+      const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+      AddStreamFn AddStream, NativeObjectCache Cache, std::string WorkerPath,
+      std::vector<std::string> WorkerArgs, unsigned MemoryLimitMB)
+      : ThinBackendProc(Conf, CombinedIndex, ModuleToDefinedGVSummaries),
+        BackendThreadPool(ThinLTOParallelismLevel),
+        AddStream(std::move(AddStream)), Cache(std::move(Cache)),
+        WorkerPath(std::move(WorkerPath)), WorkerArgs(std::move(WorkerArgs)),
+        MemoryLimitMB(MemoryLimitMB) {}
+
+  Error runThinLTOBackendProcess(AddStreamFn AddStream, unsigned Task,
+                                 const std::string &ModulePath,
+                                 const std::string &IndexPath) {
+    SmallString<128> ObjectPath;
+    if (std::error_code EC =
+            sys::fs::createTemporaryFile("thinlto", "o", ObjectPath))
+      return errorCodeToError(EC);
+    FileRemover ObjectRemover(ObjectPath);
+
+    std::string IndexArg = "-thinlto-index=" + IndexPath;
+    std::vector<const char *> Args;
+    Args.push_back(WorkerPath.c_str());
+    for (const std::string &Arg : WorkerArgs)
+      Args.push_back(Arg.c_str());
+    Args.push_back(IndexArg.c_str());
+    Args.push_back("-o");
+    Args.push_back(ObjectPath.c_str());
+    Args.push_back(ModulePath.c_str());
+    Args.push_back(nullptr);
+
+    std::string ErrMsg;
+    int Ret = sys::ExecuteAndWait(WorkerPath, Args.data(), nullptr, nullptr, 0,
+                                  MemoryLimitMB, &ErrMsg);
+    if (Ret != 0)
+      return make_error<StringError>(
+          "ThinLTO backend process for " + ModulePath + " failed" +
+              (ErrMsg.empty() ? "" : ": " + ErrMsg),
+          inconvertibleErrorCode());
+
+    ErrorOr<std::unique_ptr<MemoryBuffer>> ObjectOrErr =
+        MemoryBuffer::getFile(ObjectPath);
+    if (!ObjectOrErr)
+      return errorCodeToError(ObjectOrErr.getError());
+    *AddStream(Task)->OS << (*ObjectOrErr)->getBuffer();
+    return Error::success();
+  }
+
+  Error start(
+      unsigned Task, MemoryBufferRef MBRef,
+      const FunctionImporter::ImportMapTy &ImportList,
+      const FunctionImporter::ExportSetTy &ExportList,
+      const std::map<GlobalValue::GUID, GlobalValue::LinkageTypes> &ResolvedODR,
+      MapVector<StringRef, MemoryBufferRef> &ModuleMap) override {
+    StringRef ModulePath = MBRef.getBufferIdentifier();
+    assert(ModuleToDefinedGVSummaries.count(ModulePath));
+    const GVSummaryMapTy &DefinedGlobals =
+        ModuleToDefinedGVSummaries.find(ModulePath)->second;
+
+    // The worker reads the module and everything it imports back from disk,
+    // using the module paths recorded in the index.
+    if (!sys::fs::exists(ModulePath))
+      return make_error<StringError>(
+          "out-of-process ThinLTO backend requires " + ModulePath +
+              " to be on disk",
+          inconvertibleErrorCode());
+
+    AddStreamFn TaskAddStream = AddStream;
+    if (Cache && CombinedIndex.modulePaths().count(ModulePath) &&
+        !all_of(CombinedIndex.getModuleHash(ModulePath),
+                [](uint32_t V) { return V == 0; })) {
+      SmallString<40> Key;
+      computeCacheKey(Key, Conf, CombinedIndex, ModulePath, ImportList,
+                      ExportList, ResolvedODR, DefinedGlobals);
+      TaskAddStream = Cache(Task, Key);
+      if (!TaskAddStream)
+        return Error::success();
+    }
+
+    // Write the individual index for this module before handing the job to
+    // the pool, so the workers never touch the combined index.
+    std::map<std::string, GVSummaryMapTy> ModuleToSummariesForIndex;
+    gatherImportedSummariesForModule(ModulePath, ModuleToDefinedGVSummaries,
+                                     ImportList, ModuleToSummariesForIndex);
+    int IndexFD;
+    SmallString<128> IndexPath;
+    if (std::error_code EC = sys::fs::createTemporaryFile(
+            "thinlto", "thinlto.bc", IndexFD, IndexPath))
+      return errorCodeToError(EC);
+    {
+      raw_fd_ostream OS(IndexFD, /*shouldClose=*/true);
+      WriteIndexToFile(CombinedIndex, OS, &ModuleToSummariesForIndex);
+    }
+
+    BackendThreadPool.async(
+        [=](AddStreamFn AddStream, std::string ModulePath,
+            std::string IndexPath) {
+          FileRemover IndexRemover(IndexPath);
+          Error E = runThinLTOBackendProcess(AddStream, Task, ModulePath,
+                                             IndexPath);
+          if (E) {
+            std::unique_lock<std::mutex> L(ErrMu);
+            if (Err)
+              Err = joinErrors(std::move(*Err), std::move(E));
+            else
+              Err = std::move(E);
+          }
+        },
+        std::move(TaskAddStream), ModulePath.str(), IndexPath.str().str());
+    return Error::success();
+  }
+
+  Error wait() override {
+    BackendThreadPool.wait();
+    if (Err)
+      return std::move(*Err);
+    else
+      return Error::success();
+  }
+};
+} // end anonymous namespace
+
+ThinBackend lto::createOutOfProcessThinBackend(
+    unsigned ParallelismLevel, std::string WorkerPath,
+    std::vector<std::string> WorkerArgs, unsigned MemoryLimitMB) {
+  return [=](Config &Conf, ModuleSummaryIndex &CombinedIndex,
+             const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
+             AddStreamFn AddStream, NativeObjectCache Cache) {
+    return llvm::make_unique<OutOfProcessThinBackend>(
+        Conf, CombinedIndex, ParallelismLevel, ModuleToDefinedGVSummaries,
+        AddStream, Cache, WorkerPath, WorkerArgs, MemoryLimitMB);
+  };
+}
+
 Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
                       bool HasRegularLTO) {
   if (ThinLTO.ModuleMap.empty())
@@ -839,8 +989,11 @@ Error LTO::runThinLTO(AddStreamFn AddStream, NativeObjectCache Cache,
   StringMap<std::map<GlobalValue::GUID, GlobalValue::LinkageTypes>> ResolvedODR;
 
   if (Conf.OptLevel > 0) {
+    unsigned ThinLinkThreads = Conf.ThinLinkThreads
+                                   ? Conf.ThinLinkThreads
+                                   : llvm::heavyweight_hardware_concurrency();
     ComputeCrossModuleImport(ThinLTO.CombinedIndex, ModuleToDefinedGVSummaries,
-                             ImportLists, ExportLists);
+                             ImportLists, ExportLists, ThinLinkThreads);
 
     std::set<GlobalValue::GUID> ExportedGUIDs;
     for (auto &Res : GlobalResolutions) {
@@ -28,12 +28,14 @@
 #include "llvm/MC/MCSymbolELF.h"
 #include "llvm/MC/MCValue.h"
 #include "llvm/MC/StringTableBuilder.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ELF.h"
 #include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/StringSaver.h"
+#include "llvm/Support/ThreadPool.h"
 #include <vector>
 
 using namespace llvm;
@@ -41,6 +43,18 @@ using namespace llvm;
 #undef  DEBUG_TYPE
 #define DEBUG_TYPE "reloc-info"
 
+static cl::opt<unsigned> ELFWriterThreads(
+    "elf-writer-threads", cl::Hidden, cl::init(1),
+    cl::desc("Number of threads used to encode relocation tables and compress "
+             "debug sections when writing ELF objects"));
+
+static cl::opt<unsigned> ELFCompressionChunkSize(
+    "elf-compression-chunk-size", cl::Hidden, cl::init(0),
+    cl::desc("Deflate debug sections larger than this many bytes in chunks "
+             "of this size, so that a large section can be compressed on "
+             "several threads. The output doesn't depend on the number of "
+             "threads. 0 disables chunking"));
+
 namespace {
 typedef DenseMap<const MCSectionELF *, uint32_t> SectionIndexMapTy;
 
@@ -102,6 +116,16 @@ class ELFObjectWriter : public MCObjectWriter {
   llvm::DenseMap<const MCSectionELF *, std::vector<ELFRelocationEntry>>
       Relocations;
 
+  /// Contents of the debug sections that were compressed ahead of time, and
+  /// the result of compressing them.
+  struct CompressedSectionData {
+    SmallVector<char, 0> Uncompressed;
+    SmallVector<char, 0> Compressed;
+    zlib::Status Status;
+  };
+  std::vector<CompressedSectionData> CompressedSections;
+  DenseMap<const MCSection *, unsigned> CompressedSectionIndex;
+
   /// @}
   /// @name Symbol Table Data
   /// @{
@@ -147,6 +171,8 @@ public:
   void reset() override {
     Renames.clear();
     Relocations.clear();
+    CompressedSections.clear();
+    CompressedSectionIndex.clear();
     StrTabBuilder.clear();
     SectionTable.clear();
     MCObjectWriter::reset();
@@ -161,11 +187,13 @@ public:
       write32(W);
   }
 
-  template <typename T> void write(T Val) {
+  template <typename T> void write(T Val) { write(getStream(), Val); }
+
+  template <typename T> void write(raw_ostream &OS, T Val) const {
     if (IsLittleEndian)
-      support::endian::Writer<support::little>(getStream()).write(Val);
+      support::endian::Writer<support::little>(OS).write(Val);
     else
-      support::endian::Writer<support::big>(getStream()).write(Val);
+      support::endian::Writer<support::big>(OS).write(Val);
   }
 
   void writeHeader(const MCAssembler &Asm);
@@ -212,6 +240,16 @@ public:
                           const SectionIndexMapTy &SectionIndexMap,
                           const SectionOffsetsTy &SectionOffsets);
 
+  bool shouldCompress(const MCAssembler &Asm, const MCSectionELF &Sec) const;
+
+  void renderSectionData(const MCAssembler &Asm, MCSection &Sec,
+                         const MCAsmLayout &Layout, SmallVectorImpl<char> &Data);
+
+  /// Compress the contents of all debug sections on a thread pool, ahead of
+  /// writing them out.
+  void compressDebugSections(const MCAssembler &Asm, const MCAsmLayout &Layout,
+                             unsigned Threads);
+
   void writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                         const MCAsmLayout &Layout);
 
@@ -220,7 +258,8 @@ public:
                         uint32_t Link, uint32_t Info, uint64_t Alignment,
                         uint64_t EntrySize);
 
-  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec);
+  void writeRelocations(const MCAssembler &Asm, const MCSectionELF &Sec,
+                        raw_ostream &OS);
 
   bool isSymbolRefDifferenceFullyResolvedImpl(const MCAssembler &Asm,
                                               const MCSymbol &SymA,
@@ -1013,34 +1052,101 @@ bool ELFObjectWriter::maybeWriteCompression(
   return true;
 }
 
+bool ELFObjectWriter::shouldCompress(const MCAssembler &Asm,
+                                     const MCSectionELF &Sec) const {
+  // Compressing debug_frame requires handling alignment fragments which is
+  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
+  // for writing to arbitrary buffers) for little benefit.
+  StringRef SectionName = Sec.getSectionName();
+  return Asm.getContext().getAsmInfo()->compressDebugSections() !=
+             DebugCompressionType::DCT_None &&
+         SectionName.startswith(".debug_") && SectionName != ".debug_frame";
+}
+
+void ELFObjectWriter::renderSectionData(const MCAssembler &Asm, MCSection &Sec,
+                                        const MCAsmLayout &Layout,
+                                        SmallVectorImpl<char> &Data) {
+  raw_svector_ostream VecOS(Data);
+  raw_pwrite_stream &OldStream = getStream();
+  setStream(VecOS);
+  Asm.writeSectionData(&Sec, Layout);
+  setStream(OldStream);
+}
+
+void ELFObjectWriter::compressDebugSections(const MCAssembler &Asm,
+                                            const MCAsmLayout &Layout,
+                                            unsigned Threads) {
+  // Writing the contents goes through this object writer, so it is done
+  // serially. Only the compression itself runs in parallel.
+  for (MCSection &Sec : Asm) {
+    if (!shouldCompress(Asm, static_cast<MCSectionELF &>(Sec)))
+      continue;
+    CompressedSectionIndex[&Sec] = CompressedSections.size();
+    CompressedSections.emplace_back();
+    renderSectionData(Asm, Sec, Layout, CompressedSections.back().Uncompressed);
+  }
+  if (CompressedSections.empty())
+    return;
+
+  // Sections that span several compression chunks are split across all the
+  // threads one at a time. The rest are compressed concurrently with each
+  // other.
+  std::vector<CompressedSectionData *> Small;
+  for (CompressedSectionData &Data : CompressedSections) {
+    if (!ELFCompressionChunkSize ||
+        Data.Uncompressed.size() <= ELFCompressionChunkSize) {
+      Small.push_back(&Data);
+      continue;
+    }
+    Data.Status = zlib::compressParallel(
+        StringRef(Data.Uncompressed.data(), Data.Uncompressed.size()),
+        Data.Compressed, zlib::DefaultCompression, Threads,
+        ELFCompressionChunkSize);
+  }
+  if (Small.empty())
+    return;
+
+  ThreadPool Pool(std::min<size_t>(Threads, Small.size()));
+  for (CompressedSectionData *Data : Small)
+    Pool.async([Data]() {
+      Data->Status = zlib::compress(
+          StringRef(Data->Uncompressed.data(), Data->Uncompressed.size()),
+          Data->Compressed);
+    });
+  Pool.wait();
+}
+
 void ELFObjectWriter::writeSectionData(const MCAssembler &Asm, MCSection &Sec,
                                        const MCAsmLayout &Layout) {
   MCSectionELF &Section = static_cast<MCSectionELF &>(Sec);
   StringRef SectionName = Section.getSectionName();
 
-  // Compressing debug_frame requires handling alignment fragments which is
-  // more work (possibly generalizing MCAssembler.cpp:writeFragment to allow
-  // for writing to arbitrary buffers) for little benefit.
-  bool CompressionEnabled =
-      Asm.getContext().getAsmInfo()->compressDebugSections() !=
-      DebugCompressionType::DCT_None;
-  if (!CompressionEnabled || !SectionName.startswith(".debug_") ||
-      SectionName == ".debug_frame") {
+  if (!shouldCompress(Asm, Section)) {
     Asm.writeSectionData(&Section, Layout);
     return;
   }
 
-  SmallVector<char, 128> UncompressedData;
-  raw_svector_ostream VecOS(UncompressedData);
-  raw_pwrite_stream &OldStream = getStream();
-  setStream(VecOS);
-  Asm.writeSectionData(&Section, Layout);
-  setStream(OldStream);
+  // Use the result of compressDebugSections if it ran.
+  CompressedSectionData LocalData;
+  auto It = CompressedSectionIndex.find(&Sec);
+  CompressedSectionData &Data = It == CompressedSectionIndex.end()
+                                    ? LocalData
+                                    : CompressedSections[It->second];
+  if (&Data == &LocalData) {
+    renderSectionData(Asm, Sec, Layout, Data.Uncompressed);
+    StringRef Uncompressed(Data.Uncompressed.data(), Data.Uncompressed.size());
+    if (ELFCompressionChunkSize)
+      Data.Status = zlib::compressParallel(Uncompressed, Data.Compressed,
+                                           zlib::DefaultCompression,
+                                           /*Threads=*/1,
+                                           ELFCompressionChunkSize);
+    else
+      Data.Status = zlib::compress(Uncompressed, Data.Compressed);
+  }
+  SmallVectorImpl<char> &UncompressedData = Data.Uncompressed;
+  SmallVectorImpl<char> &CompressedContents = Data.Compressed;
+  zlib::Status Success = Data.Status;
 
-  SmallVector<char, 128> CompressedContents;
-  zlib::Status Success = zlib::compress(
-      StringRef(UncompressedData.data(), UncompressedData.size()),
-      CompressedContents);
   if (Success != zlib::StatusOK) {
     getStream() << UncompressedData;
     return;
@@ -1083,7 +1189,8 @@ void ELFObjectWriter::WriteSecHdrEntry(uint32_t Name, uint32_t Type,
 }
 
 void ELFObjectWriter::writeRelocations(const MCAssembler &Asm,
-                                       const MCSectionELF &Sec) {
+                                       const MCSectionELF &Sec,
+                                       raw_ostream &OS) {
   std::vector<ELFRelocationEntry> &Relocs = Relocations[&Sec];
 
   // We record relocations by pushing to the end of a vector. Reverse the vector
@@ -1100,30 +1207,30 @@ void ELFObjectWriter::writeRelocations(const MCAssembler &Asm,
     unsigned Index = Entry.Symbol ? Entry.Symbol->getIndex() : 0;
 
     if (is64Bit()) {
-      write(Entry.Offset);
+      write(OS, Entry.Offset);
       if (TargetObjectWriter->isN64()) {
-        write(uint32_t(Index));
+        write(OS, uint32_t(Index));
 
-        write(TargetObjectWriter->getRSsym(Entry.Type));
-        write(TargetObjectWriter->getRType3(Entry.Type));
-        write(TargetObjectWriter->getRType2(Entry.Type));
-        write(TargetObjectWriter->getRType(Entry.Type));
+        write(OS, TargetObjectWriter->getRSsym(Entry.Type));
+        write(OS, TargetObjectWriter->getRType3(Entry.Type));
+        write(OS, TargetObjectWriter->getRType2(Entry.Type));
+        write(OS, TargetObjectWriter->getRType(Entry.Type));
       } else {
         struct ELF::Elf64_Rela ERE64;
         ERE64.setSymbolAndType(Index, Entry.Type);
-        write(ERE64.r_info);
+        write(OS, ERE64.r_info);
       }
       if (hasRelocationAddend())
-        write(Entry.Addend);
+        write(OS, Entry.Addend);
     } else {
-      write(uint32_t(Entry.Offset));
+      write(OS, uint32_t(Entry.Offset));
 
       struct ELF::Elf32_Rela ERE32;
       ERE32.setSymbolAndType(Index, Entry.Type);
-      write(ERE32.r_info);
+      write(OS, ERE32.r_info);
 
       if (hasRelocationAddend())
-        write(uint32_t(Entry.Addend));
+        write(OS, uint32_t(Entry.Addend));
     }
   }
 }
@@ -1226,6 +1333,10 @@ void ELFObjectWriter::writeObject(MCAssembler &Asm,
 
   std::map<const MCSymbol *, std::vector<const MCSectionELF *>> GroupMembers;
 
+  // Compress the debug sections up front if we have threads to spare.
+  if (ELFWriterThreads > 1)
+    compressDebugSections(Asm, Layout, ELFWriterThreads);
+
   // Write out the ELF header ...
   writeHeader(Asm);
 
@@ -1293,13 +1404,34 @@ void ELFObjectWriter::writeObject(MCAssembler &Asm,
   // Compute symbol table information.
   computeSymbolTable(Asm, Layout, SectionIndexMap, RevGroupMap, SectionOffsets);
 
-  for (MCSectionELF *RelSection : Relocations) {
+  // Now that the symbol indices are known, the relocation tables can be
+  // encoded independently of each other.
+  std::vector<SmallVector<char, 0>> EncodedRelocations;
+  if (ELFWriterThreads > 1 && Relocations.size() > 1) {
+    EncodedRelocations.resize(Relocations.size());
+    // Make sure the lookups below don't modify the map concurrently.
+    for (MCSectionELF *RelSection : Relocations)
+      (void)this->Relocations[RelSection->getAssociatedSection()];
+    ThreadPool Pool(std::min<size_t>(ELFWriterThreads, Relocations.size()));
+    for (unsigned I = 0, E = Relocations.size(); I != E; ++I)
+      Pool.async([&, I]() {
+        raw_svector_ostream OS(EncodedRelocations[I]);
+        writeRelocations(Asm, *Relocations[I]->getAssociatedSection(), OS);
+      });
+    Pool.wait();
+  }
+
+  for (unsigned I = 0, E = Relocations.size(); I != E; ++I) {
+    MCSectionELF *RelSection = Relocations[I];
     align(RelSection->getAlignment());
 
     // Remember the offset into the file for this section.
     uint64_t SecStart = getStream().tell();
 
-    writeRelocations(Asm, *RelSection->getAssociatedSection());
+    if (EncodedRelocations.empty())
+      writeRelocations(Asm, *RelSection->getAssociatedSection(), getStream());
+    else
+      getStream() << EncodedRelocations[I];
 
     uint64_t SecEnd = getStream().tell();
     SectionOffsets[RelSection] = std::make_pair(SecStart, SecEnd);
@@ -54,6 +54,8 @@ STATISTIC(evaluateFixup, "Number of evaluated fixups");
 STATISTIC(FragmentLayouts, "Number of fragment layouts");
 STATISTIC(ObjectBytes, "Number of emitted object file bytes");
 STATISTIC(RelaxationSteps, "Number of assembler layout and relaxation steps");
+STATISTIC(RelaxationFragmentsVisited,
+          "Number of fragments visited during relaxation");
 STATISTIC(RelaxedInstructions, "Number of relaxed instructions");
 }
 }
@@ -648,19 +650,25 @@ void MCAssembler::layout(MCAsmLayout &Layout) {
     Sec.setOrdinal(SectionIndex++);
   }
 
-  // Assign layout order indices to sections and fragments.
+  // Assign layout order indices to sections and fragments, and collect the
+  // fragments that relaxation needs to look at.
+  RelaxationWorklist.assign(Layout.getSectionOrder().size(), {});
   for (unsigned i = 0, e = Layout.getSectionOrder().size(); i != e; ++i) {
     MCSection *Sec = Layout.getSectionOrder()[i];
     Sec->setLayoutOrder(i);
 
     unsigned FragmentIndex = 0;
-    for (MCFragment &Frag : *Sec)
+    for (MCFragment &Frag : *Sec) {
       Frag.setLayoutOrder(FragmentIndex++);
+      if (mayChangeSize(Frag))
+        RelaxationWorklist[i].push_back(&Frag);
+    }
   }
 
   // Layout until everything fits.
   while (layoutOnce(Layout))
     continue;
+  RelaxationWorklist.clear();
 
   DEBUG_WITH_TYPE("mc-dump", {
       llvm::errs() << "assembler backend - post-relaxation\n--\n";
@@ -739,12 +747,9 @@ bool MCAssembler::fixupNeedsRelaxation(const MCFixup &Fixup,
 
 bool MCAssembler::fragmentNeedsRelaxation(const MCRelaxableFragment *F,
                                           const MCAsmLayout &Layout) const {
-  // If this inst doesn't ever need relaxation, ignore it. This occurs when we
-  // are intentionally pushing out inst fragments, or because we relaxed a
-  // previous instruction to one that doesn't need relaxation.
-  if (!getBackend().mayNeedRelaxation(F->getInst()))
-    return false;
-
+  // Fragments whose instruction doesn't ever need relaxation never make it
+  // onto the relaxation worklist, see mayChangeSize. Only the fixups are
+  // checked here, so that the instruction isn't decoded on every iteration.
   for (const MCFixup &Fixup : F->getFixups())
     if (fixupNeedsRelaxation(Fixup, F, Layout))
       return true;
@@ -767,19 +772,13 @@ bool MCAssembler::relaxInstruction(MCAsmLayout &Layout,
   MCInst Relaxed;
   getBackend().relaxInstruction(F.getInst(), F.getSubtargetInfo(), Relaxed);
 
-  // Encode the new instruction.
-  //
-  // FIXME-PERF: If it matters, we could let the target do this. It can
-  // probably do so more efficiently in many cases.
-  SmallVector<MCFixup, 4> Fixups;
-  SmallString<256> Code;
-  raw_svector_ostream VecOS(Code);
-  getEmitter().encodeInstruction(Relaxed, VecOS, Fixups, F.getSubtargetInfo());
-
-  // Update the fragment.
+  // Encode the new instruction directly into the fragment.
   F.setInst(Relaxed);
-  F.getContents() = Code;
-  F.getFixups() = Fixups;
+  F.getContents().clear();
+  F.getFixups().clear();
+  raw_svector_ostream VecOS(F.getContents());
+  getEmitter().encodeInstruction(Relaxed, VecOS, F.getFixups(),
+                                 F.getSubtargetInfo());
 
   return true;
 }
@@ -847,6 +846,24 @@ bool MCAssembler::relaxCVDefRange(MCAsmLayout &Layout,
   return OldSize != F.getContents().size();
 }
 
+bool MCAssembler::mayChangeSize(const MCFragment &F) const {
+  switch (F.getKind()) {
+  default:
+    return false;
+  case MCFragment::FT_Relaxable:
+    // Once an instruction has been relaxed to a form that never needs
+    // relaxation, its fragment is final.
+    return getBackend().mayNeedRelaxation(
+        cast<MCRelaxableFragment>(F).getInst());
+  case MCFragment::FT_Dwarf:
+  case MCFragment::FT_DwarfFrame:
+  case MCFragment::FT_LEB:
+  case MCFragment::FT_CVInlineLines:
+  case MCFragment::FT_CVDefRange:
+    return true;
+  }
+}
+
 bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   // Holds the first fragment which needed relaxing during this layout. It will
   // remain NULL if none were relaxed.
@@ -854,41 +871,49 @@ bool MCAssembler::layoutSectionOnce(MCAsmLayout &Layout, MCSection &Sec) {
   // invalidated because their offset is going to change.
   MCFragment *FirstRelaxedFragment = nullptr;
 
-  // Attempt to relax all the fragments in the section.
-  for (MCSection::iterator I = Sec.begin(), IE = Sec.end(); I != IE; ++I) {
+  // Attempt to relax the fragments on the worklist, which is in layout order.
+  // Fragments that became final are dropped from it as we go.
+  std::vector<MCFragment *> &Worklist =
+      RelaxationWorklist[Sec.getLayoutOrder()];
+  unsigned NumKept = 0;
+  for (MCFragment *F : Worklist) {
+    ++stats::RelaxationFragmentsVisited;
     // Check if this is a fragment that needs relaxation.
     bool RelaxedFrag = false;
-    switch(I->getKind()) {
+    switch(F->getKind()) {
     default:
       break;
     case MCFragment::FT_Relaxable:
       assert(!getRelaxAll() &&
              "Did not expect a MCRelaxableFragment in RelaxAll mode");
-      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(I));
+      RelaxedFrag = relaxInstruction(Layout, *cast<MCRelaxableFragment>(F));
       break;
     case MCFragment::FT_Dwarf:
       RelaxedFrag = relaxDwarfLineAddr(Layout,
-                                       *cast<MCDwarfLineAddrFragment>(I));
+                                       *cast<MCDwarfLineAddrFragment>(F));
       break;
     case MCFragment::FT_DwarfFrame:
       RelaxedFrag =
         relaxDwarfCallFrameFragment(Layout,
-                                    *cast<MCDwarfCallFrameFragment>(I));
+                                    *cast<MCDwarfCallFrameFragment>(F));
       break;
     case MCFragment::FT_LEB:
-      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(I));
+      RelaxedFrag = relaxLEB(Layout, *cast<MCLEBFragment>(F));
       break;
     case MCFragment::FT_CVInlineLines:
       RelaxedFrag =
-          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(I));
+          relaxCVInlineLineTable(Layout, *cast<MCCVInlineLineTableFragment>(F));
       break;
     case MCFragment::FT_CVDefRange:
-      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(I));
+      RelaxedFrag = relaxCVDefRange(Layout, *cast<MCCVDefRangeFragment>(F));
       break;
     }
     if (RelaxedFrag && !FirstRelaxedFragment)
-      FirstRelaxedFragment = &*I;
+      FirstRelaxedFragment = F;
+    if (!RelaxedFrag || mayChangeSize(*F))
+      Worklist[NumKept++] = F;
   }
+  Worklist.resize(NumKept);
   if (FirstRelaxedFragment) {
     Layout.invalidateFragmentsFrom(FirstRelaxedFragment);
     return true;
@@ -274,11 +274,9 @@ void MCObjectStreamer::EmitInstToFragment(const MCInst &Inst,
   MCRelaxableFragment *IF = new MCRelaxableFragment(Inst, STI);
   insert(IF);
 
-  SmallString<128> Code;
-  raw_svector_ostream VecOS(Code);
+  raw_svector_ostream VecOS(IF->getContents());
   getAssembler().getEmitter().encodeInstruction(Inst, VecOS, IF->getFixups(),
                                                 STI);
-  IF->getContents().append(Code.begin(), Code.end());
 }
 
 #ifndef NDEBUG
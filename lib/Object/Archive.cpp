@@ -954,20 +954,47 @@ uint32_t Archive::getNumberOfSymbols() const {
   return read32le(buf);
 }
 
+void Archive::buildSymbolMap() const {
+  SymbolMap.reserve(getNumberOfSymbols());
+  for (Archive::symbol_iterator bs = symbol_begin(), es = symbol_end();
+       bs != es; ++bs)
+    // Keep the first definition, as a linear search would find it.
+    SymbolMap.insert(std::make_pair(
+        bs->getName(), std::make_pair(bs->SymbolIndex, bs->StringIndex)));
+}
+
 Expected<Optional<Archive::Child>> Archive::findSym(StringRef name) const {
-  Archive::symbol_iterator bs = symbol_begin();
-  Archive::symbol_iterator es = symbol_end();
-
-  for (; bs != es; ++bs) {
-    StringRef SymName = bs->getName();
-    if (SymName == name) {
-      if (auto MemberOrErr = bs->getMember())
-        return Child(*MemberOrErr);
-      else
-        return MemberOrErr.takeError();
+  if (!hasSymbolTable())
+    return Optional<Child>();
+  if (!SymbolMapBuilt.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> Lock(SymbolMapLock);
+    if (!SymbolMapBuilt.load(std::memory_order_relaxed)) {
+      buildSymbolMap();
+      SymbolMapBuilt.store(true, std::memory_order_release);
     }
   }
-  return Optional<Child>();
+
+  auto It = SymbolMap.find(name);
+  if (It == SymbolMap.end())
+    return Optional<Child>();
+  Symbol Sym(this, It->second.first, It->second.second);
+  if (auto MemberOrErr = Sym.getMember())
+    return Child(*MemberOrErr);
+  else
+    return MemberOrErr.takeError();
+}
+
+Expected<std::vector<Optional<Archive::Child>>>
+Archive::findSyms(ArrayRef<StringRef> Names) const {
+  std::vector<Optional<Child>> Members;
+  Members.reserve(Names.size());
+  for (StringRef Name : Names) {
+    Expected<Optional<Child>> MemberOrErr = findSym(Name);
+    if (!MemberOrErr)
+      return MemberOrErr.takeError();
+    Members.push_back(std::move(*MemberOrErr));
+  }
+  return std::move(Members);
 }
 
 // Returns true if archive file contains no member file.
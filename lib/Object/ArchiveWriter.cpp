@@ -13,6 +13,7 @@
 
 #include "llvm/Object/ArchiveWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/Object/Archive.h"
@@ -23,6 +24,7 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/Format.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -261,27 +263,183 @@ static sys::TimePoint<std::chrono::seconds> now(bool Deterministic) {
   return sys::TimePoint<seconds>();
 }
 
+namespace {
+// The symbols a member contributes to the archive symbol table.
+struct MemberSymbols {
+  // Whether the member is an object file. The symbol table is only written
+  // if at least one member is.
+  bool IsObject = false;
+  // The names of the symbols, each followed by a NUL, and where each starts.
+  SmallString<0> Names;
+  std::vector<unsigned> NameOffsets;
+  std::error_code EC;
+
+  void addName(StringRef Name) {
+    NameOffsets.push_back(Names.size());
+    Names += Name;
+    Names.push_back('\0');
+  }
+};
+}
+
+static void computeMemberSymbols(MemoryBufferRef MemberBuffer,
+                                 LLVMContext &Context, MemberSymbols &Syms) {
+  Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
+      object::SymbolicFile::createSymbolicFile(
+          MemberBuffer, sys::fs::file_magic::unknown, &Context);
+  if (!ObjOrErr) {
+    // FIXME: check only for "not an object file" errors.
+    consumeError(ObjOrErr.takeError());
+    return;
+  }
+  object::SymbolicFile &Obj = *ObjOrErr.get();
+  Syms.IsObject = true;
+
+  raw_svector_ostream NameOS(Syms.Names);
+  for (const object::BasicSymbolRef &S : Obj.symbols()) {
+    uint32_t Symflags = S.getFlags();
+    if (Symflags & object::SymbolRef::SF_FormatSpecific)
+      continue;
+    if (!(Symflags & object::SymbolRef::SF_Global))
+      continue;
+    if (Symflags & object::SymbolRef::SF_Undefined)
+      continue;
+
+    Syms.NameOffsets.push_back(Syms.Names.size());
+    if (auto EC = S.printName(NameOS)) {
+      Syms.EC = EC;
+      return;
+    }
+    NameOS << '\0';
+  }
+}
+
+// Returns true if the symbol table of Archive is sorted by name, like the
+// "__.SYMDEF SORTED" tables written by cctools ranlib.
+static bool hasSortedSymbolTable(const object::Archive &Archive) {
+  Error Err = Error::success();
+  object::Archive::child_iterator I =
+      Archive.child_begin(Err, /*SkipInternal=*/false);
+  if (Err) {
+    consumeError(std::move(Err));
+    return false;
+  }
+  if (I == Archive.child_end())
+    return false;
+  Expected<StringRef> NameOrErr = I->getName();
+  if (!NameOrErr) {
+    consumeError(NameOrErr.takeError());
+    return false;
+  }
+  return NameOrErr->endswith(" SORTED");
+}
+
+// Collect the symbols of each member of an existing archive from its symbol
+// table, keyed by the start of the member's data.
+//
+// This is only done if the table lists the members in archive order. A table
+// that doesn't, such as one sorted by name, may not list the symbols of a
+// member in the order computeMemberSymbols would, so the new table would not
+// match one built from scratch.
+static DenseMap<const char *, MemberSymbols>
+readOldSymbols(MemoryBufferRef OldArchiveBuf) {
+  DenseMap<const char *, MemberSymbols> OldSymbols;
+  Expected<std::unique_ptr<object::Archive>> ArchiveOrErr =
+      object::Archive::create(OldArchiveBuf);
+  if (!ArchiveOrErr) {
+    consumeError(ArchiveOrErr.takeError());
+    return OldSymbols;
+  }
+  object::Archive &OldArchive = **ArchiveOrErr;
+  // The members of a thin archive are read from separate files, so they
+  // can't be matched up by address.
+  if (OldArchive.isThin() || hasSortedSymbolTable(OldArchive))
+    return OldSymbols;
+
+  const char *PrevMember = nullptr;
+  for (const object::Archive::Symbol &S : OldArchive.symbols()) {
+    Expected<object::Archive::Child> ChildOrErr = S.getMember();
+    if (!ChildOrErr) {
+      consumeError(ChildOrErr.takeError());
+      return DenseMap<const char *, MemberSymbols>();
+    }
+    Expected<StringRef> BufOrErr = ChildOrErr->getBuffer();
+    if (!BufOrErr) {
+      consumeError(BufOrErr.takeError());
+      return DenseMap<const char *, MemberSymbols>();
+    }
+    const char *Member = BufOrErr->data();
+    if (Member < PrevMember)
+      return DenseMap<const char *, MemberSymbols>();
+    PrevMember = Member;
+    MemberSymbols &Syms = OldSymbols[Member];
+    Syms.IsObject = true;
+    Syms.addName(S.getName());
+  }
+  return OldSymbols;
+}
+
+// Compute the symbols of every member. The symbols of members that were
+// copied unchanged from the old archive are taken from its symbol table, and
+// the remaining members are parsed on up to Threads threads.
+static std::vector<MemberSymbols>
+computeSymbols(ArrayRef<NewArchiveMember> Members,
+               const MemoryBuffer *OldArchiveBuf, unsigned Threads) {
+  std::vector<MemberSymbols> Symbols(Members.size());
+  std::vector<unsigned> ToCompute;
+  DenseMap<const char *, MemberSymbols> OldSymbols;
+  if (OldArchiveBuf)
+    OldSymbols = readOldSymbols(OldArchiveBuf->getMemBufferRef());
+  for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N; ++MemberNum) {
+    const NewArchiveMember &M = Members[MemberNum];
+    auto It = M.IsNew ? OldSymbols.end()
+                      : OldSymbols.find(M.Buf->getBufferStart());
+    if (It != OldSymbols.end())
+      Symbols[MemberNum] = std::move(It->second);
+    else
+      ToCompute.push_back(MemberNum);
+  }
+
+  unsigned NumThreads = std::min<size_t>(Threads, ToCompute.size());
+  if (NumThreads <= 1) {
+    LLVMContext Context;
+    for (unsigned MemberNum : ToCompute)
+      computeMemberSymbols(Members[MemberNum].Buf->getMemBufferRef(), Context,
+                           Symbols[MemberNum]);
+    return Symbols;
+  }
+
+  // An LLVMContext can't be shared between threads, so give each task a
+  // chunk of members and a context of its own.
+  ThreadPool Pool(NumThreads);
+  size_t ChunkSize = (ToCompute.size() + NumThreads * 4 - 1) / (NumThreads * 4);
+  for (size_t Begin = 0; Begin < ToCompute.size(); Begin += ChunkSize) {
+    size_t End = std::min(Begin + ChunkSize, ToCompute.size());
+    Pool.async([&, Begin, End]() {
+      LLVMContext Context;
+      for (size_t I = Begin; I != End; ++I)
+        computeMemberSymbols(Members[ToCompute[I]].Buf->getMemBufferRef(),
+                             Context, Symbols[ToCompute[I]]);
+    });
+  }
+  Pool.wait();
+  return Symbols;
+}
+
 // Returns the offset of the first reference to a member offset.
 static ErrorOr<unsigned>
 writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
-                 ArrayRef<NewArchiveMember> Members,
+                 ArrayRef<MemberSymbols> Symbols,
                  std::vector<unsigned> &MemberOffsetRefs, bool Deterministic) {
   unsigned HeaderStartOffset = 0;
   unsigned BodyStartOffset = 0;
   SmallString<128> NameBuf;
-  raw_svector_ostream NameOS(NameBuf);
-  LLVMContext Context;
-  for (unsigned MemberNum = 0, N = Members.size(); MemberNum < N; ++MemberNum) {
-    MemoryBufferRef MemberBuffer = Members[MemberNum].Buf->getMemBufferRef();
-    Expected<std::unique_ptr<object::SymbolicFile>> ObjOrErr =
-        object::SymbolicFile::createSymbolicFile(
-            MemberBuffer, sys::fs::file_magic::unknown, &Context);
-    if (!ObjOrErr) {
-      // FIXME: check only for "not an object file" errors.
-      consumeError(ObjOrErr.takeError());
+  for (unsigned MemberNum = 0, N = Symbols.size(); MemberNum < N; ++MemberNum) {
+    const MemberSymbols &Syms = Symbols[MemberNum];
+    if (Syms.EC)
+      return Syms.EC;
+    if (!Syms.IsObject)
       continue;
-    }
-    object::SymbolicFile &Obj = *ObjOrErr.get();
 
     if (!HeaderStartOffset) {
       HeaderStartOffset = Out.tell();
@@ -293,22 +451,12 @@ writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
       print32(Out, Kind, 0); // number of entries or bytes
     }
 
-    for (const object::BasicSymbolRef &S : Obj.symbols()) {
-      uint32_t Symflags = S.getFlags();
-      if (Symflags & object::SymbolRef::SF_FormatSpecific)
-        continue;
-      if (!(Symflags & object::SymbolRef::SF_Global))
-        continue;
-      if (Symflags & object::SymbolRef::SF_Undefined)
-        continue;
-
-      unsigned NameOffset = NameOS.tell();
-      if (auto EC = S.printName(NameOS))
-        return EC;
-      NameOS << '\0';
+    unsigned NameBase = NameBuf.size();
+    NameBuf += Syms.Names;
+    for (unsigned NameOffset : Syms.NameOffsets) {
       MemberOffsetRefs.push_back(MemberNum);
       if (Kind == object::Archive::K_BSD)
-        print32(Out, Kind, NameOffset);
+        print32(Out, Kind, NameBase + NameOffset);
       print32(Out, Kind, 0); // member offset
     }
   }
@@ -316,7 +464,7 @@ writeSymbolTable(raw_fd_ostream &Out, object::Archive::Kind Kind,
   if (HeaderStartOffset == 0)
     return 0;
 
-  StringRef StringTable = NameOS.str();
+  StringRef StringTable = NameBuf.str();
   if (Kind == object::Archive::K_BSD)
     print32(Out, Kind, StringTable.size()); // byte count of the string table
   Out << StringTable;
@@ -350,7 +498,8 @@ llvm::writeArchive(StringRef ArcName,
                    std::vector<NewArchiveMember> &NewMembers,
                    bool WriteSymtab, object::Archive::Kind Kind,
                    bool Deterministic, bool Thin,
-                   std::unique_ptr<MemoryBuffer> OldArchiveBuf) {
+                   std::unique_ptr<MemoryBuffer> OldArchiveBuf,
+                   unsigned Threads) {
   assert((!Thin || Kind == object::Archive::K_GNU) &&
          "Only the gnu format has a thin mode");
   SmallString<128> TmpArchive;
@@ -374,8 +523,10 @@ llvm::writeArchive(StringRef ArcName,
 
   unsigned MemberReferenceOffset = 0;
   if (WriteSymtab) {
+    std::vector<MemberSymbols> Symbols =
+        computeSymbols(NewMembers, OldArchiveBuf.get(), Threads);
     ErrorOr<unsigned> MemberReferenceOffsetOrErr = writeSymbolTable(
-        Out, Kind, NewMembers, MemberOffsetRefs, Deterministic);
+        Out, Kind, Symbols, MemberOffsetRefs, Deterministic);
     if (auto EC = MemberReferenceOffsetOrErr.getError())
       return std::make_pair(ArcName, EC);
     MemberReferenceOffset = MemberReferenceOffsetOrErr.get();
@@ -13,6 +13,7 @@
 
 #include "llvm/Object/ELFObjectFile.h"
 #include "llvm/Support/MathExtras.h"
+#include <algorithm>
 
 namespace llvm {
 using namespace object;
@@ -55,6 +56,24 @@ ObjectFile::createELFObjectFile(MemoryBufferRef Obj) {
   return std::move(R);
 }
 
+SmallVector<SectionRef, 2>
+ELFObjectFileBase::getRelocationSectionsFor(ArrayRef<SectionRef> Secs) const {
+  SmallVector<SectionRef, 2> RelSecs;
+  for (const SectionRef &Sec : Secs) {
+    ArrayRef<SectionRef> SecRelSecs = getRelocationSections(Sec);
+    RelSecs.append(SecRelSecs.begin(), SecRelSecs.end());
+  }
+  // An ELF section reference holds a pointer into the section header table.
+  // Compare those pointers as pointers: SectionRef::operator< compares their
+  // bytes, which is not table order on little-endian hosts.
+  if (Secs.size() > 1)
+    std::sort(RelSecs.begin(), RelSecs.end(),
+              [](const SectionRef &A, const SectionRef &B) {
+                return A.getRawDataRefImpl().p < B.getRawDataRefImpl().p;
+              });
+  return RelSecs;
+}
+
 SubtargetFeatures ELFObjectFileBase::getFeatures() const {
   switch (getEMachine()) {
   case ELF::EM_MIPS: {
@@ -175,10 +175,18 @@ Expected<int64_t> CounterMappingContext::evaluate(const Counter &C) const {
   llvm_unreachable("Unhandled CounterKind");
 }
 
+void FunctionRecordIterator::advance() {
+  if (!UseIndices) {
+    ++Current;
+    return;
+  }
+  Current = NextIndex == EndIndex ? Records.end() : &Records[*NextIndex++];
+}
+
 void FunctionRecordIterator::skipOtherFiles() {
   while (Current != Records.end() && !Filename.empty() &&
          Filename != Current->Filenames[0])
-    ++Current;
+    advance();
   if (Current == Records.end())
     *this = FunctionRecordIterator();
 }
@@ -227,10 +235,24 @@ Error CoverageMapping::loadFunctionRecord(
     return Error::success();
   }
 
+  unsigned Index = Functions.size();
+  for (const std::string &Filename : Function.Filenames) {
+    std::vector<unsigned> &Indices = FileFunctions[Filename];
+    if (Indices.empty() || Indices.back() != Index)
+      Indices.push_back(Index);
+  }
   Functions.push_back(std::move(Function));
   return Error::success();
 }
 
+ArrayRef<unsigned>
+CoverageMapping::getFunctionIndices(StringRef Filename) const {
+  auto I = FileFunctions.find(Filename);
+  if (I == FileFunctions.end())
+    return None;
+  return I->second;
+}
+
 Expected<std::unique_ptr<CoverageMapping>>
 CoverageMapping::load(CoverageMappingReader &CoverageReader,
                       IndexedInstrProfReader &ProfileReader) {
@@ -489,7 +511,8 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
   CoverageData FileCoverage(Filename);
   std::vector<coverage::CountedRegion> Regions;
 
-  for (const auto &Function : Functions) {
+  for (unsigned Index : getFunctionIndices(Filename)) {
+    const FunctionRecord &Function = Functions[Index];
     auto MainFileID = findMainViewFileID(Filename, Function);
     auto FileIDs = gatherFileIDs(Filename, Function);
     for (const auto &CR : Function.CountedRegions)
@@ -509,7 +532,8 @@ CoverageData CoverageMapping::getCoverageForFile(StringRef Filename) const {
 std::vector<const FunctionRecord *>
 CoverageMapping::getInstantiations(StringRef Filename) const {
   FunctionInstantiationSetCollector InstantiationSetCollector;
-  for (const auto &Function : Functions) {
+  for (unsigned Index : getFunctionIndices(Filename)) {
+    const FunctionRecord &Function = Functions[Index];
     auto MainFileID = findMainViewFileID(Filename, Function);
     if (!MainFileID)
       continue;
@@ -526,6 +526,74 @@ data_type InstrProfLookupTrait::ReadData(StringRef K, const unsigned char *D,
   return DataBuffer;
 }
 
+Error InstrProfRecordView::materialize(InstrProfRecord &Record) const {
+  Record = InstrProfRecord(Name, Hash,
+                           std::vector<uint64_t>(Counts.begin(), Counts.end()));
+  if (ValueData.empty())
+    return Error::success();
+
+  Expected<std::unique_ptr<ValueProfData>> VDataPtrOrErr =
+      ValueProfData::getValueProfData(ValueData.begin(), ValueData.end(),
+                                      ValueDataEndianness);
+  if (Error E = VDataPtrOrErr.takeError())
+    return E;
+  VDataPtrOrErr.get()->deserializeTo(Record, nullptr);
+  return Error::success();
+}
+
+Error InstrProfLookupTrait::findRecordView(StringRef K, const unsigned char *D,
+                                           offset_type N, uint64_t Hash,
+                                           InstrProfRecordView &View) const {
+  // This walks the same layout as ReadData, but only looks at the sizes of
+  // the records that don't match.
+  if (N % sizeof(uint64_t))
+    return make_error<InstrProfError>(instrprof_error::malformed);
+
+  using namespace support;
+  const unsigned char *End = D + N;
+  while (D < End) {
+    if (D + sizeof(uint64_t) >= End)
+      return make_error<InstrProfError>(instrprof_error::malformed);
+    uint64_t RecordHash = endian::readNext<uint64_t, little, unaligned>(D);
+
+    uint64_t CountsSize = N / sizeof(uint64_t) - 1;
+    if (GET_VERSION(FormatVersion) != IndexedInstrProf::ProfVersion::Version1) {
+      if (D + sizeof(uint64_t) > End)
+        return make_error<InstrProfError>(instrprof_error::malformed);
+      CountsSize = endian::readNext<uint64_t, little, unaligned>(D);
+    }
+    if (CountsSize > uint64_t(End - D) / sizeof(uint64_t))
+      return make_error<InstrProfError>(instrprof_error::malformed);
+    const unsigned char *Counts = D;
+    D += CountsSize * sizeof(uint64_t);
+
+    // The value profile data starts with its total size.
+    const unsigned char *ValueData = D;
+    if (GET_VERSION(FormatVersion) > IndexedInstrProf::ProfVersion::Version2) {
+      if (D + sizeof(ValueProfData) > End)
+        return make_error<InstrProfError>(instrprof_error::malformed);
+      uint32_t TotalSize =
+          ValueProfDataEndianness == little
+              ? endian::read<uint32_t, little, unaligned>(D)
+              : endian::read<uint32_t, big, unaligned>(D);
+      if (TotalSize < sizeof(ValueProfData) || TotalSize > uint64_t(End - D))
+        return make_error<InstrProfError>(instrprof_error::malformed);
+      D += TotalSize;
+    }
+
+    if (RecordHash == Hash) {
+      View.Name = K;
+      View.Hash = RecordHash;
+      View.Counts = makeArrayRef(
+          reinterpret_cast<const ulittle64_t *>(Counts), CountsSize);
+      View.ValueData = makeArrayRef(ValueData, D);
+      View.ValueDataEndianness = ValueProfDataEndianness;
+      return Error::success();
+    }
+  }
+  return make_error<InstrProfError>(instrprof_error::hash_mismatch);
+}
+
 template <typename HashTableImpl>
 Error InstrProfReaderIndex<HashTableImpl>::getRecords(
     StringRef FuncName, ArrayRef<InstrProfRecord> &Data) {
@@ -554,6 +622,21 @@ Error InstrProfReaderIndex<HashTableImpl>::getRecords(
   return Error::success();
 }
 
+template <typename HashTableImpl>
+Error InstrProfReaderIndex<HashTableImpl>::getRecordView(
+    StringRef FuncName, uint64_t FuncHash, InstrProfRecordView &View) {
+  auto Iter = HashTable->find(FuncName);
+  if (Iter == HashTable->end())
+    return make_error<InstrProfError>(instrprof_error::unknown_function);
+
+  // The key is stored right before the data, so the view can refer to the
+  // name in the profile rather than to the caller's string.
+  const unsigned char *Data = Iter.getDataPtr();
+  StringRef Key((const char *)Data - FuncName.size(), FuncName.size());
+  return HashTable->getInfoObj().findRecordView(Key, Data, Iter.getDataLen(),
+                                                FuncHash, View);
+}
+
 template <typename HashTableImpl>
 InstrProfReaderIndex<HashTableImpl>::InstrProfReaderIndex(
     const unsigned char *Buckets, const unsigned char *const Payload,
@@ -680,28 +763,29 @@ InstrProfSymtab &IndexedInstrProfReader::getSymtab() {
 Expected<InstrProfRecord>
 IndexedInstrProfReader::getInstrProfRecord(StringRef FuncName,
                                            uint64_t FuncHash) {
-  ArrayRef<InstrProfRecord> Data;
-  Error Err = Index->getRecords(FuncName, Data);
-  if (Err)
-    return std::move(Err);
-  // Found it. Look for counters with the right hash.
-  for (unsigned I = 0, E = Data.size(); I < E; ++I) {
-    // Check for a match and fill the vector if there is one.
-    if (Data[I].Hash == FuncHash) {
-      return std::move(Data[I]);
-    }
-  }
-  return error(instrprof_error::hash_mismatch);
+  // Only the value profile data of the matching record is decoded.
+  InstrProfRecordView View;
+  if (Error E = getInstrProfRecordView(FuncName, FuncHash, View))
+    return std::move(E);
+  InstrProfRecord Record;
+  if (Error E = View.materialize(Record))
+    return error(std::move(E));
+  return std::move(Record);
+}
+
+Error IndexedInstrProfReader::getInstrProfRecordView(
+    StringRef FuncName, uint64_t FuncHash, InstrProfRecordView &View) {
+  return error(Index->getRecordView(FuncName, FuncHash, View));
 }
 
 Error IndexedInstrProfReader::getFunctionCounts(StringRef FuncName,
                                                 uint64_t FuncHash,
                                                 std::vector<uint64_t> &Counts) {
-  Expected<InstrProfRecord> Record = getInstrProfRecord(FuncName, FuncHash);
-  if (Error E = Record.takeError())
-    return error(std::move(E));
+  InstrProfRecordView View;
+  if (Error E = getInstrProfRecordView(FuncName, FuncHash, View))
+    return E;
 
-  Counts = Record.get().Counts;
+  Counts.assign(View.Counts.begin(), View.Counts.end());
   return success();
 }
 
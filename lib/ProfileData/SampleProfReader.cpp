@@ -23,10 +23,13 @@
 #include "llvm/ProfileData/SampleProfReader.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Endian.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 
 using namespace llvm::sampleprof;
@@ -362,29 +365,63 @@ SampleProfileReaderBinary::readProfile(FunctionSamples &FProfile) {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderBinary::readFuncProfile() {
+  auto NumHeadSamples = readNumber<uint64_t>();
+  if (std::error_code EC = NumHeadSamples.getError())
+    return EC;
+
+  auto FName(readStringFromTable());
+  if (std::error_code EC = FName.getError())
+    return EC;
+
+  Profiles[*FName] = FunctionSamples();
+  FunctionSamples &FProfile = Profiles[*FName];
+  FProfile.setName(*FName);
+
+  FProfile.addHeadSamples(*NumHeadSamples);
+
+  return readProfile(FProfile);
+}
+
 std::error_code SampleProfileReaderBinary::read() {
   while (!at_eof()) {
-    auto NumHeadSamples = readNumber<uint64_t>();
-    if (std::error_code EC = NumHeadSamples.getError())
-      return EC;
-
-    auto FName(readStringFromTable());
-    if (std::error_code EC = FName.getError())
+    if (std::error_code EC = readFuncProfile())
       return EC;
+  }
 
-    Profiles[*FName] = FunctionSamples();
-    FunctionSamples &FProfile = Profiles[*FName];
-    FProfile.setName(*FName);
+  return sampleprof_error::success;
+}
 
-    FProfile.addHeadSamples(*NumHeadSamples);
+std::error_code SampleProfileReaderCompactBinary::read() {
+  if (UseAllFuncs)
+    return SampleProfileReaderBinary::read();
 
-    if (std::error_code EC = readProfile(FProfile))
+  const uint8_t *Start =
+      reinterpret_cast<const uint8_t *>(Buffer->getBufferStart());
+  for (const std::string &Name : FuncsToUse) {
+    auto It = FuncOffsetTable.find(Name);
+    if (It == FuncOffsetTable.end())
+      continue;
+    Data = Start + It->second;
+    if (std::error_code EC = readFuncProfile())
       return EC;
   }
 
   return sampleprof_error::success;
 }
 
+void SampleProfileReaderCompactBinary::collectFuncsToUse(const Module &M) {
+  UseAllFuncs = false;
+  FuncsToUse.clear();
+  for (const Function &F : M)
+    if (!F.isDeclaration())
+      FuncsToUse.push_back(getMD5Name(F.getName()));
+}
+
+std::string SampleProfileReaderCompactBinary::getMD5Name(StringRef Name) {
+  return std::to_string(MD5Hash(Name));
+}
+
 std::error_code SampleProfileReaderBinary::readHeader() {
   Data = reinterpret_cast<const uint8_t *>(Buffer->getBufferStart());
   End = Data + Buffer->getBufferSize();
@@ -393,8 +430,8 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   auto Magic = readNumber<uint64_t>();
   if (std::error_code EC = Magic.getError())
     return EC;
-  else if (*Magic != SPMagic())
-    return sampleprof_error::bad_magic;
+  else if (std::error_code EC = verifySPMagic(*Magic))
+    return EC;
 
   // Read the version number.
   auto Version = readNumber<uint64_t>();
@@ -406,7 +443,16 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   if (std::error_code EC = readSummary())
     return EC;
 
-  // Read the name table.
+  return readNameTable();
+}
+
+std::error_code SampleProfileReaderBinary::verifySPMagic(uint64_t Magic) {
+  if (Magic == SPMagic())
+    return sampleprof_error::success;
+  return sampleprof_error::bad_magic;
+}
+
+std::error_code SampleProfileReaderBinary::readNameTable() {
   auto Size = readNumber<uint32_t>();
   if (std::error_code EC = Size.getError())
     return EC;
@@ -421,6 +467,75 @@ std::error_code SampleProfileReaderBinary::readHeader() {
   return sampleprof_error::success;
 }
 
+std::error_code SampleProfileReaderCompactBinary::verifySPMagic(uint64_t Magic) {
+  if (Magic == SPMagic(SPF_Compact_Binary))
+    return sampleprof_error::success;
+  return sampleprof_error::bad_magic;
+}
+
+std::error_code SampleProfileReaderCompactBinary::readNameTable() {
+  auto Size = readNumber<uint32_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+  // NameTable refers into MD5Names, which must not reallocate.
+  MD5Names.reserve(*Size);
+  NameTable.reserve(*Size);
+  for (uint32_t I = 0; I < *Size; ++I) {
+    auto Hash = readNumber<uint64_t>();
+    if (std::error_code EC = Hash.getError())
+      return EC;
+    MD5Names.push_back(std::to_string(*Hash));
+    NameTable.push_back(MD5Names.back());
+  }
+
+  return sampleprof_error::success;
+}
+
+std::error_code SampleProfileReaderCompactBinary::readHeader() {
+  if (std::error_code EC = SampleProfileReaderBinary::readHeader())
+    return EC;
+  return readFuncOffsetTable();
+}
+
+/// \brief Read the function offset table at the end of the file.
+///
+/// The function bodies end where the table starts, so End is moved there to
+/// let read() walk all the bodies when no functions were collected.
+std::error_code SampleProfileReaderCompactBinary::readFuncOffsetTable() {
+  const uint8_t *Start =
+      reinterpret_cast<const uint8_t *>(Buffer->getBufferStart());
+  const uint8_t *BodyStart = Data;
+  if (End - BodyStart < (ptrdiff_t)sizeof(uint64_t))
+    return sampleprof_error::truncated;
+  uint64_t TableOffset =
+      support::endian::read<uint64_t, support::little, support::unaligned>(
+          End - sizeof(uint64_t));
+  End -= sizeof(uint64_t);
+  if (TableOffset < uint64_t(BodyStart - Start) ||
+      TableOffset > uint64_t(End - Start))
+    return sampleprof_error::malformed;
+
+  Data = Start + TableOffset;
+  auto Size = readNumber<uint64_t>();
+  if (std::error_code EC = Size.getError())
+    return EC;
+  for (uint64_t I = 0; I < *Size; ++I) {
+    auto FName(readStringFromTable());
+    if (std::error_code EC = FName.getError())
+      return EC;
+    auto Offset = readNumber<uint64_t>();
+    if (std::error_code EC = Offset.getError())
+      return EC;
+    if (*Offset < uint64_t(BodyStart - Start) || *Offset >= TableOffset)
+      return sampleprof_error::malformed;
+    FuncOffsetTable[*FName] = *Offset;
+  }
+
+  Data = BodyStart;
+  End = Start + TableOffset;
+  return sampleprof_error::success;
+}
+
 std::error_code SampleProfileReaderBinary::readSummaryEntry(
     std::vector<ProfileSummaryEntry> &Entries) {
   auto Cutoff = readNumber<uint64_t>();
@@ -484,6 +599,13 @@ bool SampleProfileReaderBinary::hasFormat(const MemoryBuffer &Buffer) {
   return Magic == SPMagic();
 }
 
+bool SampleProfileReaderCompactBinary::hasFormat(const MemoryBuffer &Buffer) {
+  const uint8_t *Data =
+      reinterpret_cast<const uint8_t *>(Buffer.getBufferStart());
+  uint64_t Magic = decodeULEB128(Data);
+  return Magic == SPMagic(SPF_Compact_Binary);
+}
+
 std::error_code SampleProfileReaderGCC::skipNextWord() {
   uint32_t dummy;
   if (!GcovBuffer.readInt(dummy))
@@ -777,6 +899,8 @@ SampleProfileReader::create(std::unique_ptr<MemoryBuffer> &B, LLVMContext &C) {
   std::unique_ptr<SampleProfileReader> Reader;
   if (SampleProfileReaderBinary::hasFormat(*B))
     Reader.reset(new SampleProfileReaderBinary(std::move(B), C));
+  else if (SampleProfileReaderCompactBinary::hasFormat(*B))
+    Reader.reset(new SampleProfileReaderCompactBinary(std::move(B), C));
   else if (SampleProfileReaderGCC::hasFormat(*B))
     Reader.reset(new SampleProfileReaderGCC(std::move(B), C));
   else if (SampleProfileReaderText::hasFormat(*B))
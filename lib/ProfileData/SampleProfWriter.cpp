@@ -20,9 +20,12 @@
 
 #include "llvm/ProfileData/SampleProfWriter.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/ErrorOr.h"
 #include "llvm/Support/LEB128.h"
 #include "llvm/Support/LineIterator.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Regex.h"
 
@@ -111,11 +114,7 @@ void SampleProfileWriterBinary::addNames(const FunctionSamples &S) {
 
 std::error_code SampleProfileWriterBinary::writeHeader(
     const StringMap<FunctionSamples> &ProfileMap) {
-  auto &OS = *OutputStream;
-
-  // Write file magic identifier.
-  encodeULEB128(SPMagic(), OS);
-  encodeULEB128(SPVersion(), OS);
+  writeMagicIdent();
 
   computeSummary(ProfileMap);
   if (auto EC = writeSummary())
@@ -127,12 +126,75 @@ std::error_code SampleProfileWriterBinary::writeHeader(
     addNames(I.second);
   }
 
+  writeNameTable();
+  return sampleprof_error::success;
+}
+
+void SampleProfileWriterBinary::writeMagicIdent() {
+  auto &OS = *OutputStream;
+  // Write file magic identifier.
+  encodeULEB128(SPMagic(), OS);
+  encodeULEB128(SPVersion(), OS);
+}
+
+void SampleProfileWriterBinary::writeNameTable() {
+  auto &OS = *OutputStream;
   // Write out the name table.
   encodeULEB128(NameTable.size(), OS);
   for (auto N : NameTable) {
     OS << N.first;
     encodeULEB128(0, OS);
   }
+}
+
+void SampleProfileWriterCompactBinary::writeMagicIdent() {
+  auto &OS = *OutputStream;
+  encodeULEB128(SPMagic(SPF_Compact_Binary), OS);
+  encodeULEB128(SPVersion(), OS);
+}
+
+void SampleProfileWriterCompactBinary::writeNameTable() {
+  auto &OS = *OutputStream;
+  // Only the MD5 hash of each name is stored. The indices are unchanged.
+  encodeULEB128(NameTable.size(), OS);
+  for (auto N : NameTable) {
+    uint64_t Hash;
+    if (!UseMD5)
+      Hash = MD5Hash(N.first);
+    else if (N.first.getAsInteger(10, Hash))
+      llvm_unreachable("MD5 profile keyed by a name that isn't a hash");
+    encodeULEB128(Hash, OS);
+  }
+}
+
+/// \brief Write all the profiles followed by the function offset table.
+///
+/// The offsets are relative to the start of the profile. The last eight
+/// bytes hold the offset of the table itself, so that a reader can find it
+/// without parsing the function bodies.
+std::error_code SampleProfileWriterCompactBinary::write(
+    const StringMap<FunctionSamples> &ProfileMap) {
+  auto &OS = *OutputStream;
+  uint64_t Start = OS.tell();
+  if (std::error_code EC = writeHeader(ProfileMap))
+    return EC;
+
+  std::vector<std::pair<StringRef, uint64_t>> FuncOffsets;
+  FuncOffsets.reserve(ProfileMap.size());
+  for (const auto &I : ProfileMap) {
+    FuncOffsets.emplace_back(I.first(), OS.tell() - Start);
+    if (std::error_code EC = write(I.second))
+      return EC;
+  }
+
+  uint64_t TableOffset = OS.tell() - Start;
+  encodeULEB128(FuncOffsets.size(), OS);
+  for (const auto &Entry : FuncOffsets) {
+    if (std::error_code EC = writeNameIdx(Entry.first))
+      return EC;
+    encodeULEB128(Entry.second, OS);
+  }
+  support::endian::Writer<support::little>(OS).write<uint64_t>(TableOffset);
   return sampleprof_error::success;
 }
 
@@ -213,7 +275,7 @@ ErrorOr<std::unique_ptr<SampleProfileWriter>>
 SampleProfileWriter::create(StringRef Filename, SampleProfileFormat Format) {
   std::error_code EC;
   std::unique_ptr<raw_ostream> OS;
-  if (Format == SPF_Binary)
+  if (Format == SPF_Binary || Format == SPF_Compact_Binary)
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::F_None));
   else
     OS.reset(new raw_fd_ostream(Filename, EC, sys::fs::F_Text));
@@ -240,6 +302,8 @@ SampleProfileWriter::create(std::unique_ptr<raw_ostream> &OS,
 
   if (Format == SPF_Binary)
     Writer.reset(new SampleProfileWriterBinary(OS));
+  else if (Format == SPF_Compact_Binary)
+    Writer.reset(new SampleProfileWriterCompactBinary(OS));
   else if (Format == SPF_Text)
     Writer.reset(new SampleProfileWriterText(OS));
   else if (Format == SPF_GCC)
@@ -17,6 +17,9 @@
 #include "llvm/Config/config.h"
 #include "llvm/Support/Compiler.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
+#include <vector>
 #if LLVM_ENABLE_ZLIB == 1 && HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -62,6 +65,124 @@ zlib::Status zlib::compress(StringRef InputBuffer,
   return Res;
 }
 
+namespace {
+/// One piece of a stream written by compressParallel().
+struct DeflateChunk {
+  SmallVector<char, 0> Data;
+  uLong Adler = 0;
+  int Result = Z_OK;
+};
+}
+
+/// Deflates \p Input as raw deflate data with \p Dict as the preset
+/// dictionary. The output of every chunk but the last ends on a byte boundary
+/// so that the chunks can be concatenated.
+static void deflateChunk(StringRef Input, StringRef Dict, int CLevel,
+                         bool Last, DeflateChunk &Out) {
+  Out.Adler = ::adler32(::adler32(0, nullptr, 0), (const Bytef *)Input.data(),
+                        Input.size());
+
+  z_stream Strm = {};
+  Out.Result =
+      ::deflateInit2(&Strm, CLevel, Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_DEFAULT_STRATEGY);
+  if (Out.Result != Z_OK)
+    return;
+  if (!Dict.empty())
+    Out.Result = ::deflateSetDictionary(&Strm, (const Bytef *)Dict.data(),
+                                        Dict.size());
+  if (Out.Result == Z_OK) {
+    int Flush = Last ? Z_FINISH : Z_SYNC_FLUSH;
+    // A sync flush adds an empty stored block on top of deflateBound().
+    Out.Data.resize(::deflateBound(&Strm, Input.size()) + 16);
+    // zlib only reads the input, but declares next_in non-const unless it is
+    // built with ZLIB_CONST.
+    Strm.next_in =
+        const_cast<Bytef *>(reinterpret_cast<const Bytef *>(Input.data()));
+    Strm.avail_in = Input.size();
+    Strm.next_out = (Bytef *)Out.Data.data();
+    Strm.avail_out = Out.Data.size();
+    Out.Result = ::deflate(&Strm, Flush);
+    while (Out.Result == Z_OK && Strm.avail_out == 0) {
+      size_t Done = Out.Data.size();
+      Out.Data.resize(Done * 2);
+      Strm.next_out = (Bytef *)Out.Data.data() + Done;
+      Strm.avail_out = Out.Data.size() - Done;
+      Out.Result = ::deflate(&Strm, Flush);
+    }
+    Out.Data.resize(Out.Data.size() - Strm.avail_out);
+    // Tell MemorySanitizer that zlib output buffer is fully initialized.
+    __msan_unpoison(Out.Data.data(), Out.Data.size());
+    if (Out.Result == (Last ? Z_STREAM_END : Z_OK))
+      Out.Result = Z_OK;
+    else if (Out.Result == Z_OK || Out.Result == Z_STREAM_END)
+      Out.Result = Z_BUF_ERROR;
+  }
+  ::deflateEnd(&Strm);
+}
+
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    CompressionLevel Level, unsigned Threads,
+                                    size_t ChunkSize) {
+  assert(ChunkSize > 0 && ChunkSize <= UINT32_MAX && "Invalid chunk size");
+  if (InputBuffer.size() <= ChunkSize)
+    return compress(InputBuffer, CompressedBuffer, Level);
+
+  int CLevel = encodeZlibCompressionLevel(Level);
+  size_t NumChunks = (InputBuffer.size() + ChunkSize - 1) / ChunkSize;
+  std::vector<DeflateChunk> Chunks(NumChunks);
+  auto CompressChunk = [&](size_t I) {
+    size_t Begin = I * ChunkSize;
+    size_t DictBegin = Begin < 32768 ? 0 : Begin - 32768;
+    deflateChunk(InputBuffer.substr(Begin, ChunkSize),
+                 InputBuffer.slice(DictBegin, Begin), CLevel,
+                 I == NumChunks - 1, Chunks[I]);
+  };
+  if (Threads == 0)
+    Threads = heavyweight_hardware_concurrency();
+  if (Threads <= 1) {
+    for (size_t I = 0; I != NumChunks; ++I)
+      CompressChunk(I);
+  } else {
+    ThreadPool Pool(std::min<size_t>(Threads, NumChunks));
+    for (size_t I = 0; I != NumChunks; ++I)
+      Pool.async([&CompressChunk, I] { CompressChunk(I); });
+    Pool.wait();
+  }
+
+  // Wrap the raw deflate data in a zlib header and trailer (RFC 1950). The
+  // level hint in the header mirrors what deflate() would have written.
+  unsigned EffectiveLevel = CLevel == Z_DEFAULT_COMPRESSION ? 6 : CLevel;
+  unsigned LevelHint;
+  if (EffectiveLevel < 2)
+    LevelHint = 0;
+  else if (EffectiveLevel < 6)
+    LevelHint = 1;
+  else if (EffectiveLevel == 6)
+    LevelHint = 2;
+  else
+    LevelHint = 3;
+  unsigned Header = (0x78 << 8) | (LevelHint << 6);
+  Header += 31 - Header % 31;
+  CompressedBuffer.clear();
+  CompressedBuffer.push_back(Header >> 8);
+  CompressedBuffer.push_back(Header & 0xff);
+  uLong Adler = ::adler32(0, nullptr, 0);
+  for (size_t I = 0; I != NumChunks; ++I) {
+    DeflateChunk &C = Chunks[I];
+    if (C.Result != Z_OK)
+      return encodeZlibReturnValue(C.Result);
+    CompressedBuffer.append(C.Data.begin(), C.Data.end());
+    Adler = ::adler32_combine(Adler, C.Adler,
+                              std::min(ChunkSize, InputBuffer.size() -
+                                                      I * ChunkSize));
+  }
+  for (int Shift = 24; Shift >= 0; Shift -= 8)
+    CompressedBuffer.push_back((Adler >> Shift) & 0xff);
+  return StatusOK;
+}
+
 zlib::Status zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                               size_t &UncompressedSize) {
   Status Res = encodeZlibReturnValue(
@@ -94,6 +215,12 @@ zlib::Status zlib::compress(StringRef InputBuffer,
                             CompressionLevel Level) {
   return zlib::StatusUnsupported;
 }
+zlib::Status zlib::compressParallel(StringRef InputBuffer,
+                                    SmallVectorImpl<char> &CompressedBuffer,
+                                    CompressionLevel Level, unsigned Threads,
+                                    size_t ChunkSize) {
+  return zlib::StatusUnsupported;
+}
 zlib::Status zlib::uncompress(StringRef InputBuffer, char *UncompressedBuffer,
                               size_t &UncompressedSize) {
   return zlib::StatusUnsupported;
@@ -711,7 +711,7 @@ public:
             }
             case MCFragment::FT_Relaxable: {
               auto &RF = cast<MCRelaxableFragment>(*K);
-              auto &Inst = const_cast<MCInst &>(RF.getInst());
+              MCInst Inst = RF.getInst();
               while (Size > 0 && HexagonMCInstrInfo::bundleSize(Inst) < 4) {
                 MCInst *Nop = new (Asm.getContext()) MCInst;
                 Nop->setOpcode(Hexagon::A2_nop);
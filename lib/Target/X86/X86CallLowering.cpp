@@ -14,9 +14,14 @@
 //===----------------------------------------------------------------------===//
 
 #include "X86CallLowering.h"
+#include "X86CallingConv.h"
 #include "X86ISelLowering.h"
 #include "X86InstrInfo.h"
+#include "X86Subtarget.h"
 #include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
 
 using namespace llvm;
 
@@ -24,23 +29,362 @@ using namespace llvm;
 #error "This shouldn't be built without GISel"
 #endif
 
+#include "X86GenCallingConv.inc"
+
 X86CallLowering::X86CallLowering(const X86TargetLowering &TLI)
     : CallLowering(&TLI) {}
 
+namespace {
+/// Extend \p ValReg to the type of the location \p VA assigns it to. Unlike
+/// ValueHandler::extendRegister, this also any-extends, since a narrow value
+/// has to be copied into a full register or stack slot.
+unsigned extendToLocType(MachineIRBuilder &MIRBuilder,
+                         MachineRegisterInfo &MRI, unsigned ValReg,
+                         CCValAssign &VA) {
+  LLT LocTy{VA.getLocVT()};
+  if (LocTy.getSizeInBits() == MRI.getType(ValReg).getSizeInBits())
+    return ValReg;
+
+  unsigned LocReg = MRI.createGenericVirtualRegister(LocTy);
+  switch (VA.getLocInfo()) {
+  case CCValAssign::SExt:
+    MIRBuilder.buildSExt(LocReg, ValReg);
+    break;
+  case CCValAssign::ZExt:
+    MIRBuilder.buildZExt(LocReg, ValReg);
+    break;
+  default:
+    MIRBuilder.buildAnyExt(LocReg, ValReg);
+    break;
+  }
+  return LocReg;
+}
+
+struct IncomingValueHandler : public CallLowering::ValueHandler {
+  IncomingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       const DataLayout &DL)
+      : ValueHandler(MIRBuilder, MRI), DL(DL) {}
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    auto &MFI = MIRBuilder.getMF().getFrameInfo();
+    int FI = MFI.CreateFixedObject(Size, Offset, true);
+    MPO = MachinePointerInfo::getFixedStack(MIRBuilder.getMF(), FI);
+    unsigned AddrReg = MRI.createGenericVirtualRegister(
+        LLT::pointer(0, DL.getPointerSizeInBits(0)));
+    MIRBuilder.buildFrameIndex(AddrReg, FI);
+    return AddrReg;
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    markPhysRegUsed(PhysReg);
+
+    // A narrow value is promoted to a full register, of which only the low
+    // part is meaningful.
+    LLT LocTy{VA.getLocVT()};
+    if (LocTy.getSizeInBits() == MRI.getType(ValVReg).getSizeInBits()) {
+      MIRBuilder.buildCopy(ValVReg, PhysReg);
+      return;
+    }
+    unsigned LocReg = MRI.createGenericVirtualRegister(LocTy);
+    MIRBuilder.buildCopy(LocReg, PhysReg);
+    MIRBuilder.buildTrunc(ValVReg, LocReg);
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    auto MMO = MIRBuilder.getMF().getMachineMemOperand(
+        MPO, MachineMemOperand::MOLoad | MachineMemOperand::MOInvariant, Size,
+        0);
+    MIRBuilder.buildLoad(ValVReg, Addr, *MMO);
+  }
+
+  /// How the physical register gets marked varies between formal arguments
+  /// (it's a basic-block live-in), and a call instruction (it's an
+  /// implicit-def of the call).
+  virtual void markPhysRegUsed(unsigned PhysReg) = 0;
+
+  const DataLayout &DL;
+};
+
+struct FormalArgHandler : public IncomingValueHandler {
+  FormalArgHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                   const DataLayout &DL)
+      : IncomingValueHandler(MIRBuilder, MRI, DL) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIRBuilder.getMBB().addLiveIn(PhysReg);
+  }
+};
+
+struct CallReturnHandler : public IncomingValueHandler {
+  CallReturnHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                    const DataLayout &DL, MachineInstrBuilder &MIB)
+      : IncomingValueHandler(MIRBuilder, MRI, DL), MIB(MIB) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIB.addDef(PhysReg, RegState::Implicit);
+  }
+
+  MachineInstrBuilder &MIB;
+};
+
+struct OutgoingValueHandler : public CallLowering::ValueHandler {
+  OutgoingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       MachineInstrBuilder &MIB, const DataLayout &DL,
+                       unsigned StackReg = 0)
+      : ValueHandler(MIRBuilder, MRI), MIB(MIB), DL(DL), StackReg(StackReg) {}
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    assert(StackReg && "Return values are never passed on the stack");
+    const unsigned PtrSize = DL.getPointerSizeInBits(0);
+    unsigned SPReg = MRI.createGenericVirtualRegister(LLT::pointer(0, PtrSize));
+    MIRBuilder.buildCopy(SPReg, StackReg);
+
+    unsigned OffsetReg = MRI.createGenericVirtualRegister(LLT::scalar(PtrSize));
+    MIRBuilder.buildConstant(OffsetReg, Offset);
+
+    unsigned AddrReg =
+        MRI.createGenericVirtualRegister(LLT::pointer(0, PtrSize));
+    MIRBuilder.buildGEP(AddrReg, SPReg, OffsetReg);
+
+    MPO = MachinePointerInfo::getStack(MIRBuilder.getMF(), Offset);
+    return AddrReg;
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    MIB.addUse(PhysReg, RegState::Implicit);
+    MIRBuilder.buildCopy(PhysReg,
+                         extendToLocType(MIRBuilder, MRI, ValVReg, VA));
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    unsigned ExtReg = extendToLocType(MIRBuilder, MRI, ValVReg, VA);
+    uint64_t LocSize = VA.getLocVT().getStoreSize();
+    auto MMO = MIRBuilder.getMF().getMachineMemOperand(
+        MPO, MachineMemOperand::MOStore, LocSize, 0);
+    MIRBuilder.buildStore(ExtReg, Addr, *MMO);
+    StackSize = std::max(StackSize, VA.getLocMemOffset() + LocSize);
+  }
+
+  MachineInstrBuilder &MIB;
+  const DataLayout &DL;
+  /// The stack pointer, which outgoing call arguments are addressed from.
+  unsigned StackReg;
+  /// The number of bytes of outgoing call arguments passed on the stack.
+  uint64_t StackSize = 0;
+};
+} // End anonymous namespace.
+
+/// Return the type the calling convention should see for a value of type
+/// \p Ty, or nullptr if the value can't be lowered yet. Integers that fit a
+/// GPR, and pointers (as integers of the same width), are handled; anything
+/// that needs to be split or passed in another register class makes the
+/// function fall back.
+static Type *getLoweredArgType(Type *Ty, const DataLayout &DL,
+                               const X86Subtarget &STI) {
+  if (Ty->isPointerTy())
+    return DL.getIntPtrType(Ty);
+  if (!Ty->isIntegerTy())
+    return nullptr;
+  switch (Ty->getIntegerBitWidth()) {
+  case 1:
+  case 8:
+  case 16:
+  case 32:
+    return Ty;
+  case 64:
+    return STI.is64Bit() ? Ty : nullptr;
+  default:
+    return nullptr;
+  }
+}
+
 bool X86CallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
                                   const Value *Val, unsigned VReg) const {
-  // TODO: handle functions returning non-void values.
-  if (Val)
-    return false;
+  assert(((Val && VReg) || (!Val && !VReg)) && "Return value without a vreg");
+
+  auto MIB = MIRBuilder.buildInstrNoInsert(X86::RET).addImm(0);
 
-  MIRBuilder.buildInstr(X86::RET).addImm(0);
+  if (VReg) {
+    MachineFunction &MF = MIRBuilder.getMF();
+    const Function &F = *MF.getFunction();
+    const DataLayout &DL = F.getParent()->getDataLayout();
+    Type *Ty = getLoweredArgType(Val->getType(), DL,
+                                 MF.getSubtarget<X86Subtarget>());
+    if (!Ty)
+      return false;
 
+    ArgInfo OrigArg{VReg, Ty};
+    setArgFlags(OrigArg, AttributeSet::ReturnIndex, DL, F);
+
+    OutgoingValueHandler Handler(MIRBuilder, MF.getRegInfo(), MIB, DL);
+    if (!handleAssignments(MIRBuilder, RetCC_X86, OrigArg, Handler))
+      return false;
+  }
+
+  MIRBuilder.insertInstr(MIB);
   return true;
 }
 
 bool X86CallLowering::lowerFormalArguments(MachineIRBuilder &MIRBuilder,
                                            const Function &F,
                                            ArrayRef<unsigned> VRegs) const {
-  // TODO: handle functions with one or more arguments.
-  return F.arg_empty();
+  if (F.arg_empty())
+    return true;
+
+  // TODO: handle varargs functions.
+  if (F.isVarArg())
+    return false;
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  MachineBasicBlock &MBB = MIRBuilder.getMBB();
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  const X86Subtarget &STI = MF.getSubtarget<X86Subtarget>();
+
+  SmallVector<ArgInfo, 8> Args;
+  unsigned Idx = 0;
+  for (auto &Arg : F.getArgumentList()) {
+    Type *Ty = getLoweredArgType(Arg.getType(), DL, STI);
+    if (!Ty)
+      return false;
+    ArgInfo OrigArg{VRegs[Idx], Ty};
+    setArgFlags(OrigArg, Idx + 1, DL, F);
+    // TODO: handle byval, inreg, sret, nest and friends.
+    if (OrigArg.Flags.isByVal() || OrigArg.Flags.isInReg() ||
+        OrigArg.Flags.isSRet() || OrigArg.Flags.isNest())
+      return false;
+    Args.push_back(OrigArg);
+    ++Idx;
+  }
+
+  if (!MBB.empty())
+    MIRBuilder.setInstr(*MBB.begin());
+
+  FormalArgHandler Handler(MIRBuilder, MF.getRegInfo(), DL);
+  if (!handleAssignments(MIRBuilder, CC_X86, Args, Handler))
+    return false;
+
+  // Move back to the end of the basic block.
+  MIRBuilder.setMBB(MBB);
+
+  return true;
+}
+
+bool X86CallLowering::lowerCall(MachineIRBuilder &MIRBuilder,
+                                const CallInst &CI, unsigned ResReg,
+                                ArrayRef<unsigned> ArgRegs,
+                                std::function<unsigned()> GetCalleeReg) const {
+  // Arguments are assigned with the caller's calling convention, and variadic
+  // calls would also need AL to hold the number of vector arguments.
+  // TODO: handle these, and musttail calls.
+  const Function &F = *MIRBuilder.getMF().getFunction();
+  if (CI.getCallingConv() != F.getCallingConv() || F.isVarArg() ||
+      CI.getFunctionType()->isVarArg() || CI.isMustTailCall())
+    return false;
+
+  return CallLowering::lowerCall(MIRBuilder, CI, ResReg, ArgRegs,
+                                 GetCalleeReg);
+}
+
+bool X86CallLowering::lowerCall(MachineIRBuilder &MIRBuilder,
+                                const MachineOperand &Callee,
+                                const ArgInfo &OrigRet,
+                                ArrayRef<ArgInfo> OrigArgs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = *MF.getFunction();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+  const DataLayout &DL = F.getParent()->getDataLayout();
+  const X86Subtarget &STI = MF.getSubtarget<X86Subtarget>();
+  const X86InstrInfo &TII = *STI.getInstrInfo();
+  const X86RegisterInfo &TRI = *STI.getRegisterInfo();
+
+  // TODO: allocate the shadow area of the Win64 calling convention.
+  if (STI.isTargetWin64())
+    return false;
+
+  SmallVector<ArgInfo, 8> Args;
+  for (const ArgInfo &OrigArg : OrigArgs) {
+    Type *Ty = getLoweredArgType(OrigArg.Ty, DL, STI);
+    if (!Ty)
+      return false;
+    // TODO: handle byval, inreg, sret, nest and friends.
+    if (OrigArg.Flags.isByVal() || OrigArg.Flags.isInReg() ||
+        OrigArg.Flags.isSRet() || OrigArg.Flags.isNest())
+      return false;
+    Args.push_back(ArgInfo{OrigArg.Reg, Ty, OrigArg.Flags});
+  }
+
+  ArgInfo Ret = OrigRet;
+  if (Ret.Reg) {
+    Ret.Ty = getLoweredArgType(OrigRet.Ty, DL, STI);
+    if (!Ret.Ty)
+      return false;
+  }
+
+  // Direct calls go through the PLT where the callee may be preempted. Calls
+  // that load the callee's address from the GOT, and 32-bit PLT calls, which
+  // need the GOT address in EBX, are left to SelectionDAG.
+  MachineOperand CalleeOp = Callee;
+  if (Callee.isGlobal()) {
+    unsigned char OpFlags =
+        STI.classifyGlobalFunctionReference(Callee.getGlobal());
+    if (OpFlags != X86II::MO_NO_FLAG &&
+        !(OpFlags == X86II::MO_PLT && STI.is64Bit()))
+      return false;
+    CalleeOp.setTargetFlags(OpFlags);
+  } else if (!Callee.isReg()) {
+    return false;
+  }
+
+  unsigned CallOpc;
+  if (Callee.isReg())
+    CallOpc = STI.is64Bit() ? X86::CALL64r : X86::CALL32r;
+  else
+    CallOpc = STI.is64Bit() ? X86::CALL64pcrel32 : X86::CALLpcrel32;
+
+  // The size of the outgoing arguments is only known once they have been
+  // assigned, so the call frame setup is patched afterwards.
+  auto CallSeqStart = MIRBuilder.buildInstr(TII.getCallFrameSetupOpcode())
+                          .addImm(0)
+                          .addImm(0);
+
+  // Create a temporarily-floating call instruction so we can add the implicit
+  // uses of arg registers.
+  auto MIB = MIRBuilder.buildInstrNoInsert(CallOpc);
+  MIB.addOperand(CalleeOp);
+
+  // Tell the call which registers are clobbered.
+  MIB.addRegMask(TRI.getCallPreservedMask(MF, F.getCallingConv()));
+
+  OutgoingValueHandler Handler(MIRBuilder, MRI, MIB, DL,
+                               TRI.getStackRegister());
+  if (!handleAssignments(MIRBuilder, CC_X86, Args, Handler))
+    return false;
+
+  const uint64_t NumBytes =
+      alignTo(Handler.StackSize, STI.getFrameLowering()->getStackAlignment());
+  CallSeqStart->getOperand(0).setImm(NumBytes);
+
+  // Now we can add the actual call instruction to the correct basic block.
+  MIRBuilder.insertInstr(MIB);
+
+  MIRBuilder.buildInstr(TII.getCallFrameDestroyOpcode())
+      .addImm(NumBytes)
+      .addImm(0);
+
+  // Finally copy the returned value back into its virtual register. In
+  // symmetry with the arguments, the physical register must be an
+  // implicit-define of the call instruction.
+  if (Ret.Reg) {
+    CallReturnHandler RetHandler(MIRBuilder, MRI, DL, MIB);
+    if (!handleAssignments(MIRBuilder, RetCC_X86, Ret, RetHandler))
+      return false;
+  }
+
+  return true;
 }
@@ -0,0 +1,544 @@
+//===- X86InstructionSelector.cpp --------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// X86.
+///
+/// Only integer and pointer code that fits a general purpose register is
+/// selected. Floating point, vectors and wide integers still fall back to
+/// SelectionDAG.
+//===----------------------------------------------------------------------===//
+
+#include "X86InstructionSelector.h"
+#include "X86InstrBuilder.h"
+#include "X86InstrInfo.h"
+#include "X86RegisterBankInfo.h"
+#include "X86RegisterInfo.h"
+#include "X86Subtarget.h"
+#include "llvm/CodeGen/MachineBasicBlock.h"
+#include "llvm/CodeGen/MachineFunction.h"
+#include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#define DEBUG_TYPE "x86-isel"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+X86InstructionSelector::X86InstructionSelector(const X86Subtarget &STI,
+                                               const X86RegisterBankInfo &RBI)
+    : InstructionSelector(), STI(STI), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI) {}
+
+/// Map a GPR size in bits to the index used by the opcode tables below:
+/// 8 -> 0, 16 -> 1, 32 -> 2, 64 -> 3, anything else -> -1.
+static int getGPRSizeIdx(unsigned Size) {
+  switch (Size) {
+  case 8:
+    return 0;
+  case 16:
+    return 1;
+  case 32:
+    return 2;
+  case 64:
+    return 3;
+  default:
+    return -1;
+  }
+}
+
+// FIXME: This should be target-independent, inferred from the types declared
+// for each class in the bank.
+static const TargetRegisterClass *
+getRegClassForTypeOnBank(LLT Ty, const RegisterBank &RB) {
+  if (RB.getID() != X86::GPRRegBankID)
+    return nullptr;
+
+  static const TargetRegisterClass *const GPRClasses[] = {
+      &X86::GR8RegClass, &X86::GR16RegClass, &X86::GR32RegClass,
+      &X86::GR64RegClass};
+  // Booleans live in 8-bit registers.
+  unsigned Size = Ty.getSizeInBits() == 1 ? 8 : Ty.getSizeInBits();
+  int Idx = getGPRSizeIdx(Size);
+  return Idx < 0 ? nullptr : GPRClasses[Idx];
+}
+
+/// Select the X86 opcode for the generic binary operation \p GenericOpc on
+/// \p Size bits, or return \p GenericOpc if there is none.
+static unsigned selectBinaryOp(unsigned GenericOpc, unsigned Size) {
+  // Each row holds the register-register forms for 8, 16, 32 and 64 bits.
+  static const unsigned AddOps[] = {X86::ADD8rr, X86::ADD16rr, X86::ADD32rr,
+                                    X86::ADD64rr};
+  static const unsigned SubOps[] = {X86::SUB8rr, X86::SUB16rr, X86::SUB32rr,
+                                    X86::SUB64rr};
+  static const unsigned AndOps[] = {X86::AND8rr, X86::AND16rr, X86::AND32rr,
+                                    X86::AND64rr};
+  static const unsigned OrOps[] = {X86::OR8rr, X86::OR16rr, X86::OR32rr,
+                                   X86::OR64rr};
+  static const unsigned XorOps[] = {X86::XOR8rr, X86::XOR16rr, X86::XOR32rr,
+                                    X86::XOR64rr};
+  // There is no two-operand 8-bit multiply; the legalizer widens it.
+  static const unsigned MulOps[] = {TargetOpcode::G_MUL, X86::IMUL16rr,
+                                    X86::IMUL32rr, X86::IMUL64rr};
+
+  int Idx = getGPRSizeIdx(Size);
+  if (Idx < 0)
+    return GenericOpc;
+
+  switch (GenericOpc) {
+  case TargetOpcode::G_ADD:
+    return AddOps[Idx];
+  case TargetOpcode::G_SUB:
+    return SubOps[Idx];
+  case TargetOpcode::G_AND:
+    return AndOps[Idx];
+  case TargetOpcode::G_OR:
+    return OrOps[Idx];
+  case TargetOpcode::G_XOR:
+    return XorOps[Idx];
+  case TargetOpcode::G_MUL:
+    return MulOps[Idx];
+  default:
+    return GenericOpc;
+  }
+}
+
+/// Select the X86 opcode for the generic load or store \p GenericOpc of
+/// \p Size bits, or return \p GenericOpc if there is none.
+static unsigned selectLoadStoreOp(unsigned GenericOpc, unsigned Size) {
+  static const unsigned LoadOps[] = {X86::MOV8rm, X86::MOV16rm, X86::MOV32rm,
+                                     X86::MOV64rm};
+  static const unsigned StoreOps[] = {X86::MOV8mr, X86::MOV16mr, X86::MOV32mr,
+                                      X86::MOV64mr};
+
+  int Idx = getGPRSizeIdx(Size);
+  if (Idx < 0)
+    return GenericOpc;
+
+  switch (GenericOpc) {
+  case TargetOpcode::G_LOAD:
+    return LoadOps[Idx];
+  case TargetOpcode::G_STORE:
+    return StoreOps[Idx];
+  default:
+    return GenericOpc;
+  }
+}
+
+/// Return the condition code for the integer predicate \p Pred.
+static X86::CondCode getX86ConditionCode(CmpInst::Predicate Pred) {
+  switch (Pred) {
+  case CmpInst::ICMP_EQ:
+    return X86::COND_E;
+  case CmpInst::ICMP_NE:
+    return X86::COND_NE;
+  case CmpInst::ICMP_UGT:
+    return X86::COND_A;
+  case CmpInst::ICMP_UGE:
+    return X86::COND_AE;
+  case CmpInst::ICMP_ULT:
+    return X86::COND_B;
+  case CmpInst::ICMP_ULE:
+    return X86::COND_BE;
+  case CmpInst::ICMP_SGT:
+    return X86::COND_G;
+  case CmpInst::ICMP_SGE:
+    return X86::COND_GE;
+  case CmpInst::ICMP_SLT:
+    return X86::COND_L;
+  case CmpInst::ICMP_SLE:
+    return X86::COND_LE;
+  default:
+    return X86::COND_INVALID;
+  }
+}
+
+/// Add the memory reference to \p PtrReg to \p MIB. The address of a stack
+/// object is folded into the reference instead of being materialized.
+static void addPtrReference(const MachineInstrBuilder &MIB, unsigned PtrReg,
+                            const MachineRegisterInfo &MRI) {
+  const MachineInstr *PtrDef = MRI.getVRegDef(PtrReg);
+  if (PtrDef && PtrDef->getOpcode() == TargetOpcode::G_FRAME_INDEX)
+    addOffset(MIB.addFrameIndex(PtrDef->getOperand(1).getIndex()), 0);
+  else
+    addDirectMem(MIB, PtrReg);
+}
+
+static bool selectCopy(MachineInstr &I, const TargetInstrInfo &TII,
+                       MachineRegisterInfo &MRI, const TargetRegisterInfo &TRI,
+                       const RegisterBankInfo &RBI) {
+  unsigned DstReg = I.getOperand(0).getReg();
+  if (TargetRegisterInfo::isPhysicalRegister(DstReg)) {
+    assert(I.isCopy() && "Generic operators do not allow physical registers");
+    return true;
+  }
+
+  const RegisterBank &RegBank = *RBI.getRegBank(DstReg, MRI, TRI);
+  const TargetRegisterClass *RC =
+      getRegClassForTypeOnBank(MRI.getType(DstReg), RegBank);
+  if (!RC) {
+    DEBUG(dbgs() << "Unexpected copy of " << MRI.getType(DstReg) << " on bank "
+                 << RegBank << '\n');
+    return false;
+  }
+
+  // No need to constrain SrcReg. It will get constrained when
+  // we hit another of its use or its defs.
+  // Copies do not have constraints.
+  if (!RBI.constrainGenericRegister(DstReg, *RC, MRI)) {
+    DEBUG(dbgs() << "Failed to constrain " << TII.getName(I.getOpcode())
+                 << " operand\n");
+    return false;
+  }
+  I.setDesc(TII.get(X86::COPY));
+  return true;
+}
+
+bool X86InstructionSelector::selectCompare(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  static const unsigned CmpOps[] = {X86::CMP8rr, X86::CMP16rr, X86::CMP32rr,
+                                    X86::CMP64rr};
+
+  const unsigned DstReg = I.getOperand(0).getReg();
+  const unsigned LHS = I.getOperand(2).getReg();
+  const unsigned RHS = I.getOperand(3).getReg();
+  const X86::CondCode CC =
+      getX86ConditionCode(CmpInst::Predicate(I.getOperand(1).getPredicate()));
+  const int Idx = getGPRSizeIdx(MRI.getType(LHS).getSizeInBits());
+  if (CC == X86::COND_INVALID || Idx < 0) {
+    DEBUG(dbgs() << "Unsupported comparison of " << MRI.getType(LHS) << '\n');
+    return false;
+  }
+
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  MachineInstr &Cmp =
+      *BuildMI(MBB, I, DL, TII.get(CmpOps[Idx])).addUse(LHS).addUse(RHS);
+  MachineInstr &Set =
+      *BuildMI(MBB, I, DL, TII.get(X86::getSETFromCond(CC)), DstReg);
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(Cmp, TII, TRI, RBI) &&
+         constrainSelectedInstRegOperands(Set, TII, TRI, RBI);
+}
+
+bool X86InstructionSelector::selectCondBranch(MachineInstr &I,
+                                              MachineRegisterInfo &MRI) const {
+  // Only the low bit of a boolean is defined.
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  MachineInstr &Test = *BuildMI(MBB, I, DL, TII.get(X86::TEST8ri))
+                            .addUse(I.getOperand(0).getReg())
+                            .addImm(1);
+  BuildMI(MBB, I, DL, TII.get(X86::JNE_1)).addMBB(I.getOperand(1).getMBB());
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(Test, TII, TRI, RBI);
+}
+
+bool X86InstructionSelector::selectExt(MachineInstr &I,
+                                       MachineRegisterInfo &MRI) const {
+  const unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+  const unsigned DstSize = MRI.getType(DstReg).getSizeInBits();
+  unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+  // The high bits of an any-extension are undefined, so zero them.
+  const bool IsSExt = I.getOpcode() == TargetOpcode::G_SEXT;
+
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  SmallVector<MachineInstr *, 3> NewMIs;
+
+  // A boolean lives in an 8-bit register with undefined bits above the low
+  // one: clear them, then negate to sign-extend.
+  if (SrcSize == 1) {
+    unsigned MaskedReg = DstSize == 8 && !IsSExt
+                             ? DstReg
+                             : MRI.createVirtualRegister(&X86::GR8RegClass);
+    NewMIs.push_back(
+        BuildMI(MBB, I, DL, TII.get(X86::AND8ri), MaskedReg)
+            .addUse(SrcReg)
+            .addImm(1));
+    SrcReg = MaskedReg;
+    if (IsSExt) {
+      unsigned NegReg = DstSize == 8
+                            ? DstReg
+                            : MRI.createVirtualRegister(&X86::GR8RegClass);
+      NewMIs.push_back(
+          BuildMI(MBB, I, DL, TII.get(X86::NEG8r), NegReg).addUse(SrcReg));
+      SrcReg = NegReg;
+    }
+    SrcSize = 8;
+  }
+
+  if (SrcSize != DstSize) {
+    unsigned Opc;
+    switch (DstSize * 100 + SrcSize) {
+    case 1608:
+      Opc = IsSExt ? X86::MOVSX16rr8 : X86::MOVZX16rr8;
+      break;
+    case 3208:
+      Opc = IsSExt ? X86::MOVSX32rr8 : X86::MOVZX32rr8;
+      break;
+    case 3216:
+      Opc = IsSExt ? X86::MOVSX32rr16 : X86::MOVZX32rr16;
+      break;
+    case 6408:
+      Opc = IsSExt ? X86::MOVSX64rr8 : X86::MOVZX32rr8;
+      break;
+    case 6416:
+      Opc = IsSExt ? X86::MOVSX64rr16 : X86::MOVZX32rr16;
+      break;
+    case 6432:
+      Opc = IsSExt ? X86::MOVSX64rr32 : X86::MOV32rr;
+      break;
+    default:
+      DEBUG(dbgs() << "Unsupported extension from " << SrcSize << " to "
+                   << DstSize << " bits\n");
+      return false;
+    }
+
+    if (DstSize == 64 && !IsSExt) {
+      // Writing a 32-bit register zeroes the upper half of its 64-bit one.
+      unsigned Reg32 = MRI.createVirtualRegister(&X86::GR32RegClass);
+      NewMIs.push_back(
+          BuildMI(MBB, I, DL, TII.get(Opc), Reg32).addUse(SrcReg));
+      NewMIs.push_back(BuildMI(MBB, I, DL, TII.get(X86::SUBREG_TO_REG), DstReg)
+                           .addImm(0)
+                           .addUse(Reg32)
+                           .addImm(X86::sub_32bit));
+      if (!RBI.constrainGenericRegister(DstReg, X86::GR64RegClass, MRI))
+        return false;
+    } else {
+      NewMIs.push_back(BuildMI(MBB, I, DL, TII.get(Opc), DstReg).addUse(SrcReg));
+    }
+  }
+
+  I.eraseFromParent();
+  for (MachineInstr *MI : NewMIs)
+    if (MI->getOpcode() != X86::SUBREG_TO_REG &&
+        !constrainSelectedInstRegOperands(*MI, TII, TRI, RBI))
+      return false;
+  return true;
+}
+
+bool X86InstructionSelector::selectTrunc(MachineInstr &I,
+                                         MachineRegisterInfo &MRI) const {
+  const unsigned DstReg = I.getOperand(0).getReg();
+  const unsigned SrcReg = I.getOperand(1).getReg();
+  const RegisterBank &RB = *RBI.getRegBank(SrcReg, MRI, TRI);
+  const TargetRegisterClass *DstRC =
+      getRegClassForTypeOnBank(MRI.getType(DstReg), RB);
+  const TargetRegisterClass *SrcRC =
+      getRegClassForTypeOnBank(MRI.getType(SrcReg), RB);
+  if (!DstRC || !SrcRC) {
+    DEBUG(dbgs() << "Unsupported truncation to " << MRI.getType(DstReg)
+                 << '\n');
+    return false;
+  }
+
+  // A truncation is a copy of the low subregister; booleans are held in the
+  // same 8-bit register as the s8 they came from.
+  if (DstRC != SrcRC) {
+    unsigned SubIdx = X86::sub_32bit;
+    if (DstRC == &X86::GR8RegClass)
+      SubIdx = X86::sub_8bit;
+    else if (DstRC == &X86::GR16RegClass)
+      SubIdx = X86::sub_16bit;
+    // Outside 64-bit mode only some registers have an 8-bit subregister.
+    SrcRC = TRI.getSubClassWithSubReg(SrcRC, SubIdx);
+    I.getOperand(1).setSubReg(SubIdx);
+  }
+
+  if (!RBI.constrainGenericRegister(SrcReg, *SrcRC, MRI) ||
+      !RBI.constrainGenericRegister(DstReg, *DstRC, MRI)) {
+    DEBUG(dbgs() << "Failed to constrain G_TRUNC\n");
+    return false;
+  }
+  I.setDesc(TII.get(X86::COPY));
+  return true;
+}
+
+bool X86InstructionSelector::select(MachineInstr &I) const {
+  assert(I.getParent() && "Instruction should be in a basic block!");
+  assert(I.getParent()->getParent() && "Instruction should be in a function!");
+
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  unsigned Opcode = I.getOpcode();
+  if (!isPreISelGenericOpcode(Opcode)) {
+    // Certain non-generic instructions also need some special handling.
+
+    if (Opcode == TargetOpcode::PHI) {
+      const unsigned DefReg = I.getOperand(0).getReg();
+      const TargetRegisterClass *DefRC = nullptr;
+      if (TargetRegisterInfo::isPhysicalRegister(DefReg)) {
+        DefRC = TRI.getMinimalPhysRegClass(DefReg);
+      } else {
+        const RegClassOrRegBank &RegClassOrBank =
+            MRI.getRegClassOrRegBank(DefReg);
+        DefRC = RegClassOrBank.dyn_cast<const TargetRegisterClass *>();
+        if (!DefRC) {
+          const RegisterBank &RB = *RegClassOrBank.get<const RegisterBank *>();
+          DefRC = getRegClassForTypeOnBank(MRI.getType(DefReg), RB);
+          if (!DefRC) {
+            DEBUG(dbgs() << "PHI operand has unexpected size/bank\n");
+            return false;
+          }
+        }
+      }
+      return RBI.constrainGenericRegister(DefReg, *DefRC, MRI);
+    }
+
+    if (I.isCopy())
+      return selectCopy(I, TII, MRI, TRI, RBI);
+
+    return true;
+  }
+
+  if (I.getNumOperands() != I.getNumExplicitOperands()) {
+    DEBUG(dbgs() << "Generic instruction has unexpected implicit operands\n");
+    return false;
+  }
+
+  LLT Ty =
+      I.getOperand(0).isReg() ? MRI.getType(I.getOperand(0).getReg()) : LLT{};
+
+  switch (Opcode) {
+  case TargetOpcode::G_BR: {
+    I.setDesc(TII.get(X86::JMP_1));
+    return true;
+  }
+
+  case TargetOpcode::G_BRCOND:
+    return selectCondBranch(I, MRI);
+
+  case TargetOpcode::G_ICMP:
+    return selectCompare(I, MRI);
+
+  case TargetOpcode::G_ZEXT:
+  case TargetOpcode::G_SEXT:
+  case TargetOpcode::G_ANYEXT:
+    return selectExt(I, MRI);
+
+  case TargetOpcode::G_TRUNC:
+    return selectTrunc(I, MRI);
+
+  case TargetOpcode::G_PTRTOINT:
+  case TargetOpcode::G_INTTOPTR:
+    return selectCopy(I, TII, MRI, TRI, RBI);
+
+  case TargetOpcode::G_ADD:
+  case TargetOpcode::G_SUB:
+  case TargetOpcode::G_MUL:
+  case TargetOpcode::G_AND:
+  case TargetOpcode::G_OR:
+  case TargetOpcode::G_XOR: {
+    const unsigned NewOpc = selectBinaryOp(Opcode, Ty.getSizeInBits());
+    if (NewOpc == Opcode) {
+      DEBUG(dbgs() << "Unsupported binary operation on " << Ty << '\n');
+      return false;
+    }
+
+    I.setDesc(TII.get(NewOpc));
+    // The X86 forms also clobber EFLAGS.
+    I.addImplicitDefUseOperands(MF);
+    return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_CONSTANT: {
+    const unsigned Size = Ty.getSizeInBits();
+    const int64_t Val = I.getOperand(1).getCImm()->getSExtValue();
+    unsigned NewOpc;
+    switch (Size) {
+    case 8:
+      NewOpc = X86::MOV8ri;
+      break;
+    case 16:
+      NewOpc = X86::MOV16ri;
+      break;
+    case 32:
+      NewOpc = X86::MOV32ri;
+      break;
+    case 64:
+      // Use the shorter sign-extended form when the value allows it.
+      NewOpc = isInt<32>(Val) ? X86::MOV64ri32 : X86::MOV64ri;
+      break;
+    default:
+      DEBUG(dbgs() << "Unable to materialize integer " << Ty << " constant\n");
+      return false;
+    }
+
+    I.setDesc(TII.get(NewOpc));
+    I.getOperand(1).ChangeToImmediate(Val);
+    return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_FRAME_INDEX: {
+    // All the uses may have been folded into memory operands.
+    if (MRI.use_empty(I.getOperand(0).getReg())) {
+      I.eraseFromParent();
+      return true;
+    }
+    I.setDesc(TII.get(STI.is64Bit() ? X86::LEA64r : X86::LEA32r));
+    // Turn the frame index operand into a full address.
+    MachineInstrBuilder MIB(MF, I);
+    addOffset(MIB, 0);
+    return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_GEP: {
+    MachineInstrBuilder MIB =
+        BuildMI(MBB, I, I.getDebugLoc(),
+                TII.get(STI.is64Bit() ? X86::LEA64r : X86::LEA32r),
+                I.getOperand(0).getReg());
+    addRegReg(MIB, I.getOperand(1).getReg(), false, I.getOperand(2).getReg(),
+              false);
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+
+  case TargetOpcode::G_LOAD:
+  case TargetOpcode::G_STORE: {
+    const unsigned ValReg = I.getOperand(0).getReg();
+    const unsigned PtrReg = I.getOperand(1).getReg();
+    const unsigned NewOpc = selectLoadStoreOp(Opcode, Ty.getSizeInBits());
+    if (NewOpc == Opcode) {
+      DEBUG(dbgs() << "Unsupported load/store of " << Ty << '\n');
+      return false;
+    }
+
+    MachineInstrBuilder MIB =
+        BuildMI(MBB, I, I.getDebugLoc(), TII.get(NewOpc));
+    if (Opcode == TargetOpcode::G_LOAD) {
+      MIB.addDef(ValReg);
+      addPtrReference(MIB, PtrReg, MRI);
+    } else {
+      addPtrReference(MIB, PtrReg, MRI);
+      MIB.addUse(ValReg);
+    }
+    MIB.setMemRefs(I.memoperands_begin(), I.memoperands_end());
+
+    I.eraseFromParent();
+    return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+  }
+  }
+
+  return false;
+}
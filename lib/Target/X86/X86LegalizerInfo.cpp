@@ -0,0 +1,113 @@
+//===- X86LegalizerInfo.cpp --------------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the Machinelegalizer class for X86.
+//===----------------------------------------------------------------------===//
+
+#include "X86LegalizerInfo.h"
+#include "X86Subtarget.h"
+#include "llvm/CodeGen/ValueTypes.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/Type.h"
+#include "llvm/Target/TargetOpcodes.h"
+
+using namespace llvm;
+
+#ifndef LLVM_BUILD_GLOBAL_ISEL
+#error "You shouldn't build this"
+#endif
+
+X86LegalizerInfo::X86LegalizerInfo(const X86Subtarget &STI) {
+  using namespace TargetOpcode;
+  const LLT p0 = LLT::pointer(0, STI.is64Bit() ? 64 : 32);
+  const LLT s1 = LLT::scalar(1);
+  const LLT s8 = LLT::scalar(8);
+  const LLT s16 = LLT::scalar(16);
+  const LLT s32 = LLT::scalar(32);
+  const LLT s64 = LLT::scalar(64);
+
+  // 64-bit values only fit a GPR in 64-bit mode; leave them unsupported
+  // otherwise so that such functions fall back to SelectionDAG.
+  SmallVector<LLT, 4> GPRTys = {s8, s16, s32};
+  if (STI.is64Bit())
+    GPRTys.push_back(s64);
+
+  for (auto BinOp : {G_ADD, G_SUB, G_AND, G_OR, G_XOR}) {
+    for (auto Ty : GPRTys)
+      setAction({BinOp, Ty}, Legal);
+
+    setAction({BinOp, s1}, WidenScalar);
+  }
+
+  // There is no two-address 8-bit multiply.
+  for (auto Ty : GPRTys)
+    if (Ty != s8)
+      setAction({G_MUL, Ty}, Legal);
+  setAction({G_MUL, s1}, WidenScalar);
+  setAction({G_MUL, s8}, WidenScalar);
+
+  for (auto MemOp : {G_LOAD, G_STORE}) {
+    for (auto Ty : GPRTys)
+      setAction({MemOp, Ty}, Legal);
+    setAction({MemOp, p0}, Legal);
+
+    setAction({MemOp, s1}, WidenScalar);
+
+    // And everything's fine in addrspace 0.
+    setAction({MemOp, 1, p0}, Legal);
+  }
+
+  // Constants
+  for (auto Ty : GPRTys)
+    setAction({G_CONSTANT, Ty}, Legal);
+  setAction({G_CONSTANT, p0}, Legal);
+
+  setAction({G_CONSTANT, s1}, WidenScalar);
+
+  // Comparisons
+  setAction({G_ICMP, s1}, Legal);
+  for (auto Ty : GPRTys)
+    setAction({G_ICMP, 1, Ty}, Legal);
+  setAction({G_ICMP, 1, p0}, Legal);
+  setAction({G_ICMP, 1, s1}, WidenScalar);
+
+  // Control-flow
+  setAction({G_BRCOND, s1}, Legal);
+
+  // Extensions and truncations. Booleans live in 8-bit registers, so they
+  // are legal on both sides.
+  for (auto Ty : GPRTys) {
+    for (auto ExtOp : {G_ZEXT, G_SEXT, G_ANYEXT}) {
+      setAction({ExtOp, Ty}, Legal);
+      setAction({ExtOp, 1, Ty}, Legal);
+    }
+    setAction({G_TRUNC, Ty}, Legal);
+    setAction({G_TRUNC, 1, Ty}, Legal);
+  }
+  for (auto ExtOp : {G_ZEXT, G_SEXT, G_ANYEXT})
+    setAction({ExtOp, 1, s1}, Legal);
+  setAction({G_TRUNC, s1}, Legal);
+
+  // Pointer-handling
+  setAction({G_FRAME_INDEX, p0}, Legal);
+
+  setAction({G_GEP, p0}, Legal);
+  setAction({G_GEP, 1, STI.is64Bit() ? s64 : s32}, Legal);
+  for (auto Ty : {s1, s8, s16})
+    setAction({G_GEP, 1, Ty}, WidenScalar);
+  if (STI.is64Bit())
+    setAction({G_GEP, 1, s32}, WidenScalar);
+
+  setAction({G_PTRTOINT, 1, p0}, Legal);
+  setAction({G_PTRTOINT, STI.is64Bit() ? s64 : s32}, Legal);
+  setAction({G_INTTOPTR, p0}, Legal);
+  setAction({G_INTTOPTR, 1, STI.is64Bit() ? s64 : s32}, Legal);
+
+  computeTables();
+}
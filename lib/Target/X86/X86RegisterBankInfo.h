@@ -0,0 +1,48 @@
+//===- X86RegisterBankInfo ---------------------------------------*- C++ -*-==//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the RegisterBankInfo class for X86.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_X86_X86REGISTERBANKINFO_H
+#define LLVM_LIB_TARGET_X86_X86REGISTERBANKINFO_H
+
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+
+namespace llvm {
+
+class TargetRegisterInfo;
+
+namespace X86 {
+enum {
+  GPRRegBankID = 0, /// General Purpose Registers: GR8, GR16, GR32, GR64.
+  NumRegisterBanks
+};
+
+extern RegisterBank GPRRegBank;
+} // End X86 namespace.
+
+/// This class provides the information for the target register banks.
+/// Only the general purpose registers are modeled so far; anything that
+/// needs another bank gets no mapping and falls back to SelectionDAG.
+class X86RegisterBankInfo final : public RegisterBankInfo {
+public:
+  X86RegisterBankInfo(const TargetRegisterInfo &TRI);
+
+  /// Get a register bank that covers \p RC.
+  ///
+  /// \pre \p RC is a user-defined register class (as opposed as one
+  /// generated by TableGen).
+  const RegisterBank &
+  getRegBankFromRegClass(const TargetRegisterClass &RC) const override;
+
+  InstructionMapping getInstrMapping(const MachineInstr &MI) const override;
+};
+} // End llvm namespace.
+#endif
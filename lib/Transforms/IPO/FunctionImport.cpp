@@ -28,6 +28,7 @@
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Transforms/IPO/Internalize.h"
 #include "llvm/Transforms/Utils/FunctionImportUtils.h"
 
@@ -272,15 +273,12 @@ static void exportGlobalInModule(const ModuleSummaryIndex &Index,
 
 using EdgeInfo = std::pair<const FunctionSummary *, unsigned /* Threshold */>;
 
-/// Compute the list of functions to import for a given caller. Mark these
-/// imported functions and the symbols they reference in their source module as
-/// exported from their source module.
+/// Compute the list of functions to import for a given caller.
 static void computeImportForFunction(
     const FunctionSummary &Summary, const ModuleSummaryIndex &Index,
     const unsigned Threshold, const GVSummaryMapTy &DefinedGVSummaries,
     SmallVectorImpl<EdgeInfo> &Worklist,
-    FunctionImporter::ImportMapTy &ImportList,
-    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
+    FunctionImporter::ImportMapTy &ImportList) {
   for (auto &Edge : Summary.calls()) {
     auto GUID = Edge.first.getGUID();
     DEBUG(dbgs() << " edge -> " << GUID << " Threshold:" << Threshold << "\n");
@@ -333,22 +331,6 @@ static void computeImportForFunction(
     // Mark this function as imported in this module, with the current Threshold
     ProcessedThreshold = Threshold;
 
-    // Make exports in the source module.
-    if (ExportLists) {
-      auto &ExportList = (*ExportLists)[ExportModulePath];
-      ExportList.insert(GUID);
-      // Mark all functions and globals referenced by this function as exported
-      // to the outside if they are defined in the same source module.
-      for (auto &Edge : ResolvedCalleeSummary->calls()) {
-        auto CalleeGUID = Edge.first.getGUID();
-        exportGlobalInModule(Index, ExportModulePath, CalleeGUID, ExportList);
-      }
-      for (auto &Ref : ResolvedCalleeSummary->refs()) {
-        auto GUID = Ref.getGUID();
-        exportGlobalInModule(Index, ExportModulePath, GUID, ExportList);
-      }
-    }
-
     auto GetAdjustedThreshold = [](unsigned Threshold, bool IsHotCallsite) {
       // Adjust the threshold for next level of imported functions.
       // The threshold is different for hot callsites because we can then
@@ -366,13 +348,13 @@ static void computeImportForFunction(
   }
 }
 
-/// Given the list of globals defined in a module, compute the list of imports
-/// as well as the list of "exports", i.e. the list of symbols referenced from
-/// another module (that may require promotion).
+/// Given the list of globals defined in a module, compute the list of imports.
+/// The matching "exports", i.e. the list of symbols referenced from another
+/// module (that may require promotion), are derived from the import lists of
+/// all modules by computeExportsForModule().
 static void ComputeImportForModule(
     const GVSummaryMapTy &DefinedGVSummaries, const ModuleSummaryIndex &Index,
-    FunctionImporter::ImportMapTy &ImportList,
-    StringMap<FunctionImporter::ExportSetTy> *ExportLists = nullptr) {
+    FunctionImporter::ImportMapTy &ImportList) {
   // Worklist contains the list of function imported in this module, for which
   // we will analyse the callees and may import further down the callgraph.
   SmallVector<EdgeInfo, 128> Worklist;
@@ -389,8 +371,7 @@ static void ComputeImportForModule(
       continue;
     DEBUG(dbgs() << "Initalize import for " << GVSummary.first << "\n");
     computeImportForFunction(*FuncSummary, Index, ImportInstrLimit,
-                             DefinedGVSummaries, Worklist, ImportList,
-                             ExportLists);
+                             DefinedGVSummaries, Worklist, ImportList);
   }
 
   // Process the newly imported functions and add callees to the worklist.
@@ -400,25 +381,106 @@ static void ComputeImportForModule(
     auto Threshold = FuncInfo.second;
 
     computeImportForFunction(*Summary, Index, Threshold, DefinedGVSummaries,
-                             Worklist, ImportList, ExportLists);
+                             Worklist, ImportList);
   }
 }
 
 } // anonymous namespace
 
+/// Mark as exported from \p ExportModulePath every function in \p GUIDs that
+/// another module imports from it, as well as the globals defined in the same
+/// module that such a function calls or references.
+static void computeExportsForModule(const ModuleSummaryIndex &Index,
+                                    StringRef ExportModulePath,
+                                    ArrayRef<GlobalValue::GUID> GUIDs,
+                                    FunctionImporter::ExportSetTy &ExportList) {
+  for (auto GUID : GUIDs) {
+    ExportList.insert(GUID);
+
+    // Find the summary that was selected for import, which is the one defined
+    // in the exporting module, and resolve aliases to their aliasee.
+    auto SummaryList = Index.findGlobalValueSummaryList(GUID);
+    assert(SummaryList != Index.end() && "Imported GUID without summary");
+    auto SummaryIter = llvm::find_if(
+        SummaryList->second,
+        [&](const std::unique_ptr<GlobalValueSummary> &Summary) {
+          return Summary->modulePath() == ExportModulePath;
+        });
+    assert(SummaryIter != SummaryList->second.end() &&
+           "Imported GUID not defined in its source module");
+    const GlobalValueSummary *Summary = SummaryIter->get();
+    if (auto *AS = dyn_cast<AliasSummary>(Summary))
+      Summary = &AS->getAliasee();
+    auto *ResolvedCalleeSummary = cast<FunctionSummary>(Summary);
+
+    // Mark all functions and globals referenced by this function as exported
+    // to the outside if they are defined in the same source module.
+    for (auto &Edge : ResolvedCalleeSummary->calls()) {
+      auto CalleeGUID = Edge.first.getGUID();
+      exportGlobalInModule(Index, ExportModulePath, CalleeGUID, ExportList);
+    }
+    for (auto &Ref : ResolvedCalleeSummary->refs()) {
+      auto GUID = Ref.getGUID();
+      exportGlobalInModule(Index, ExportModulePath, GUID, ExportList);
+    }
+  }
+}
+
 /// Compute all the import and export for every module using the Index.
 void llvm::ComputeCrossModuleImport(
     const ModuleSummaryIndex &Index,
     const StringMap<GVSummaryMapTy> &ModuleToDefinedGVSummaries,
     StringMap<FunctionImporter::ImportMapTy> &ImportLists,
-    StringMap<FunctionImporter::ExportSetTy> &ExportLists) {
-  // For each module that has function defined, compute the import/export lists.
-  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
-    auto &ImportList = ImportLists[DefinedGVSummaries.first()];
-    DEBUG(dbgs() << "Computing import for Module '"
-                 << DefinedGVSummaries.first() << "'\n");
-    ComputeImportForModule(DefinedGVSummaries.second, Index, ImportList,
-                           &ExportLists);
+    StringMap<FunctionImporter::ExportSetTy> &ExportLists,
+    unsigned ThreadCount) {
+  // Create the import list of every module up front, so that the map is not
+  // modified while the lists are being computed.
+  for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries)
+    ImportLists[DefinedGVSummaries.first()];
+
+  // For each module that has function defined, compute the import list. This
+  // only reads the index, and each module gets its own list, so the modules
+  // are processed in parallel.
+  {
+    ThreadPool Pool(ThreadCount);
+    for (auto &DefinedGVSummaries : ModuleToDefinedGVSummaries) {
+      auto &ImportList = ImportLists[DefinedGVSummaries.first()];
+      Pool.async([&Index, &DefinedGVSummaries, &ImportList]() {
+        DEBUG(dbgs() << "Computing import for Module '"
+                     << DefinedGVSummaries.first() << "'\n");
+        ComputeImportForModule(DefinedGVSummaries.second, Index, ImportList);
+      });
+    }
+  }
+
+  // Invert the import lists: collect, for each source module, the functions
+  // imported from it by any other module.
+  StringMap<std::vector<GlobalValue::GUID>> ImportedFromModule;
+  for (auto &ModuleImports : ImportLists)
+    for (auto &Src : ModuleImports.second) {
+      auto &GUIDs = ImportedFromModule[Src.first()];
+      for (auto &Entry : Src.second)
+        GUIDs.push_back(Entry.first);
+    }
+  for (auto &Exporter : ImportedFromModule) {
+    auto &GUIDs = Exporter.second;
+    std::sort(GUIDs.begin(), GUIDs.end());
+    GUIDs.erase(std::unique(GUIDs.begin(), GUIDs.end()), GUIDs.end());
+  }
+
+  // Compute the export list of each source module, again in parallel. The
+  // result is a set, so it does not depend on the order modules were visited.
+  for (auto &Exporter : ImportedFromModule)
+    ExportLists[Exporter.first()];
+  {
+    ThreadPool Pool(ThreadCount);
+    for (auto &Exporter : ImportedFromModule) {
+      auto &ExportList = ExportLists[Exporter.first()];
+      Pool.async([&Index, &Exporter, &ExportList]() {
+        computeExportsForModule(Index, Exporter.first(), Exporter.second,
+                                ExportList);
+      });
+    }
   }
 
 #ifndef NDEBUG
@@ -0,0 +1,318 @@
+//===- FunctionOrdering.cpp - Profile guided function ordering ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This pass reorders the function definitions of a module to improve
+// instruction cache and TLB locality, using the call-chain clustering (C3)
+// heuristic from "Optimizing Function Placement for Large-Scale Data-Center
+// Applications" (Ottoni and Maher, CGO 2017).
+//
+// Every function starts in its own cluster. Functions are visited in order of
+// decreasing profile count, and each one's cluster is appended to the cluster
+// of its hottest caller, unless the merged cluster would become too large or
+// much less dense. The clusters are finally laid out by decreasing density,
+// followed by the functions without profile data in their original order.
+//
+// The code generator emits functions in module order, so the new order is
+// the layout of the object file. With -function-order-file the order is also
+// written out as a symbol ordering file for the linker, which is needed when
+// functions are placed in their own sections. The file lists the mangled
+// symbol names, with the Darwin '_' prefix where the data layout asks for it.
+//
+// No pass pipeline adds this pass. Run it on profiled IR before code
+// generation, for example:
+//
+//   opt -function-ordering -function-order-file=app.order in.bc -o out.bc
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Transforms/IPO/FunctionOrdering.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/IR/CallSite.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Mangler.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Transforms/IPO.h"
+#include <algorithm>
+using namespace llvm;
+
+#define DEBUG_TYPE "function-ordering"
+
+STATISTIC(NumClusterMerges, "Number of function clusters merged");
+STATISTIC(NumOrderedFunctions, "Number of functions ordered by profile");
+
+static cl::opt<unsigned> MaxClusterSize(
+    "function-order-max-cluster-size", cl::Hidden, cl::init(1 << 18),
+    cl::desc("Maximum number of IR instructions in a cluster of functions"));
+
+static cl::opt<unsigned> MaxDensityDegradation(
+    "function-order-max-density-degradation", cl::Hidden, cl::init(8),
+    cl::desc("Don't merge a cluster into its caller's cluster if that would "
+             "reduce the caller cluster's density by more than this factor"));
+
+static cl::opt<std::string> FunctionOrderFile(
+    "function-order-file", cl::Hidden, cl::value_desc("filename"),
+    cl::desc("Write the computed function order to this file, one symbol per "
+             "line"));
+
+namespace {
+typedef function_ref<BlockFrequencyInfo &(Function &)> BFIGetter;
+
+struct Cluster {
+  SmallVector<unsigned, 4> Members;
+  uint64_t Size = 0;
+  uint64_t Weight = 0;
+
+  double getDensity() const { return double(Weight) / double(Size); }
+};
+
+class FunctionOrderingImpl {
+public:
+  FunctionOrderingImpl(Module &M, BFIGetter GetBFI) : M(M), GetBFI(GetBFI) {}
+  bool run();
+
+private:
+  Module &M;
+  BFIGetter GetBFI;
+
+  /// The function definitions, in module order.
+  std::vector<Function *> Funcs;
+  DenseMap<const Function *, unsigned> FuncIndex;
+
+  /// The cluster each function currently belongs to, identified by the index
+  /// of its first function.
+  std::vector<unsigned> ClusterOf;
+  std::vector<Cluster> Clusters;
+
+  /// The caller with the largest total call count to each function, and that
+  /// count.
+  std::vector<std::pair<unsigned, uint64_t>> HottestCaller;
+
+  void buildCallGraph();
+  bool isNewDensityBad(const Cluster &Pred, const Cluster &Succ) const;
+  void mergeClusters();
+  void writeOrderFile(ArrayRef<Function *> Order) const;
+};
+}
+
+void FunctionOrderingImpl::buildCallGraph() {
+  DenseMap<std::pair<unsigned, unsigned>, uint64_t> EdgeCounts;
+  for (unsigned Caller = 0, E = Funcs.size(); Caller != E; ++Caller) {
+    Function &F = *Funcs[Caller];
+    if (!Clusters[Caller].Weight)
+      continue;
+    BlockFrequencyInfo &BFI = GetBFI(F);
+    for (BasicBlock &BB : F) {
+      Optional<uint64_t> Count;
+      for (Instruction &I : BB) {
+        CallSite CS(&I);
+        if (!CS)
+          continue;
+        auto It = FuncIndex.find(CS.getCalledFunction());
+        if (It == FuncIndex.end() || It->second == Caller)
+          continue;
+        if (!Count)
+          Count = BFI.getBlockProfileCount(&BB);
+        if (Count && *Count)
+          EdgeCounts[std::make_pair(Caller, It->second)] += *Count;
+      }
+    }
+  }
+
+  // Iterate over the edges in a deterministic order so that ties are broken
+  // by the caller's position in the module.
+  std::vector<std::pair<std::pair<unsigned, unsigned>, uint64_t>> Edges(
+      EdgeCounts.begin(), EdgeCounts.end());
+  std::sort(Edges.begin(), Edges.end());
+  for (auto &Edge : Edges) {
+    auto &Best = HottestCaller[Edge.first.second];
+    if (Edge.second > Best.second)
+      Best = std::make_pair(Edge.first.first, Edge.second);
+  }
+}
+
+bool FunctionOrderingImpl::isNewDensityBad(const Cluster &Pred,
+                                           const Cluster &Succ) const {
+  double NewDensity = double(Pred.Weight + Succ.Weight) /
+                      double(Pred.Size + Succ.Size);
+  return Pred.getDensity() > NewDensity * MaxDensityDegradation;
+}
+
+void FunctionOrderingImpl::mergeClusters() {
+  // Visit the functions from hottest to coldest.
+  std::vector<unsigned> Sorted;
+  for (unsigned I = 0, E = Funcs.size(); I != E; ++I)
+    if (Clusters[I].Weight)
+      Sorted.push_back(I);
+  std::stable_sort(Sorted.begin(), Sorted.end(), [&](unsigned A, unsigned B) {
+    return Clusters[A].Weight > Clusters[B].Weight;
+  });
+
+  for (unsigned Callee : Sorted) {
+    if (!HottestCaller[Callee].second)
+      continue;
+    unsigned PredC = ClusterOf[HottestCaller[Callee].first];
+    unsigned SuccC = ClusterOf[Callee];
+    if (PredC == SuccC)
+      continue;
+
+    Cluster &Pred = Clusters[PredC];
+    Cluster &Succ = Clusters[SuccC];
+    if (Pred.Size + Succ.Size > MaxClusterSize)
+      continue;
+    if (isNewDensityBad(Pred, Succ))
+      continue;
+
+    DEBUG(dbgs() << "Appending cluster of " << Funcs[Callee]->getName()
+                 << " to cluster of "
+                 << Funcs[HottestCaller[Callee].first]->getName() << '\n');
+    for (unsigned Member : Succ.Members)
+      ClusterOf[Member] = PredC;
+    Pred.Members.append(Succ.Members.begin(), Succ.Members.end());
+    Pred.Size += Succ.Size;
+    Pred.Weight += Succ.Weight;
+    Succ.Members.clear();
+    Succ.Size = Succ.Weight = 0;
+    ++NumClusterMerges;
+  }
+}
+
+void FunctionOrderingImpl::writeOrderFile(ArrayRef<Function *> Order) const {
+  std::error_code EC;
+  raw_fd_ostream OS(FunctionOrderFile, EC, sys::fs::F_Text);
+  if (EC) {
+    M.getContext().emitError("could not open function order file '" +
+                             FunctionOrderFile + "': " + EC.message());
+    return;
+  }
+  Mangler Mang;
+  for (Function *F : Order) {
+    if (!Clusters[ClusterOf[FuncIndex.lookup(F)]].Weight)
+      continue;
+    // Private functions get assembler-local labels, which never reach the
+    // linker's symbol table.
+    if (F->hasPrivateLinkage())
+      continue;
+    Mang.getNameWithPrefix(OS, F, /*CannotUsePrivateLabel=*/true);
+    OS << '\n';
+  }
+}
+
+bool FunctionOrderingImpl::run() {
+  for (Function &F : M) {
+    if (F.isDeclaration())
+      continue;
+    FuncIndex[&F] = Funcs.size();
+    Funcs.push_back(&F);
+  }
+
+  ClusterOf.resize(Funcs.size());
+  Clusters.resize(Funcs.size());
+  HottestCaller.resize(Funcs.size());
+  bool HasProfile = false;
+  for (unsigned I = 0, E = Funcs.size(); I != E; ++I) {
+    Function &F = *Funcs[I];
+    ClusterOf[I] = I;
+    Cluster &C = Clusters[I];
+    C.Members.push_back(I);
+    for (BasicBlock &BB : F)
+      C.Size += BB.size();
+    if (Optional<uint64_t> Count = F.getEntryCount())
+      C.Weight = *Count;
+    HasProfile |= C.Weight != 0;
+  }
+  if (!HasProfile)
+    return false;
+
+  buildCallGraph();
+  mergeClusters();
+
+  // Lay out the clusters by decreasing density, and put the functions that
+  // were never executed at the end in their original order.
+  std::vector<unsigned> Order;
+  for (unsigned I = 0, E = Funcs.size(); I != E; ++I)
+    if (ClusterOf[I] == I && Clusters[I].Weight)
+      Order.push_back(I);
+  std::stable_sort(Order.begin(), Order.end(), [&](unsigned A, unsigned B) {
+    return Clusters[A].getDensity() > Clusters[B].getDensity();
+  });
+
+  std::vector<Function *> NewOrder;
+  for (unsigned C : Order)
+    for (unsigned Member : Clusters[C].Members)
+      NewOrder.push_back(Funcs[Member]);
+  NumOrderedFunctions += NewOrder.size();
+  for (unsigned I = 0, E = Funcs.size(); I != E; ++I)
+    if (!Clusters[ClusterOf[I]].Weight)
+      NewOrder.push_back(Funcs[I]);
+
+  if (!FunctionOrderFile.empty())
+    writeOrderFile(NewOrder);
+
+  if (std::equal(NewOrder.begin(), NewOrder.end(), Funcs.begin()))
+    return false;
+
+  // Move the definitions to the end of the function list in their new order.
+  // Declarations are left where they are.
+  Module::FunctionListType &List = M.getFunctionList();
+  for (Function *F : NewOrder)
+    List.splice(List.end(), List, F->getIterator());
+  return true;
+}
+
+namespace {
+struct FunctionOrderingLegacyPass : public ModulePass {
+  static char ID; // Pass identification, replacement for typeid
+  FunctionOrderingLegacyPass() : ModulePass(ID) {
+    initializeFunctionOrderingLegacyPassPass(*PassRegistry::getPassRegistry());
+  }
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.addRequired<BlockFrequencyInfoWrapperPass>();
+    AU.setPreservesCFG();
+  }
+
+  bool runOnModule(Module &M) override {
+    if (skipModule(M))
+      return false;
+
+    auto GetBFI = [this](Function &F) -> BlockFrequencyInfo & {
+      return this->getAnalysis<BlockFrequencyInfoWrapperPass>(F).getBFI();
+    };
+    return FunctionOrderingImpl(M, GetBFI).run();
+  }
+};
+}
+
+char FunctionOrderingLegacyPass::ID = 0;
+INITIALIZE_PASS_BEGIN(FunctionOrderingLegacyPass, "function-ordering",
+                      "Profile Guided Function Ordering", false, false)
+INITIALIZE_PASS_DEPENDENCY(BlockFrequencyInfoWrapperPass)
+INITIALIZE_PASS_END(FunctionOrderingLegacyPass, "function-ordering",
+                    "Profile Guided Function Ordering", false, false)
+
+ModulePass *llvm::createFunctionOrderingPass() {
+  return new FunctionOrderingLegacyPass();
+}
+
+PreservedAnalyses FunctionOrderingPass::run(Module &M,
+                                            ModuleAnalysisManager &AM) {
+  auto &FAM = AM.getResult<FunctionAnalysisManagerModuleProxy>(M).getManager();
+  auto GetBFI = [&FAM](Function &F) -> BlockFrequencyInfo & {
+    return FAM.getResult<BlockFrequencyAnalysis>(F);
+  };
+  if (FunctionOrderingImpl(M, GetBFI).run())
+    return PreservedAnalyses::none();
+  return PreservedAnalyses::all();
+}
@@ -56,6 +56,7 @@ void llvm::initializeIPO(PassRegistry &Registry) {
   initializeEliminateAvailableExternallyLegacyPassPass(Registry);
   initializeSampleProfileLoaderLegacyPassPass(Registry);
   initializeFunctionImportLegacyPassPass(Registry);
+  initializeFunctionOrderingLegacyPassPass(Registry);
   initializeWholeProgramDevirtPass(Registry);
 }
 
@@ -251,7 +251,7 @@ namespace {
     void EmitPreheaderBranchOnCondition(Value *LIC, Constant *Val,
                                         BasicBlock *TrueDest,
                                         BasicBlock *FalseDest,
-                                        Instruction *InsertPt,
+                                        BranchInst *OldBranch,
                                         TerminatorInst *TI);
 
     void SimplifyCode(std::vector<Instruction*> &Worklist, Loop *L);
@@ -477,9 +477,6 @@ bool LoopUnswitch::runOnLoop(Loop *L, LPPassManager &LPM_Ref) {
     Changed |= processCurrentLoop();
   } while(redoLoop);
 
-  // FIXME: Reconstruct dom info, because it is not preserved properly.
-  if (Changed)
-    DT->recalculate(*F);
   return Changed;
 }
 
@@ -778,19 +775,22 @@ static Loop *CloneLoop(Loop *L, Loop *PL, ValueToValueMapTy &VM,
 }
 
 /// Emit a conditional branch on two values if LIC == Val, branch to TrueDst,
-/// otherwise branch to FalseDest. Insert the code immediately before InsertPt.
+/// otherwise branch to FalseDest. The new branch replaces the unconditional
+/// OldBranch, which is removed from its block but not deleted.
 void LoopUnswitch::EmitPreheaderBranchOnCondition(Value *LIC, Constant *Val,
                                                   BasicBlock *TrueDest,
                                                   BasicBlock *FalseDest,
-                                                  Instruction *InsertPt,
+                                                  BranchInst *OldBranch,
                                                   TerminatorInst *TI) {
+  assert(OldBranch->isUnconditional() && "Preheader is not split correctly");
+
   // Insert a conditional branch on LIC to the two preheaders.  The original
   // code is the true version and the new code is the false version.
   Value *BranchVal = LIC;
   bool Swapped = false;
   if (!isa<ConstantInt>(Val) ||
       Val->getType() != Type::getInt1Ty(LIC->getContext()))
-    BranchVal = new ICmpInst(InsertPt, ICmpInst::ICMP_EQ, LIC, Val);
+    BranchVal = new ICmpInst(OldBranch, ICmpInst::ICMP_EQ, LIC, Val);
   else if (Val != ConstantInt::getTrue(Val->getContext())) {
     // We want to enter the new loop when the condition is true.
     std::swap(TrueDest, FalseDest);
@@ -799,10 +799,31 @@ void LoopUnswitch::EmitPreheaderBranchOnCondition(Value *LIC, Constant *Val,
 
   // Insert the new branch.
   BranchInst *BI =
-      IRBuilder<>(InsertPt).CreateCondBr(BranchVal, TrueDest, FalseDest, TI);
+      IRBuilder<>(OldBranch).CreateCondBr(BranchVal, TrueDest, FalseDest, TI);
   if (Swapped)
     BI->swapProfMetadata();
 
+  // Remove the old branch, so that the block has a single terminator again,
+  // and tell the dominator tree about the edges that changed.
+  BasicBlock *OldBranchParent = OldBranch->getParent();
+  BasicBlock *OldBranchSucc = OldBranch->getSuccessor(0);
+  OldBranch->removeFromParent();
+
+  SmallVector<DominatorTree::UpdateType, 3> Updates;
+  if (TrueDest != OldBranchSucc)
+    Updates.push_back(
+        {DominatorTree::UpdateKind::Insert, OldBranchParent, TrueDest});
+  if (FalseDest != OldBranchSucc)
+    Updates.push_back(
+        {DominatorTree::UpdateKind::Insert, OldBranchParent, FalseDest});
+  if (TrueDest != OldBranchSucc && FalseDest != OldBranchSucc)
+    Updates.push_back(
+        {DominatorTree::UpdateKind::Delete, OldBranchParent, OldBranchSucc});
+  DT->applyUpdates(Updates);
+  // Critical edge splitting updates the tree in place after changing the
+  // CFG, so the edge updates have to be applied first.
+  DT->flush();
+
   // If either edge is critical, split it. This helps preserve LoopSimplify
   // form for enclosing loops.
   auto Options = CriticalEdgeSplittingOptions(DT, LI).setPreserveLCSSA();
@@ -842,10 +863,10 @@ void LoopUnswitch::UnswitchTrivialCondition(Loop *L, Value *Cond, Constant *Val,
 
   // Okay, now we have a position to branch from and a position to branch to,
   // insert the new conditional branch.
-  EmitPreheaderBranchOnCondition(Cond, Val, NewExit, NewPH,
-                                 loopPreheader->getTerminator(), TI);
-  LPM->deleteSimpleAnalysisValue(loopPreheader->getTerminator(), L);
-  loopPreheader->getTerminator()->eraseFromParent();
+  BranchInst *OldBranch = cast<BranchInst>(loopPreheader->getTerminator());
+  EmitPreheaderBranchOnCondition(Cond, Val, NewExit, NewPH, OldBranch, TI);
+  LPM->deleteSimpleAnalysisValue(OldBranch, L);
+  delete OldBranch;
 
   // We need to reprocess this loop, it could be unswitched again.
   redoLoop = true;
@@ -1147,7 +1168,7 @@ void LoopUnswitch::UnswitchNontrivialCondition(Value *LIC, Constant *Val,
   EmitPreheaderBranchOnCondition(LIC, Val, NewBlocks[0], LoopBlocks[0], OldBR,
                                  TI);
   LPM->deleteSimpleAnalysisValue(OldBR, L);
-  OldBR->eraseFromParent();
+  delete OldBR;
 
   LoopProcessWorklist.push_back(NewLoop);
   redoLoop = true;
@@ -1308,10 +1329,7 @@ void LoopUnswitch::RewriteLoopBodyWithConditionConstant(Loop *L, Value *LIC,
          PHINode *PN = dyn_cast<PHINode>(II); ++II)
       PN->setIncomingValue(PN->getBasicBlockIndex(Switch),
                            UndefValue::get(PN->getType()));
-    // Tell the domtree about the new block. We don't fully update the
-    // domtree here -- instead we force it to do a full recomputation
-    // after the pass is complete -- but we do need to inform it of
-    // new blocks.
+    // The only edge to the new block comes from NewSISucc.
     DT->addNewBlock(Abort, NewSISucc);
   }
 
@@ -1385,6 +1403,17 @@ void LoopUnswitch::SimplifyCode(std::vector<Instruction*> &Worklist, Loop *L) {
         BI->eraseFromParent();
         RemoveFromWorklist(BI, Worklist);
 
+        // Succ was dominated by Pred alone, so its children in the dominator
+        // tree now hang off Pred.
+        if (DomTreeNode *SuccNode = DT->getNode(Succ)) {
+          DomTreeNode *PredNode = DT->getNode(Pred);
+          SmallVector<DomTreeNode *, 8> Children(SuccNode->begin(),
+                                                 SuccNode->end());
+          for (DomTreeNode *Child : Children)
+            DT->changeImmediateDominator(Child, PredNode);
+          DT->eraseNode(Succ);
+        }
+
         // Remove Succ from the loop tree.
         LI->removeBlock(Succ);
         LPM->deleteSimpleAnalysisValue(Succ, L);
@@ -0,0 +1,39 @@
+; The 64-bit register pairs here are accessed through their 32-bit halves,
+; so the intervals carry subranges. Both the main ranges and the subranges
+; that are updated in place must match a full recompute.
+; REQUIRES: asserts
+; RUN: llc -march=hexagon -verify-live-intervals -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -march=hexagon -verify-live-intervals -regalloc=basic < %s | FileCheck %s
+
+; CHECK-LABEL: swap_sum:
+; CHECK: jumpr r31
+define i64 @swap_sum(i64* %p, i32 %n) {
+entry:
+  %empty = icmp eq i32 %n, 0
+  br i1 %empty, label %exit, label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %addr = getelementptr i64, i64* %p, i32 %i
+  %v = load i64, i64* %addr
+  %lo = trunc i64 %v to i32
+  %hi.wide = lshr i64 %v, 32
+  %hi = trunc i64 %hi.wide to i32
+  %lo.wide = zext i32 %lo to i64
+  %lo.shl = shl i64 %lo.wide, 32
+  %hi.ext = zext i32 %hi to i64
+  %swapped = or i64 %lo.shl, %hi.ext
+  %acc.lo = trunc i64 %acc to i32
+  %mix = add i32 %acc.lo, %hi
+  %mix.wide = zext i32 %mix to i64
+  %acc.1 = add i64 %swapped, %mix.wide
+  %acc.next = xor i64 %acc.1, %acc
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i64 %r
+}
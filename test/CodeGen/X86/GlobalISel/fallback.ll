@@ -0,0 +1,42 @@
+; RUN: llc -mtriple x86_64-linux-gnu -global-isel -global-isel-abort=2 %s -o %t.out 2> %t.err
+; RUN: FileCheck %s --check-prefix=FALLBACK-WITH-REPORT-OUT < %t.out
+; RUN: FileCheck %s --check-prefix=FALLBACK-WITH-REPORT-ERR < %t.err
+
+; Floating point isn't handled by GlobalISel yet and must fall back to
+; SelectionDAG.
+; FALLBACK-WITH-REPORT-ERR: warning: Instruction selection used fallback path for test_fadd
+; FALLBACK-WITH-REPORT-OUT-LABEL: test_fadd:
+; FALLBACK-WITH-REPORT-OUT: addss
+define float @test_fadd(float %a, float %b) {
+  %r = fadd float %a, %b
+  ret float %r
+}
+
+; Variadic calls need AL to hold the number of vector arguments, which isn't
+; set up yet.
+; FALLBACK-WITH-REPORT-ERR: warning: Instruction selection used fallback path for test_vararg_call
+; FALLBACK-WITH-REPORT-OUT-LABEL: test_vararg_call:
+; FALLBACK-WITH-REPORT-OUT: xorl %eax, %eax
+; FALLBACK-WITH-REPORT-OUT: callq printf
+declare i32 @printf(i8*, ...)
+define i32 @test_vararg_call(i8* %fmt, i32 %a) {
+  %r = call i32 (i8*, ...) @printf(i8* %fmt, i32 %a)
+  ret i32 %r
+}
+
+; Integer code that fits a register is selected.
+; FALLBACK-WITH-REPORT-ERR-NOT: fallback path for test_i8_arg
+; FALLBACK-WITH-REPORT-ERR-NOT: fallback path for test_icmp_br
+define i8 @test_i8_arg(i8 %a) {
+  ret i8 %a
+}
+
+define i32 @test_icmp_br(i32 %a, i32 %b) {
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %else
+then:
+  ret i32 %a
+else:
+  ret i32 %b
+}
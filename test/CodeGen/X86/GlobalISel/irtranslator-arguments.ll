@@ -0,0 +1,30 @@
+; RUN: llc -mtriple x86_64-linux-gnu -global-isel -stop-after=irtranslator %s -o - | FileCheck %s
+
+define i32 @test_i32_args(i32 %a, i32 %b) {
+; CHECK-LABEL: name: test_i32_args
+; CHECK: liveins: %edi, %esi
+; CHECK-DAG: [[A:%[0-9]+]](s32) = COPY %edi
+; CHECK-DAG: [[B:%[0-9]+]](s32) = COPY %esi
+; CHECK: %eax = COPY [[B]](s32)
+; CHECK-NEXT: RET 0, implicit %eax
+  ret i32 %b
+}
+
+define i64 @test_i64_args(i64 %a, i64 %b) {
+; CHECK-LABEL: name: test_i64_args
+; CHECK: liveins: %rdi, %rsi
+; CHECK-DAG: [[A:%[0-9]+]](s64) = COPY %rdi
+; CHECK-DAG: [[B:%[0-9]+]](s64) = COPY %rsi
+; CHECK: %rax = COPY [[A]](s64)
+; CHECK-NEXT: RET 0, implicit %rax
+  ret i64 %a
+}
+
+define i32* @test_ptr_arg(i32* %p) {
+; CHECK-LABEL: name: test_ptr_arg
+; CHECK: liveins: %rdi
+; CHECK: [[P:%[0-9]+]](p0) = COPY %rdi
+; CHECK: %rax = COPY [[P]](p0)
+; CHECK-NEXT: RET 0, implicit %rax
+  ret i32* %p
+}
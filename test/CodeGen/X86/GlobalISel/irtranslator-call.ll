@@ -1,5 +1,5 @@
-; RUN: llc -mtriple i386 -global-isel -stop-after=irtranslator %s -o - | FileCheck %s
-; RUN: llc -mtriple x86_64 -global-isel -stop-after=irtranslator %s -o - | FileCheck %s
+; RUN: llc -mtriple i386 -global-isel -stop-after=irtranslator %s -o - | FileCheck %s --check-prefix=CHECK --check-prefix=X32
+; RUN: llc -mtriple x86_64 -global-isel -stop-after=irtranslator %s -o - | FileCheck %s --check-prefix=CHECK --check-prefix=X64
 
 define void @test_void_return() {
 ; CHECK-LABEL: name:            test_void_return
@@ -31,3 +31,36 @@ define void @test_void_return() {
 entry:
   ret void
 }
+
+; The call frame is sized for the arguments that are passed on the stack, and
+; narrow arguments are extended as their attributes say.
+declare i32 @callee(i32, i8 zeroext, i32, i32, i32, i32, i32)
+define i32 @test_direct_call(i32 %x, i8 %y) {
+; CHECK-LABEL: name: test_direct_call
+; X64: [[X:%[0-9]+]](s32) = COPY %edi
+; X64: [[Y:%[0-9]+]](s8) = G_TRUNC
+; X64: [[FIVE:%[0-9]+]](s32) = G_CONSTANT i32 5
+; X64: ADJCALLSTACKDOWN64 16, 0
+; X64-NEXT: %edi = COPY [[X]](s32)
+; X64-NEXT: [[YEXT:%[0-9]+]](s32) = G_ZEXT [[Y]](s8)
+; X64-NEXT: %esi = COPY [[YEXT]](s32)
+; X64: %r9d = COPY
+; X64-NEXT: [[SP:%[0-9]+]](p0) = COPY %rsp
+; X64-NEXT: [[OFF:%[0-9]+]](s64) = G_CONSTANT i64 0
+; X64-NEXT: [[ADDR:%[0-9]+]](p0) = G_GEP [[SP]], [[OFF]](s64)
+; X64-NEXT: G_STORE [[FIVE]](s32), [[ADDR]](p0) :: (store 4 into stack
+; X64-NEXT: CALL64pcrel32 @callee, csr_64, implicit %rsp, implicit %edi, implicit %esi, implicit %edx, implicit %ecx, implicit %r8d, implicit %r9d, implicit-def %eax
+; X64-NEXT: ADJCALLSTACKUP64 16, 0
+; X64-NEXT: [[R:%[0-9]+]](s32) = COPY %eax
+; X64-NEXT: %eax = COPY [[R]](s32)
+
+; X32: ADJCALLSTACKDOWN32 28, 0
+; X32: [[YEXT:%[0-9]+]](s32) = G_ZEXT
+; X32-NEXT: G_STORE [[YEXT]](s32), {{%[0-9]+}}(p0) :: (store 4 into stack + 4
+; X32: G_STORE {{%[0-9]+}}(s32), {{%[0-9]+}}(p0) :: (store 4 into stack + 24
+; X32-NEXT: CALLpcrel32 @callee, csr_32, implicit %esp, implicit-def %eax
+; X32-NEXT: ADJCALLSTACKUP32 28, 0
+entry:
+  %r = call i32 @callee(i32 %x, i8 zeroext %y, i32 1, i32 2, i32 3, i32 4, i32 5)
+  ret i32 %r
+}
@@ -0,0 +1,85 @@
+; RUN: llc -mtriple x86_64-linux-gnu -global-isel -global-isel-abort=1 -verify-machineinstrs %s -o - | FileCheck %s
+
+define i64 @test_add_i64(i64 %a, i64 %b) {
+; CHECK-LABEL: test_add_i64:
+; CHECK: addq
+; CHECK: retq
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i32 @test_sub_i32(i32 %a, i32 %b) {
+; CHECK-LABEL: test_sub_i32:
+; CHECK: subl
+; CHECK: retq
+  %r = sub i32 %a, %b
+  ret i32 %r
+}
+
+define i32 @test_and_or_xor_i32(i32 %a, i32 %b) {
+; CHECK-LABEL: test_and_or_xor_i32:
+; CHECK: andl
+; CHECK: orl
+; CHECK: xorl
+; CHECK: retq
+  %x = and i32 %a, %b
+  %y = or i32 %x, %b
+  %z = xor i32 %y, %a
+  ret i32 %z
+}
+
+define i64 @test_const_i64() {
+; CHECK-LABEL: test_const_i64:
+; CHECK: movabsq $4294967296, %rax
+; CHECK: retq
+  ret i64 4294967296
+}
+
+define i32 @test_load_store(i32* %p, i32* %q) {
+; CHECK-LABEL: test_load_store:
+; CHECK: movl (%rdi), [[R:%[a-z]+]]
+; CHECK: movl [[R]], (%rsi)
+; CHECK: retq
+  %v = load i32, i32* %p
+  store i32 %v, i32* %q
+  ret i32 %v
+}
+
+define i32 @test_mul_i32(i32 %a, i32 %b) {
+; CHECK-LABEL: test_mul_i32:
+; CHECK: imull %esi, %edi
+; CHECK: retq
+  %r = mul i32 %a, %b
+  ret i32 %r
+}
+
+; There is no two-operand 8-bit multiply, so it is done in 16 bits.
+define i8 @test_mul_i8(i8 %a, i8 %b) {
+; CHECK-LABEL: test_mul_i8:
+; CHECK: imulw
+; CHECK: retq
+  %r = mul i8 %a, %b
+  ret i8 %r
+}
+
+define i32* @test_gep(i32* %p, i64 %i) {
+; CHECK-LABEL: test_gep:
+; CHECK: imulq %rsi, [[OFF:%[a-z]+]]
+; CHECK: leaq (%rdi,[[OFF]]), %rax
+; CHECK: retq
+  %q = getelementptr i32, i32* %p, i64 %i
+  ret i32* %q
+}
+
+; The address of a stack object is folded into the memory operand.
+define i32 @test_alloca(i32 %a) {
+; CHECK-LABEL: test_alloca:
+; CHECK-NOT: leaq
+; CHECK: movl %edi, [[SLOT:-?[0-9]+]](%rsp)
+; CHECK-NEXT: movl [[SLOT]](%rsp), %eax
+; CHECK-NEXT: retq
+  %p = alloca i32
+  store i32 %a, i32* %p
+  %v = load i32, i32* %p
+  ret i32 %v
+}
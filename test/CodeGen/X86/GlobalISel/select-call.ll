@@ -0,0 +1,42 @@
+; RUN: llc -mtriple x86_64-linux-gnu -global-isel -global-isel-abort=1 -verify-machineinstrs %s -o - | FileCheck %s
+; RUN: llc -mtriple x86_64-linux-gnu -relocation-model=pic -global-isel -global-isel-abort=1 -verify-machineinstrs %s -o - | FileCheck %s --check-prefix=PIC
+
+declare i32 @callee(i32, i8 zeroext, i16 signext, i64, i32*, i32, i32, i8 zeroext)
+declare void @sink(i32)
+
+; The last two arguments go on the stack, extended to 32 bits.
+define i32 @test_call(i32 %x, i32* %p) {
+; CHECK-LABEL: test_call:
+; CHECK: subq $24, %rsp
+; CHECK-DAG: movzbl {{%[a-z]+}}, %esi
+; CHECK-DAG: movswl {{%[a-z]+}}, %edx
+; CHECK-DAG: movq $5, %rcx
+; CHECK-DAG: movl $6, %r9d
+; CHECK-DAG: movl {{%[a-z0-9]+}}, (%rcx)
+; CHECK-DAG: movl {{%[a-z]+}}, (%rcx)
+; CHECK-DAG: movq {{%[a-z0-9]+}}, %r8
+; CHECK: callq callee
+; CHECK-NEXT: addq $24, %rsp
+; CHECK-NEXT: retq
+; PIC-LABEL: test_call:
+; PIC: callq callee@PLT
+  %r = call i32 @callee(i32 %x, i8 zeroext 1, i16 signext -1, i64 5, i32* %p, i32 6, i32 7, i8 zeroext 9)
+  ret i32 %r
+}
+
+define void @test_void_call(i32 %x) {
+; CHECK-LABEL: test_void_call:
+; CHECK: callq sink
+; CHECK: retq
+  call void @sink(i32 %x)
+  ret void
+}
+
+define i32 @test_indirect_call(i32 (i32)* %f) {
+; CHECK-LABEL: test_indirect_call:
+; CHECK: movq %rdi, [[F:%[a-z]+]]
+; CHECK-NEXT: movl $3, %edi
+; CHECK-NEXT: callq *[[F]]
+  %r = call i32 %f(i32 3)
+  ret i32 %r
+}
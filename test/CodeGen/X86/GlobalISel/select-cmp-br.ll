@@ -0,0 +1,53 @@
+; RUN: llc -mtriple x86_64-linux-gnu -global-isel -global-isel-abort=1 -verify-machineinstrs %s -o - | FileCheck %s
+
+define i32 @test_icmp_br(i32 %a, i32 %b) {
+; CHECK-LABEL: test_icmp_br:
+; CHECK: cmpl %esi, %edi
+; CHECK-NEXT: setl [[C:%[a-z]+]]
+; CHECK-NEXT: testb $1, [[C]]
+; CHECK-NEXT: je
+; CHECK: retq
+entry:
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %then, label %else
+then:
+  ret i32 %a
+else:
+  ret i32 %b
+}
+
+define i8 @test_icmp_ult_i64(i64 %a, i64 %b) {
+; CHECK-LABEL: test_icmp_ult_i64:
+; CHECK: cmpq %rsi, %rdi
+; CHECK-NEXT: setb %al
+; CHECK-NEXT: andb $1, %al
+; CHECK-NEXT: retq
+  %c = icmp ult i64 %a, %b
+  %r = zext i1 %c to i8
+  ret i8 %r
+}
+
+define i32 @test_icmp_ptr(i32* %p, i32* %q) {
+; CHECK-LABEL: test_icmp_ptr:
+; CHECK: cmpq %rsi, %rdi
+; CHECK-NEXT: sete %al
+; CHECK-NEXT: andb $1, %al
+; CHECK-NEXT: movzbl %al, %eax
+; CHECK-NEXT: retq
+  %c = icmp eq i32* %p, %q
+  %r = zext i1 %c to i32
+  ret i32 %r
+}
+
+define i32 @test_icmp_i8_sge(i8 %a, i8 %b) {
+; CHECK-LABEL: test_icmp_i8_sge:
+; CHECK: cmpb %sil, %dil
+; CHECK-NEXT: setge %al
+; CHECK-NEXT: andb $1, %al
+; CHECK-NEXT: negb %al
+; CHECK-NEXT: movsbl %al, %eax
+; CHECK-NEXT: retq
+  %c = icmp sge i8 %a, %b
+  %r = sext i1 %c to i32
+  ret i32 %r
+}
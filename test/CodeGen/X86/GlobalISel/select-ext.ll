@@ -0,0 +1,67 @@
+; RUN: llc -mtriple x86_64-linux-gnu -global-isel -global-isel-abort=1 -verify-machineinstrs %s -o - | FileCheck %s
+
+define i32 @test_zext_i8(i8 %a) {
+; CHECK-LABEL: test_zext_i8:
+; CHECK: movzbl %dil, %eax
+; CHECK-NEXT: retq
+  %r = zext i8 %a to i32
+  ret i32 %r
+}
+
+; Writing the 32-bit register clears the upper half.
+define i64 @test_zext_i16_i64(i16 %a) {
+; CHECK-LABEL: test_zext_i16_i64:
+; CHECK: movzwl %di, %eax
+; CHECK-NEXT: retq
+  %r = zext i16 %a to i64
+  ret i64 %r
+}
+
+define i64 @test_zext_i32_i64(i32 %a) {
+; CHECK-LABEL: test_zext_i32_i64:
+; CHECK: movl %edi, %eax
+; CHECK-NEXT: retq
+  %r = zext i32 %a to i64
+  ret i64 %r
+}
+
+define i64 @test_sext_i8_i64(i8 %a) {
+; CHECK-LABEL: test_sext_i8_i64:
+; CHECK: movsbq %dil, %rax
+; CHECK-NEXT: retq
+  %r = sext i8 %a to i64
+  ret i64 %r
+}
+
+define i32 @test_sext_i16(i16 %a) {
+; CHECK-LABEL: test_sext_i16:
+; CHECK: movswl %di, %eax
+; CHECK-NEXT: retq
+  %r = sext i16 %a to i32
+  ret i32 %r
+}
+
+define i64 @test_sext_i32_i64(i32 %a) {
+; CHECK-LABEL: test_sext_i32_i64:
+; CHECK: movslq %edi, %rax
+; CHECK-NEXT: retq
+  %r = sext i32 %a to i64
+  ret i64 %r
+}
+
+; Truncations are subregister copies.
+define i16 @test_trunc_i64_i16(i64 %a) {
+; CHECK-LABEL: test_trunc_i64_i16:
+; CHECK: movl %edi, %eax
+; CHECK-NEXT: retq
+  %r = trunc i64 %a to i16
+  ret i16 %r
+}
+
+define i8 @test_trunc_i32_i8(i32 %a) {
+; CHECK-LABEL: test_trunc_i32_i8:
+; CHECK: movl %edi, %eax
+; CHECK-NEXT: retq
+  %r = trunc i32 %a to i8
+  ret i8 %r
+}
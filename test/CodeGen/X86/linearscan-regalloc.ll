@@ -0,0 +1,169 @@
+; RUN: llc -mtriple=x86_64-linux-gnu -regalloc=linearscan -verify-machineinstrs < %s | FileCheck %s
+
+; The linear scan allocator never splits a live range and never requeues an
+; evicted one: it either spills the cheapest interferences or the interval
+; itself. The checks below look at where spills and reloads end up rather
+; than at how many there are.
+
+define i32 @add(i32 %a, i32 %b) {
+; CHECK-LABEL: add:
+; CHECK: leal (%rdi,%rsi), %eax
+; CHECK-NEXT: retq
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+; The cold values loaded in the entry block are only used after the loop, so
+; they are cheaper to spill than the values live in the loop. When the loop
+; values run out of registers, the allocator spills cold values to make room
+; for them instead of spilling the loop values themselves.
+; CHECK-LABEL: evict:
+; CHECK: movl 40(%rdi), [[C0:%e[a-z0-9]+|%r[0-9]+d]]
+; CHECK-NEXT: movl [[C0]], [[S0:-[0-9]+]](%rsp) # 4-byte Spill
+; CHECK-NEXT: movl 44(%rdi), [[C1:%e[a-z0-9]+|%r[0-9]+d]]
+; CHECK-NEXT: movl [[C1]], [[S1:-[0-9]+]](%rsp) # 4-byte Spill
+; CHECK-NEXT: movl 48(%rdi), [[C2:%e[a-z0-9]+|%r[0-9]+d]]
+; CHECK-NEXT: movl [[C2]], [[S2:-[0-9]+]](%rsp) # 4-byte Spill
+; CHECK: # %loop
+; CHECK-NOT: Spill
+; CHECK-NOT: Reload
+; CHECK: jl
+; CHECK: xorl [[S0]](%rsp), {{%e[a-z0-9]+}} # 4-byte Folded Reload
+; CHECK-NEXT: xorl [[S1]](%rsp), {{%e[a-z0-9]+}} # 4-byte Folded Reload
+; CHECK-NEXT: xorl [[S2]](%rsp), {{%e[a-z0-9]+}} # 4-byte Folded Reload
+; CHECK: retq
+define i32 @evict(i32* %p, i32* %q, i32 %n) {
+entry:
+  %c0.ptr = getelementptr i32, i32* %p, i32 0
+  %c0 = load volatile i32, i32* %c0.ptr
+  %c1.ptr = getelementptr i32, i32* %p, i32 1
+  %c1 = load volatile i32, i32* %c1.ptr
+  %c2.ptr = getelementptr i32, i32* %p, i32 2
+  %c2 = load volatile i32, i32* %c2.ptr
+  %c3.ptr = getelementptr i32, i32* %p, i32 3
+  %c3 = load volatile i32, i32* %c3.ptr
+  %c4.ptr = getelementptr i32, i32* %p, i32 4
+  %c4 = load volatile i32, i32* %c4.ptr
+  %c5.ptr = getelementptr i32, i32* %p, i32 5
+  %c5 = load volatile i32, i32* %c5.ptr
+  %c6.ptr = getelementptr i32, i32* %p, i32 6
+  %c6 = load volatile i32, i32* %c6.ptr
+  %c7.ptr = getelementptr i32, i32* %p, i32 7
+  %c7 = load volatile i32, i32* %c7.ptr
+  %c8.ptr = getelementptr i32, i32* %p, i32 8
+  %c8 = load volatile i32, i32* %c8.ptr
+  %c9.ptr = getelementptr i32, i32* %p, i32 9
+  %c9 = load volatile i32, i32* %c9.ptr
+  %c10.ptr = getelementptr i32, i32* %p, i32 10
+  %c10 = load volatile i32, i32* %c10.ptr
+  %c11.ptr = getelementptr i32, i32* %p, i32 11
+  %c11 = load volatile i32, i32* %c11.ptr
+  %c12.ptr = getelementptr i32, i32* %p, i32 12
+  %c12 = load volatile i32, i32* %c12.ptr
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 1, %entry ], [ %acc.next, %loop ]
+  %x.ptr = getelementptr i32, i32* %q, i32 %i
+  %x = load i32, i32* %x.ptr
+  %m = mul i32 %acc, %x
+  %acc.next = add i32 %m, %i
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %t0 = xor i32 %acc.next, %c0
+  %t1 = xor i32 %t0, %c1
+  %t2 = xor i32 %t1, %c2
+  %t3 = xor i32 %t2, %c3
+  %t4 = xor i32 %t3, %c4
+  %t5 = xor i32 %t4, %c5
+  %t6 = xor i32 %t5, %c6
+  %t7 = xor i32 %t6, %c7
+  %t8 = xor i32 %t7, %c8
+  %t9 = xor i32 %t8, %c9
+  %t10 = xor i32 %t9, %c10
+  %t11 = xor i32 %t10, %c11
+  %t12 = xor i32 %t11, %c12
+  ret i32 %t12
+}
+
+; %v is used in the entry block and after a loop where every register is
+; taken. A splitting allocator keeps %v in a register in the entry block and
+; only spills it around the loop. Linear scan spills the whole live range, so
+; even the uses right after the definition reload it from its stack slot.
+; CHECK-LABEL: nosplit:
+; CHECK: movl (%rdi), [[V:%e[a-z0-9]+]]
+; CHECK-NEXT: movl [[V]], [[SLOT:-[0-9]+]](%rsp) # 4-byte Spill
+; CHECK-NEXT: movl [[SLOT]](%rsp), [[R:%e[a-z0-9]+]] # 4-byte Reload
+; CHECK-NEXT: imull [[R]], [[R]]
+; CHECK-NEXT: imull [[SLOT]](%rsp), [[R]] # 4-byte Folded Reload
+; CHECK: # %exit
+; CHECK: imull [[SLOT]](%rsp), [[E:%e[a-z0-9]+]] # 4-byte Folded Reload
+; CHECK-NEXT: addl [[SLOT]](%rsp), [[E]] # 4-byte Folded Reload
+; CHECK: retq
+define i32 @nosplit(i32* %p, i32* %q, i32 %n) {
+entry:
+  %v = load volatile i32, i32* %p
+  %v.sq = mul i32 %v, %v
+  %v.cu = mul i32 %v.sq, %v
+  store volatile i32 %v.cu, i32* %p
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 1, %entry ], [ %acc.next, %loop ]
+  %c0.ptr = getelementptr i32, i32* %q, i32 0
+  %c0 = load volatile i32, i32* %c0.ptr
+  %c1.ptr = getelementptr i32, i32* %q, i32 1
+  %c1 = load volatile i32, i32* %c1.ptr
+  %c2.ptr = getelementptr i32, i32* %q, i32 2
+  %c2 = load volatile i32, i32* %c2.ptr
+  %c3.ptr = getelementptr i32, i32* %q, i32 3
+  %c3 = load volatile i32, i32* %c3.ptr
+  %c4.ptr = getelementptr i32, i32* %q, i32 4
+  %c4 = load volatile i32, i32* %c4.ptr
+  %c5.ptr = getelementptr i32, i32* %q, i32 5
+  %c5 = load volatile i32, i32* %c5.ptr
+  %c6.ptr = getelementptr i32, i32* %q, i32 6
+  %c6 = load volatile i32, i32* %c6.ptr
+  %c7.ptr = getelementptr i32, i32* %q, i32 7
+  %c7 = load volatile i32, i32* %c7.ptr
+  %c8.ptr = getelementptr i32, i32* %q, i32 8
+  %c8 = load volatile i32, i32* %c8.ptr
+  %c9.ptr = getelementptr i32, i32* %q, i32 9
+  %c9 = load volatile i32, i32* %c9.ptr
+  %c10.ptr = getelementptr i32, i32* %q, i32 10
+  %c10 = load volatile i32, i32* %c10.ptr
+  %c11.ptr = getelementptr i32, i32* %q, i32 11
+  %c11 = load volatile i32, i32* %c11.ptr
+  %c12.ptr = getelementptr i32, i32* %q, i32 12
+  %c12 = load volatile i32, i32* %c12.ptr
+  %c13.ptr = getelementptr i32, i32* %q, i32 13
+  %c13 = load volatile i32, i32* %c13.ptr
+  %m0 = mul i32 %acc, %c0
+  %m1 = mul i32 %m0, %c1
+  %m2 = mul i32 %m1, %c2
+  %m3 = mul i32 %m2, %c3
+  %m4 = mul i32 %m3, %c4
+  %m5 = mul i32 %m4, %c5
+  %m6 = mul i32 %m5, %c6
+  %m7 = mul i32 %m6, %c7
+  %m8 = mul i32 %m7, %c8
+  %m9 = mul i32 %m8, %c9
+  %m10 = mul i32 %m9, %c10
+  %m11 = mul i32 %m10, %c11
+  %m12 = mul i32 %m11, %c12
+  %m13 = mul i32 %m12, %c13
+  %acc.next = add i32 %m13, %i
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %r0 = mul i32 %acc.next, %v
+  %r1 = add i32 %r0, %v
+  ret i32 %r1
+}
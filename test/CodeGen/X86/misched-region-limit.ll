@@ -0,0 +1,196 @@
+; RUN: llc -mtriple=x86_64-linux-gnu -enable-misched -misched-region-limit=8 -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-linux-gnu -enable-misched -misched-region-limit=8 -stats -o /dev/null < %s 2>&1 | FileCheck %s --check-prefix=STATS
+; RUN: llc -mtriple=x86_64-linux-gnu -enable-misched -misched-region-limit=8 -debug-only=misched -o /dev/null < %s 2>&1 | FileCheck %s --check-prefix=LIMIT
+; RUN: llc -mtriple=x86_64-linux-gnu -enable-misched -debug-only=misched -o /dev/null < %s 2>&1 | FileCheck %s --check-prefix=NOLIMIT
+; REQUIRES: asserts
+
+; A long straight-line block is scheduled as several bounded regions.
+; STATS: {{[0-9]+}} misched - Number of scheduling regions clipped by -misched-region-limit
+
+; LIMIT-NOT: RegionInstrs: {{(9|[1-9][0-9]+)$}}
+; LIMIT: chain:BB#0
+; LIMIT-NEXT: From:
+; LIMIT-NEXT: To:
+; LIMIT-NEXT: RegionInstrs: 8
+; LIMIT: chain:BB#0
+; LIMIT-NEXT: From:
+; LIMIT-NEXT: To:
+; LIMIT-NEXT: RegionInstrs: 8
+; LIMIT: chain:BB#0
+; LIMIT-NEXT: From:
+; LIMIT-NEXT: To:
+; LIMIT-NEXT: RegionInstrs: 8
+; LIMIT-NOT: RegionInstrs: {{(9|[1-9][0-9]+)$}}
+
+; Without the limit the whole block is one region.
+; NOLIMIT: chain:BB#0
+; NOLIMIT-NEXT: From:
+; NOLIMIT-NEXT: To:
+; NOLIMIT-NEXT: RegionInstrs: {{[0-9]{2}$}}
+; NOLIMIT-NOT: chain:BB#0
+
+; CHECK-LABEL: chain:
+; CHECK: retq
+define void @chain(i32* %src, i32* %dst) {
+  %s0.ptr = getelementptr i32, i32* %src, i64 0
+  %v0 = load i32, i32* %s0.ptr
+  %w0 = mul i32 %v0, 3
+  %d0.ptr = getelementptr i32, i32* %dst, i64 0
+  store i32 %w0, i32* %d0.ptr
+  %s1.ptr = getelementptr i32, i32* %src, i64 1
+  %v1 = load i32, i32* %s1.ptr
+  %w1 = mul i32 %v1, 4
+  %d1.ptr = getelementptr i32, i32* %dst, i64 1
+  store i32 %w1, i32* %d1.ptr
+  %s2.ptr = getelementptr i32, i32* %src, i64 2
+  %v2 = load i32, i32* %s2.ptr
+  %w2 = mul i32 %v2, 5
+  %d2.ptr = getelementptr i32, i32* %dst, i64 2
+  store i32 %w2, i32* %d2.ptr
+  %s3.ptr = getelementptr i32, i32* %src, i64 3
+  %v3 = load i32, i32* %s3.ptr
+  %w3 = mul i32 %v3, 6
+  %d3.ptr = getelementptr i32, i32* %dst, i64 3
+  store i32 %w3, i32* %d3.ptr
+  %s4.ptr = getelementptr i32, i32* %src, i64 4
+  %v4 = load i32, i32* %s4.ptr
+  %w4 = mul i32 %v4, 7
+  %d4.ptr = getelementptr i32, i32* %dst, i64 4
+  store i32 %w4, i32* %d4.ptr
+  %s5.ptr = getelementptr i32, i32* %src, i64 5
+  %v5 = load i32, i32* %s5.ptr
+  %w5 = mul i32 %v5, 8
+  %d5.ptr = getelementptr i32, i32* %dst, i64 5
+  store i32 %w5, i32* %d5.ptr
+  %s6.ptr = getelementptr i32, i32* %src, i64 6
+  %v6 = load i32, i32* %s6.ptr
+  %w6 = mul i32 %v6, 9
+  %d6.ptr = getelementptr i32, i32* %dst, i64 6
+  store i32 %w6, i32* %d6.ptr
+  %s7.ptr = getelementptr i32, i32* %src, i64 7
+  %v7 = load i32, i32* %s7.ptr
+  %w7 = mul i32 %v7, 10
+  %d7.ptr = getelementptr i32, i32* %dst, i64 7
+  store i32 %w7, i32* %d7.ptr
+  %s8.ptr = getelementptr i32, i32* %src, i64 8
+  %v8 = load i32, i32* %s8.ptr
+  %w8 = mul i32 %v8, 11
+  %d8.ptr = getelementptr i32, i32* %dst, i64 8
+  store i32 %w8, i32* %d8.ptr
+  %s9.ptr = getelementptr i32, i32* %src, i64 9
+  %v9 = load i32, i32* %s9.ptr
+  %w9 = mul i32 %v9, 12
+  %d9.ptr = getelementptr i32, i32* %dst, i64 9
+  store i32 %w9, i32* %d9.ptr
+  %s10.ptr = getelementptr i32, i32* %src, i64 10
+  %v10 = load i32, i32* %s10.ptr
+  %w10 = mul i32 %v10, 13
+  %d10.ptr = getelementptr i32, i32* %dst, i64 10
+  store i32 %w10, i32* %d10.ptr
+  %s11.ptr = getelementptr i32, i32* %src, i64 11
+  %v11 = load i32, i32* %s11.ptr
+  %w11 = mul i32 %v11, 14
+  %d11.ptr = getelementptr i32, i32* %dst, i64 11
+  store i32 %w11, i32* %d11.ptr
+  %s12.ptr = getelementptr i32, i32* %src, i64 12
+  %v12 = load i32, i32* %s12.ptr
+  %w12 = mul i32 %v12, 15
+  %d12.ptr = getelementptr i32, i32* %dst, i64 12
+  store i32 %w12, i32* %d12.ptr
+  %s13.ptr = getelementptr i32, i32* %src, i64 13
+  %v13 = load i32, i32* %s13.ptr
+  %w13 = mul i32 %v13, 16
+  %d13.ptr = getelementptr i32, i32* %dst, i64 13
+  store i32 %w13, i32* %d13.ptr
+  %s14.ptr = getelementptr i32, i32* %src, i64 14
+  %v14 = load i32, i32* %s14.ptr
+  %w14 = mul i32 %v14, 17
+  %d14.ptr = getelementptr i32, i32* %dst, i64 14
+  store i32 %w14, i32* %d14.ptr
+  %s15.ptr = getelementptr i32, i32* %src, i64 15
+  %v15 = load i32, i32* %s15.ptr
+  %w15 = mul i32 %v15, 18
+  %d15.ptr = getelementptr i32, i32* %dst, i64 15
+  store i32 %w15, i32* %d15.ptr
+  %s16.ptr = getelementptr i32, i32* %src, i64 16
+  %v16 = load i32, i32* %s16.ptr
+  %w16 = mul i32 %v16, 19
+  %d16.ptr = getelementptr i32, i32* %dst, i64 16
+  store i32 %w16, i32* %d16.ptr
+  %s17.ptr = getelementptr i32, i32* %src, i64 17
+  %v17 = load i32, i32* %s17.ptr
+  %w17 = mul i32 %v17, 20
+  %d17.ptr = getelementptr i32, i32* %dst, i64 17
+  store i32 %w17, i32* %d17.ptr
+  %s18.ptr = getelementptr i32, i32* %src, i64 18
+  %v18 = load i32, i32* %s18.ptr
+  %w18 = mul i32 %v18, 21
+  %d18.ptr = getelementptr i32, i32* %dst, i64 18
+  store i32 %w18, i32* %d18.ptr
+  %s19.ptr = getelementptr i32, i32* %src, i64 19
+  %v19 = load i32, i32* %s19.ptr
+  %w19 = mul i32 %v19, 22
+  %d19.ptr = getelementptr i32, i32* %dst, i64 19
+  store i32 %w19, i32* %d19.ptr
+  %s20.ptr = getelementptr i32, i32* %src, i64 20
+  %v20 = load i32, i32* %s20.ptr
+  %w20 = mul i32 %v20, 23
+  %d20.ptr = getelementptr i32, i32* %dst, i64 20
+  store i32 %w20, i32* %d20.ptr
+  %s21.ptr = getelementptr i32, i32* %src, i64 21
+  %v21 = load i32, i32* %s21.ptr
+  %w21 = mul i32 %v21, 24
+  %d21.ptr = getelementptr i32, i32* %dst, i64 21
+  store i32 %w21, i32* %d21.ptr
+  %s22.ptr = getelementptr i32, i32* %src, i64 22
+  %v22 = load i32, i32* %s22.ptr
+  %w22 = mul i32 %v22, 25
+  %d22.ptr = getelementptr i32, i32* %dst, i64 22
+  store i32 %w22, i32* %d22.ptr
+  %s23.ptr = getelementptr i32, i32* %src, i64 23
+  %v23 = load i32, i32* %s23.ptr
+  %w23 = mul i32 %v23, 26
+  %d23.ptr = getelementptr i32, i32* %dst, i64 23
+  store i32 %w23, i32* %d23.ptr
+  %s24.ptr = getelementptr i32, i32* %src, i64 24
+  %v24 = load i32, i32* %s24.ptr
+  %w24 = mul i32 %v24, 27
+  %d24.ptr = getelementptr i32, i32* %dst, i64 24
+  store i32 %w24, i32* %d24.ptr
+  %s25.ptr = getelementptr i32, i32* %src, i64 25
+  %v25 = load i32, i32* %s25.ptr
+  %w25 = mul i32 %v25, 28
+  %d25.ptr = getelementptr i32, i32* %dst, i64 25
+  store i32 %w25, i32* %d25.ptr
+  %s26.ptr = getelementptr i32, i32* %src, i64 26
+  %v26 = load i32, i32* %s26.ptr
+  %w26 = mul i32 %v26, 29
+  %d26.ptr = getelementptr i32, i32* %dst, i64 26
+  store i32 %w26, i32* %d26.ptr
+  %s27.ptr = getelementptr i32, i32* %src, i64 27
+  %v27 = load i32, i32* %s27.ptr
+  %w27 = mul i32 %v27, 30
+  %d27.ptr = getelementptr i32, i32* %dst, i64 27
+  store i32 %w27, i32* %d27.ptr
+  %s28.ptr = getelementptr i32, i32* %src, i64 28
+  %v28 = load i32, i32* %s28.ptr
+  %w28 = mul i32 %v28, 31
+  %d28.ptr = getelementptr i32, i32* %dst, i64 28
+  store i32 %w28, i32* %d28.ptr
+  %s29.ptr = getelementptr i32, i32* %src, i64 29
+  %v29 = load i32, i32* %s29.ptr
+  %w29 = mul i32 %v29, 32
+  %d29.ptr = getelementptr i32, i32* %dst, i64 29
+  store i32 %w29, i32* %d29.ptr
+  %s30.ptr = getelementptr i32, i32* %src, i64 30
+  %v30 = load i32, i32* %s30.ptr
+  %w30 = mul i32 %v30, 33
+  %d30.ptr = getelementptr i32, i32* %dst, i64 30
+  store i32 %w30, i32* %d30.ptr
+  %s31.ptr = getelementptr i32, i32* %src, i64 31
+  %v31 = load i32, i32* %s31.ptr
+  %w31 = mul i32 %v31, 34
+  %d31.ptr = getelementptr i32, i32* %dst, i64 31
+  store i32 %w31, i32* %d31.ptr
+  ret void
+}
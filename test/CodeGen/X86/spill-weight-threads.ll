@@ -0,0 +1,122 @@
+; Computing spill weights on several threads must not change the allocation.
+; RUN: llc -mtriple=x86_64-linux-gnu < %s -o %t.serial
+; RUN: llc -mtriple=x86_64-linux-gnu -spill-weight-threads=4 -spill-weight-chunk-size=4 < %s -o %t.parallel
+; RUN: diff %t.serial %t.parallel
+; RUN: llc -mtriple=x86_64-linux-gnu -regalloc=basic < %s -o %t.serial
+; RUN: llc -mtriple=x86_64-linux-gnu -regalloc=basic -spill-weight-threads=4 -spill-weight-chunk-size=4 < %s -o %t.parallel
+; RUN: diff %t.serial %t.parallel
+
+declare void @clobber()
+
+define i32 @pressure(i32* %p, i32 %n) {
+entry:
+  %a0.ptr = getelementptr i32, i32* %p, i32 0
+  %a0 = load i32, i32* %a0.ptr
+  %a1.ptr = getelementptr i32, i32* %p, i32 1
+  %a1 = load i32, i32* %a1.ptr
+  %a2.ptr = getelementptr i32, i32* %p, i32 2
+  %a2 = load i32, i32* %a2.ptr
+  %a3.ptr = getelementptr i32, i32* %p, i32 3
+  %a3 = load i32, i32* %a3.ptr
+  %a4.ptr = getelementptr i32, i32* %p, i32 4
+  %a4 = load i32, i32* %a4.ptr
+  %a5.ptr = getelementptr i32, i32* %p, i32 5
+  %a5 = load i32, i32* %a5.ptr
+  %a6.ptr = getelementptr i32, i32* %p, i32 6
+  %a6 = load i32, i32* %a6.ptr
+  %a7.ptr = getelementptr i32, i32* %p, i32 7
+  %a7 = load i32, i32* %a7.ptr
+  %a8.ptr = getelementptr i32, i32* %p, i32 8
+  %a8 = load i32, i32* %a8.ptr
+  %a9.ptr = getelementptr i32, i32* %p, i32 9
+  %a9 = load i32, i32* %a9.ptr
+  %a10.ptr = getelementptr i32, i32* %p, i32 10
+  %a10 = load i32, i32* %a10.ptr
+  %a11.ptr = getelementptr i32, i32* %p, i32 11
+  %a11 = load i32, i32* %a11.ptr
+  %a12.ptr = getelementptr i32, i32* %p, i32 12
+  %a12 = load i32, i32* %a12.ptr
+  %a13.ptr = getelementptr i32, i32* %p, i32 13
+  %a13 = load i32, i32* %a13.ptr
+  %a14.ptr = getelementptr i32, i32* %p, i32 14
+  %a14 = load i32, i32* %a14.ptr
+  %a15.ptr = getelementptr i32, i32* %p, i32 15
+  %a15 = load i32, i32* %a15.ptr
+  %a16.ptr = getelementptr i32, i32* %p, i32 16
+  %a16 = load i32, i32* %a16.ptr
+  %a17.ptr = getelementptr i32, i32* %p, i32 17
+  %a17 = load i32, i32* %a17.ptr
+  %a18.ptr = getelementptr i32, i32* %p, i32 18
+  %a18 = load i32, i32* %a18.ptr
+  %a19.ptr = getelementptr i32, i32* %p, i32 19
+  %a19 = load i32, i32* %a19.ptr
+  %a20.ptr = getelementptr i32, i32* %p, i32 20
+  %a20 = load i32, i32* %a20.ptr
+  %a21.ptr = getelementptr i32, i32* %p, i32 21
+  %a21 = load i32, i32* %a21.ptr
+  %a22.ptr = getelementptr i32, i32* %p, i32 22
+  %a22 = load i32, i32* %a22.ptr
+  %a23.ptr = getelementptr i32, i32* %p, i32 23
+  %a23 = load i32, i32* %a23.ptr
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  call void @clobber()
+  %s0 = mul i32 %acc, %a0
+  %s1 = mul i32 %s0, %a1
+  %s2 = mul i32 %s1, %a2
+  %s3 = mul i32 %s2, %a3
+  %s4 = mul i32 %s3, %a4
+  %s5 = mul i32 %s4, %a5
+  %s6 = mul i32 %s5, %a6
+  %s7 = mul i32 %s6, %a7
+  %s8 = mul i32 %s7, %a8
+  %s9 = mul i32 %s8, %a9
+  %s10 = mul i32 %s9, %a10
+  %s11 = mul i32 %s10, %a11
+  %s12 = mul i32 %s11, %a12
+  %s13 = mul i32 %s12, %a13
+  %s14 = mul i32 %s13, %a14
+  %s15 = mul i32 %s14, %a15
+  %s16 = mul i32 %s15, %a16
+  %s17 = mul i32 %s16, %a17
+  %s18 = mul i32 %s17, %a18
+  %s19 = mul i32 %s18, %a19
+  %s20 = mul i32 %s19, %a20
+  %s21 = mul i32 %s20, %a21
+  %s22 = mul i32 %s21, %a22
+  %s23 = mul i32 %s22, %a23
+  %acc.next = add i32 %s23, %i
+  %i.next = add i32 %i, 1
+  %cmp = icmp slt i32 %i.next, %n
+  br i1 %cmp, label %loop, label %exit
+
+exit:
+  %t0 = xor i32 %acc.next, %a0
+  %t1 = xor i32 %t0, %a1
+  %t2 = xor i32 %t1, %a2
+  %t3 = xor i32 %t2, %a3
+  %t4 = xor i32 %t3, %a4
+  %t5 = xor i32 %t4, %a5
+  %t6 = xor i32 %t5, %a6
+  %t7 = xor i32 %t6, %a7
+  %t8 = xor i32 %t7, %a8
+  %t9 = xor i32 %t8, %a9
+  %t10 = xor i32 %t9, %a10
+  %t11 = xor i32 %t10, %a11
+  %t12 = xor i32 %t11, %a12
+  %t13 = xor i32 %t12, %a13
+  %t14 = xor i32 %t13, %a14
+  %t15 = xor i32 %t14, %a15
+  %t16 = xor i32 %t15, %a16
+  %t17 = xor i32 %t16, %a17
+  %t18 = xor i32 %t17, %a18
+  %t19 = xor i32 %t18, %a19
+  %t20 = xor i32 %t19, %a20
+  %t21 = xor i32 %t20, %a21
+  %t22 = xor i32 %t21, %a22
+  %t23 = xor i32 %t22, %a23
+  ret i32 %t23
+}
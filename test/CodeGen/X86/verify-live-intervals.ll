@@ -0,0 +1,42 @@
+; The live intervals that the coalescer, the scheduler and the register
+; allocator update in place must match a full recompute.
+; REQUIRES: asserts
+; RUN: llc -mtriple=x86_64-linux-gnu -verify-live-intervals -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=x86_64-linux-gnu -verify-live-intervals -regalloc=basic < %s | FileCheck %s
+
+; CHECK-LABEL: sum:
+; CHECK: retq
+define i64 @sum(i64* %p, i64 %n) {
+entry:
+  %empty = icmp eq i64 %n, 0
+  br i1 %empty, label %exit, label %loop
+
+loop:
+  %i = phi i64 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %prod = phi i64 [ 1, %entry ], [ %prod.next, %loop ]
+  %addr = getelementptr i64, i64* %p, i64 %i
+  %v = load i64, i64* %addr
+  %acc.next = add i64 %acc, %v
+  %prod.next = mul i64 %prod, %v
+  %i.next = add i64 %i, 1
+  %done = icmp eq i64 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %a = phi i64 [ 0, %entry ], [ %acc.next, %loop ]
+  %b = phi i64 [ 1, %entry ], [ %prod.next, %loop ]
+  %r = sub i64 %a, %b
+  ret i64 %r
+}
+
+; CHECK-LABEL: across_call:
+; CHECK: callq g
+; CHECK: retq
+declare i32 @g(i32)
+define i32 @across_call(i32 %x, i32 %y) {
+  %c = call i32 @g(i32 %x)
+  %s = add i32 %c, %y
+  %t = mul i32 %s, %x
+  ret i32 %t
+}
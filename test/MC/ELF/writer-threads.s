@@ -0,0 +1,57 @@
+// Check that encoding relocation tables and compressing debug sections on
+// several threads produces the same object as doing it serially.
+// REQUIRES: zlib
+
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o %t.serial
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu -elf-writer-threads=4 %s -o %t.parallel
+// RUN: cmp %t.serial %t.parallel
+
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu -compress-debug-sections=zlib %s -o %t.serial
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu -compress-debug-sections=zlib -elf-writer-threads=4 %s -o %t.parallel
+// RUN: cmp %t.serial %t.parallel
+
+// RUN: llvm-mc -filetype=obj -triple i386-pc-linux-gnu -compress-debug-sections=zlib-gnu %s -o %t.serial
+// RUN: llvm-mc -filetype=obj -triple i386-pc-linux-gnu -compress-debug-sections=zlib-gnu -elf-writer-threads=4 %s -o %t.parallel
+// RUN: cmp %t.serial %t.parallel
+
+// Chunked compression depends on the chunk size, but not on the thread count.
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu -compress-debug-sections=zlib -elf-compression-chunk-size=32 %s -o %t.serial
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu -compress-debug-sections=zlib -elf-compression-chunk-size=32 -elf-writer-threads=4 %s -o %t.parallel
+// RUN: cmp %t.serial %t.parallel
+// RUN: llvm-readobj -sections %t.serial | FileCheck %s
+
+// CHECK:      Name: .debug_info
+// CHECK-NEXT: Type: SHT_PROGBITS
+// CHECK-NEXT: Flags [
+// CHECK-NEXT:   SHF_COMPRESSED
+
+	.section	.text.foo,"ax",@progbits
+foo:
+	call	bar
+	call	baz
+	.long	foo
+
+	.section	.text.bar,"ax",@progbits
+bar:
+	call	foo
+	call	baz
+
+	.section	.data.ptrs,"aw",@progbits
+	.long	foo
+	.long	bar
+	.long	baz
+
+	.section	.debug_str,"MS",@progbits,1
+	.asciz	"perfectly compressable"
+	.asciz	"perfectly compressable"
+	.asciz	"perfectly compressable"
+	.asciz	"perfectly compressable"
+
+	.section	.debug_info,"",@progbits
+	.long	.Linfo_string0
+	.zero	128
+	.long	.Linfo_string0
+
+	.section	.debug_str,"MS",@progbits,1
+.Linfo_string0:
+	.asciz	"perfectly compressable"
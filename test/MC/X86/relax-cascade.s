@@ -0,0 +1,43 @@
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux-gnu %s -o %t
+// RUN: llvm-objdump -d %t | FileCheck %s
+
+	.text
+
+// Each branch only goes out of range once the branch after it has been
+// relaxed, so the section takes several relaxation passes to settle.
+
+// CHECK-LABEL: cascade:
+// CHECK-NEXT: 0: e9 82 00 00 00 jmp 130
+// CHECK: 81: 0f 85 82 00 00 00 jne 130
+// CHECK: 104: e9 80 00 00 00 jmp 128
+// CHECK: 189: c3 retq
+cascade:
+	jmp	.Lc1
+	.space	124, 0x90
+	jne	.Lc2
+.Lc1:
+	.space	125, 0x90
+	jmp	.Lc3
+.Lc2:
+	.space	128, 0x90
+.Lc3:
+	retq
+
+// With one byte less at the end, nothing goes out of range.
+
+// CHECK-LABEL: short:
+// CHECK-NEXT: 18a: eb 7e jmp 126
+// CHECK: 208: 75 7f jne 127
+// CHECK: 287: eb 7f jmp 127
+// CHECK: 308: c3 retq
+short:
+	jmp	.Ls1
+	.space	124, 0x90
+	jne	.Ls2
+.Ls1:
+	.space	125, 0x90
+	jmp	.Ls3
+.Ls2:
+	.space	127, 0x90
+.Ls3:
+	retq
@@ -0,0 +1,47 @@
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/funcimport2.ll -o %t2.bc
+
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.o -print-index-memory \
+; RUN:     -r=%t1.bc,_foo,plx \
+; RUN:     -r=%t1.bc,_bar,plx \
+; RUN:     -r=%t1.bc,_a,plx -r=%t1.bc,_b,plx -r=%t1.bc,_c,plx \
+; RUN:     -r=%t1.bc,_baz, -r=%t1.bc,_qux, \
+; RUN:     -r=%t2.bc,_main,plx \
+; RUN:     -r=%t2.bc,_foo,l | FileCheck %s
+
+; The reader sizes each edge list exactly, so no slots are left unused. With
+; push_back growth, the three references and calls of @bar would take four
+; slots each.
+; CHECK: Module summary index memory usage:
+; CHECK: GUID map: {{[0-9]+}} bytes (6 entries)
+; CHECK: Summaries: {{[0-9]+}} bytes (3 functions, 3 variables, 0 aliases)
+; CHECK: Reference list: {{[0-9]+}} bytes (3 of 3 slots used)
+; CHECK: Call edges: {{[0-9]+}} bytes (4 of 4 slots used)
+; CHECK: Module paths: {{[0-9]+}} bytes (2 modules)
+; CHECK: Total: {{[0-9]+}} bytes
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+define void @foo() {
+entry:
+  ret void
+}
+
+@a = global i32 0
+@b = global i32 0
+@c = global i32 0
+
+define void @bar() {
+entry:
+  call void @foo()
+  call void @baz()
+  call void @qux()
+  %x = load volatile i32, i32* @a
+  %y = load volatile i32, i32* @b
+  %z = load volatile i32, i32* @c
+  ret void
+}
+
+declare void @baz()
+declare void @qux()
@@ -0,0 +1,24 @@
+; RUN: opt -module-summary %s -o %t.bc
+
+; Target and codegen options given to llvm-lto2 reach the out-of-process
+; workers, so they produce the same object as the in-process backend.
+; RUN: llvm-lto2 %t.bc -o %t.inproc -code-model=large \
+; RUN:     -relocation-model=static -r=%t.bc,foo,plx -r=%t.bc,g,plx
+; RUN: llvm-lto2 %t.bc -o %t.outproc -code-model=large \
+; RUN:     -relocation-model=static -thinlto-out-of-process \
+; RUN:     -r=%t.bc,foo,plx -r=%t.bc,g,plx
+; RUN: cmp %t.inproc.0 %t.outproc.0
+; RUN: llvm-objdump -d %t.outproc.0 | FileCheck %s
+
+; The large code model materializes the address of @g with movabsq.
+; CHECK: movabsq
+
+target datalayout = "e-m:e-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-unknown-linux-gnu"
+
+@g = global i32 0
+
+define i32 @foo() {
+  %v = load i32, i32* @g
+  ret i32 %v
+}
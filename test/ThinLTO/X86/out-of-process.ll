@@ -0,0 +1,35 @@
+; RUN: opt -module-summary %s -o %t1.bc
+; RUN: opt -module-summary %p/Inputs/funcimport2.ll -o %t2.bc
+
+; Each backend job runs in its own llvm-lto2 process, and the objects it
+; produces are handed back to the linker as usual.
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.o -thinlto-out-of-process \
+; RUN:     -thinlto-process-memory-limit=4096 \
+; RUN:     -r=%t1.bc,_foo,plx \
+; RUN:     -r=%t2.bc,_main,plx \
+; RUN:     -r=%t2.bc,_foo,l
+; RUN: llvm-nm %t.o.0 | FileCheck %s --check-prefix=NM0
+; RUN: llvm-nm %t.o.1 | FileCheck %s --check-prefix=NM1
+; NM0: T _foo
+; NM1: T _main
+
+; The worker mode can also be run directly on an individual index.
+; RUN: llvm-lto2 %t1.bc %t2.bc -o %t.index -thinlto-distributed-indexes \
+; RUN:     -r=%t1.bc,_foo,plx \
+; RUN:     -r=%t2.bc,_main,plx \
+; RUN:     -r=%t2.bc,_foo,l
+; RUN: llvm-lto2 -thinlto-index=%t2.bc.thinlto.bc %t2.bc -o %t2.o
+; RUN: llvm-nm %t2.o | FileCheck %s --check-prefix=NM1
+
+; A worker needs exactly one module.
+; RUN: not llvm-lto2 -thinlto-index=%t2.bc.thinlto.bc %t1.bc %t2.bc -o %t2.o \
+; RUN:     2>&1 | FileCheck %s --check-prefix=ERR
+; ERR: -thinlto-index requires exactly one input file
+
+target datalayout = "e-m:o-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-apple-macosx10.11.0"
+
+define void @foo() {
+entry:
+  ret void
+}
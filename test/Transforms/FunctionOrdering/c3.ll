@@ -0,0 +1,78 @@
+; RUN: opt -S -function-ordering < %s | FileCheck %s
+; RUN: opt -S -passes=function-ordering < %s | FileCheck %s
+; RUN: opt -S -function-ordering -function-order-file=%t.order < %s > /dev/null
+; RUN: FileCheck %s --check-prefix=ORDER < %t.order
+; RUN: opt -mtriple=x86_64-apple-macosx -default-data-layout=e-m:o-i64:64-f80:128-n8:16:32:64-S128 \
+; RUN:   -function-ordering -function-order-file=%t.darwin.order < %s > /dev/null
+; RUN: FileCheck %s --check-prefix=DARWIN < %t.darwin.order
+
+; The hot chain main -> mid -> leaf is clustered and placed first. Functions
+; that were never executed follow in their original order.
+
+; CHECK: define void @main()
+; CHECK: define void @mid()
+; CHECK: define void @leaf()
+; CHECK: define void @"\01explicit"()
+; CHECK: define private void @hidden()
+; CHECK: define void @unrelated()
+; CHECK: define void @cold_a()
+; CHECK: define void @cold_b()
+
+; ORDER:      main
+; ORDER-NEXT: mid
+; ORDER-NEXT: leaf
+; ORDER-NEXT: {{^}}explicit{{$}}
+; ORDER-NEXT: unrelated
+; ORDER-NOT:  {{cold|hidden}}
+
+; The order file holds the symbol names the linker sees: Darwin adds a '_'
+; prefix, and names starting with \01 are used verbatim. Private functions
+; have no symbol and are left out.
+; DARWIN:      _main
+; DARWIN-NEXT: _mid
+; DARWIN-NEXT: _leaf
+; DARWIN-NEXT: {{^}}explicit{{$}}
+; DARWIN-NEXT: _unrelated
+; DARWIN-NOT:  {{cold|hidden}}
+
+define void @cold_a() !prof !0 {
+  call void @leaf()
+  ret void
+}
+
+define void @leaf() !prof !1 {
+  ret void
+}
+
+define void @unrelated() !prof !2 {
+  ret void
+}
+
+define void @"\01explicit"() !prof !4 {
+  ret void
+}
+
+define private void @hidden() !prof !5 {
+  ret void
+}
+
+define void @cold_b() {
+  ret void
+}
+
+define void @main() !prof !3 {
+  call void @mid()
+  ret void
+}
+
+define void @mid() !prof !1 {
+  call void @leaf()
+  ret void
+}
+
+!0 = !{!"function_entry_count", i64 0}
+!1 = !{!"function_entry_count", i64 1000}
+!2 = !{!"function_entry_count", i64 1}
+!3 = !{!"function_entry_count", i64 10}
+!4 = !{!"function_entry_count", i64 5}
+!5 = !{!"function_entry_count", i64 2}
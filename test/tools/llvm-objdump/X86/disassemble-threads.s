@@ -0,0 +1,44 @@
+// Check that disassembling on several threads prints the same as
+// disassembling serially, including the inline relocations.
+// RUN: llvm-mc -filetype=obj -triple x86_64-pc-linux %s -o %t
+// RUN: llvm-objdump -d -r %t > %t.serial
+// RUN: llvm-objdump -d -r -threads=4 %t > %t.parallel
+// RUN: cmp %t.serial %t.parallel
+// RUN: FileCheck %s < %t.parallel
+
+// CHECK: foo:
+// CHECK: callq
+// CHECK-NEXT: R_X86_64_PC32 ext-4
+// CHECK: bar:
+// CHECK: baz:
+// CHECK: R_X86_64_32S
+// CHECK: qux:
+
+	.text
+	.globl	foo
+foo:
+	pushq	%rbp
+	callq	ext
+	callq	bar
+	callq	baz
+	popq	%rbp
+	retq
+
+	.globl	bar
+bar:
+	movl	$1, %eax
+	jmp	qux
+
+	.globl	baz
+baz:
+	movq	data, %rax
+	retq
+
+	.globl	qux
+qux:
+	xorl	%eax, %eax
+	retq
+
+	.data
+data:
+	.quad	0
@@ -86,6 +86,11 @@ static cl::list<std::string>
 static cl::opt<bool> MRI("M", cl::desc(""));
 static cl::opt<std::string> Plugin("plugin", cl::desc("plugin (ignored for compatibility"));
 
+static cl::opt<unsigned>
+    NumThreads("threads", cl::init(1), cl::Hidden,
+               cl::desc("Number of threads to use for reading the symbols of "
+                        "the members when writing the symbol table"));
+
 namespace {
 enum Format { Default, GNU, BSD };
 }
@@ -676,7 +681,8 @@ performWriteOperation(ArchiveOperation Operation,
 
   std::pair<StringRef, std::error_code> Result =
       writeArchive(ArchiveName, NewMembersP ? *NewMembersP : NewMembers, Symtab,
-                   Kind, Deterministic, Thin, std::move(OldArchiveBuf));
+                   Kind, Deterministic, Thin, std::move(OldArchiveBuf),
+                   NumThreads);
   failIfError(Result.second, Result.first);
 }
 
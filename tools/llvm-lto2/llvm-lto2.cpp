@@ -17,8 +17,11 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/LTO/Caching.h"
+#include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/CodeGen/CommandFlags.h"
 #include "llvm/LTO/LTO.h"
+#include "llvm/LTO/LTOBackend.h"
+#include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Threading.h"
@@ -63,6 +66,26 @@ static cl::opt<bool>
                                        "import files for the "
                                        "distributed backend case"));
 
+static cl::opt<bool> ThinLTOOutOfProcess(
+    "thinlto-out-of-process",
+    cl::desc("Run each ThinLTO backend job in a separate llvm-lto2 process"));
+
+static cl::opt<unsigned> ThinLTOProcessMemoryLimit(
+    "thinlto-process-memory-limit", cl::init(0),
+    cl::desc("Kill any ThinLTO backend process that allocates more than this "
+             "many megabytes (0 = no limit)"),
+    cl::value_desc("megabytes"));
+
+static cl::opt<std::string> ThinLTOIndex(
+    "thinlto-index",
+    cl::desc("Run the ThinLTO backend for the single input file, using the "
+             "given individual index (used by -thinlto-out-of-process)"),
+    cl::value_desc("filename"));
+
+static cl::opt<bool> PrintIndexMemory(
+    "print-index-memory",
+    cl::desc("Print the memory used by the combined summary index"));
+
 static cl::opt<int> Threads("-thinlto-threads",
                             cl::init(llvm::heavyweight_hardware_concurrency()));
 
@@ -116,6 +139,104 @@ template <typename T> static T check(ErrorOr<T> E, std::string Msg) {
   return T();
 }
 
+/// Return the options that a -thinlto-index worker needs to set up the same
+/// Config and code generator as this process. These are all the options on
+/// the command line except the inputs, the output, the symbol resolutions and
+/// the options that only drive the thin link, so that target and codegen
+/// flags such as -code-model or -float-abi reach the workers too.
+static std::vector<std::string> getBackendWorkerArgs(int argc, char **argv) {
+  // cl::list overloads operator& to return its storage, so the resolution
+  // list is converted to its cl::Option explicitly.
+  const cl::Option *const ThinLinkOptions[] = {
+      &OutputFilename, &CacheDir, &SaveTemps, &ThinLTODistributedIndexes,
+      &ThinLTOOutOfProcess, &ThinLTOProcessMemoryLimit, &ThinLTOIndex,
+      &PrintIndexMemory, &Threads,
+      &static_cast<const cl::Option &>(SymbolResolutions)};
+  StringMap<cl::Option *> &Options = cl::getRegisteredOptions();
+
+  std::vector<std::string> Args;
+  for (int I = 1; I < argc; ++I) {
+    StringRef Arg = argv[I];
+    // Everything else that isn't an option is an input file.
+    if (!Arg.startswith("-") || Arg == "-")
+      continue;
+    if (Arg == "--")
+      break;
+
+    StringRef Name = Arg.drop_front(Arg.startswith("--") ? 2 : 1);
+    bool HasValue = Name.find('=') != StringRef::npos;
+    Name = Name.split('=').first;
+
+    // Prefix options such as -O2 aren't found by name and carry their value.
+    auto Opt = Options.find(Name);
+    if (Opt == Options.end()) {
+      Args.push_back(Arg.str());
+      continue;
+    }
+
+    bool Forward = !is_contained(ThinLinkOptions, Opt->second);
+    if (Forward)
+      Args.push_back(Arg.str());
+    if (!HasValue && Opt->second->getValueExpectedFlag() == cl::ValueRequired &&
+        I + 1 < argc) {
+      ++I;
+      if (Forward)
+        Args.push_back(argv[I]);
+    }
+  }
+  return Args;
+}
+
+/// Run the ThinLTO backend for the single input module, importing whatever
+/// the individual index given by -thinlto-index refers to, and write the
+/// object file to the output file.
+static int runThinLTOBackendWorker(Config &Conf) {
+  if (InputFilenames.size() != 1) {
+    llvm::errs() << "-thinlto-index requires exactly one input file\n";
+    return 1;
+  }
+  const std::string &ModulePath = InputFilenames[0];
+
+  std::unique_ptr<ModuleSummaryIndex> Index =
+      check(getModuleSummaryIndexForFile(ThinLTOIndex), ThinLTOIndex);
+  std::unique_ptr<MemoryBuffer> MB =
+      check(MemoryBuffer::getFile(ModulePath), ModulePath);
+  LTOLLVMContext Ctx(Conf);
+  std::unique_ptr<Module> M =
+      check(parseBitcodeFile(MB->getMemBufferRef(), Ctx), ModulePath);
+
+  StringMap<GVSummaryMapTy> ModuleToDefinedGVSummaries;
+  Index->collectDefinedGVSummariesPerModule(ModuleToDefinedGVSummaries);
+
+  // The individual index only holds the summaries of this module and of the
+  // values it imports, so import everything that comes from another module.
+  FunctionImporter::ImportMapTy ImportList;
+  for (auto &GlobalList : *Index)
+    for (auto &Summary : GlobalList.second)
+      if (Summary->modulePath() != ModulePath)
+        ImportList[Summary->modulePath()][GlobalList.first] = 1;
+
+  std::vector<std::unique_ptr<MemoryBuffer>> OwnedImports;
+  MapVector<StringRef, MemoryBufferRef> ModuleMap;
+  for (auto &I : ImportList) {
+    OwnedImports.push_back(check(MemoryBuffer::getFile(I.first()), I.first()));
+    ModuleMap[I.first()] = OwnedImports.back()->getMemBufferRef();
+  }
+
+  auto AddStream = [&](size_t Task) -> std::unique_ptr<NativeObjectStream> {
+    std::error_code EC;
+    auto S = llvm::make_unique<raw_fd_ostream>(OutputFilename, EC,
+                                               sys::fs::F_None);
+    check(EC, OutputFilename);
+    return llvm::make_unique<NativeObjectStream>(std::move(S));
+  };
+
+  check(thinBackend(Conf, /*Task=*/0, AddStream, *M, *Index, ImportList,
+                    ModuleToDefinedGVSummaries[ModulePath], ModuleMap),
+        "thinBackend failed");
+  return 0;
+}
+
 int main(int argc, char **argv) {
   InitializeAllTargets();
   InitializeAllTargetMCs();
@@ -172,6 +293,14 @@ int main(int argc, char **argv) {
     check(Conf.addSaveTemps(OutputFilename + "."),
           "Config::addSaveTemps failed");
 
+  if (PrintIndexMemory) {
+    auto SaveTempsHook = Conf.CombinedIndexHook;
+    Conf.CombinedIndexHook = [=](const ModuleSummaryIndex &Index) {
+      Index.printMemoryUsage(outs());
+      return !SaveTempsHook || SaveTempsHook(Index);
+    };
+  }
+
   // Run a custom pipeline, if asked for.
   Conf.OptPipeline = OptPipeline;
   Conf.AAPipeline = AAPipeline;
@@ -197,10 +326,20 @@ int main(int argc, char **argv) {
 
   Conf.OverrideTriple = OverrideTriple;
   Conf.DefaultTriple = DefaultTriple;
+  Conf.ThinLinkThreads = Threads;
+
+  if (!ThinLTOIndex.empty())
+    return runThinLTOBackendWorker(Conf);
 
   ThinBackend Backend;
   if (ThinLTODistributedIndexes)
     Backend = createWriteIndexesThinBackend("", "", true, "");
+  else if (ThinLTOOutOfProcess)
+    Backend = createOutOfProcessThinBackend(
+        Threads,
+        sys::fs::getMainExecutable(argv[0],
+                                   (void *)(intptr_t)&runThinLTOBackendWorker),
+        getBackendWorkerArgs(argc, argv), ThinLTOProcessMemoryLimit);
   else
     Backend = createInProcessThinBackend(Threads);
   LTO Lto(std::move(Conf), std::move(Backend));
@@ -39,8 +39,10 @@
 #include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cerrno>
 #include <cstring>
@@ -168,11 +170,16 @@ cl::opt<bool> FormatMachOasHex("x", cl::desc("Print symbol entry in hex, "
 cl::opt<bool> NoLLVMBitcode("no-llvm-bc",
                             cl::desc("Disable LLVM bitcode reader"));
 
+cl::opt<unsigned>
+    NumThreads("threads", cl::init(1), cl::Hidden,
+               cl::desc("Number of threads to use for dumping multiple input "
+                        "files or the members of an archive"));
+
 bool PrintAddress = true;
 
 bool MultipleFiles = false;
 
-bool HadError = false;
+std::atomic<bool> HadError(false);
 
 std::string ToolName;
 } // anonymous namespace
@@ -274,9 +281,7 @@ static char isSymbolList64Bit(SymbolicFile &Obj) {
   return cast<ELFObjectFileBase>(Obj).getBytesInAddress() == 8;
 }
 
-static StringRef CurrentFilename;
 typedef std::vector<NMSymbol> SymbolListT;
-static SymbolListT SymbolList;
 
 static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 
@@ -285,9 +290,10 @@ static char getSymbolNMTypeChar(IRObjectFile &Obj, basic_symbol_iterator I);
 // the darwin format it produces the same output as darwin's nm(1) -m output
 // and when printing Mach-O symbols in hex it produces the same output as
 // darwin's nm(1) -x format.
-static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
-                              char *SymbolAddrStr, const char *printBlanks,
-                              const char *printDashes, const char *printFormat) {
+static void darwinPrintSymbol(raw_ostream &OS, SymbolicFile &Obj,
+                              SymbolListT::iterator I, char *SymbolAddrStr,
+                              const char *printBlanks, const char *printDashes,
+                              const char *printFormat) {
   MachO::mach_header H;
   MachO::mach_header_64 H_64;
   uint32_t Filetype = MachO::MH_OBJECT;
@@ -349,16 +355,16 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
   if (FormatMachOasHex) {
     char Str[18] = "";
     format(printFormat, NValue).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%02x", NType).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%02x", NSect).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%04x", NDesc).print(Str, sizeof(Str));
-    outs() << Str << ' ';
+    OS << Str << ' ';
     format("%08x", NStrx).print(Str, sizeof(Str));
-    outs() << Str << ' ';
-    outs() << I->Name << "\n";
+    OS << Str << ' ';
+    OS << I->Name << "\n";
     return;
   }
 
@@ -367,58 +373,58 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
       strcpy(SymbolAddrStr, printBlanks);
     if (Obj.isIR() && (NType & MachO::N_TYPE) == MachO::N_TYPE)
       strcpy(SymbolAddrStr, printDashes);
-    outs() << SymbolAddrStr << ' ';
+    OS << SymbolAddrStr << ' ';
   }
 
   switch (NType & MachO::N_TYPE) {
   case MachO::N_UNDF:
     if (NValue != 0) {
-      outs() << "(common) ";
+      OS << "(common) ";
       if (MachO::GET_COMM_ALIGN(NDesc) != 0)
-        outs() << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
+        OS << "(alignment 2^" << (int)MachO::GET_COMM_ALIGN(NDesc) << ") ";
     } else {
       if ((NType & MachO::N_TYPE) == MachO::N_PBUD)
-        outs() << "(prebound ";
+        OS << "(prebound ";
       else
-        outs() << "(";
+        OS << "(";
       if ((NDesc & MachO::REFERENCE_TYPE) ==
           MachO::REFERENCE_FLAG_UNDEFINED_LAZY)
-        outs() << "undefined [lazy bound]) ";
+        OS << "undefined [lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_LAZY)
-        outs() << "undefined [private lazy bound]) ";
+        OS << "undefined [private lazy bound]) ";
       else if ((NDesc & MachO::REFERENCE_TYPE) ==
                MachO::REFERENCE_FLAG_PRIVATE_UNDEFINED_NON_LAZY)
-        outs() << "undefined [private]) ";
+        OS << "undefined [private]) ";
       else
-        outs() << "undefined) ";
+        OS << "undefined) ";
     }
     break;
   case MachO::N_ABS:
-    outs() << "(absolute) ";
+    OS << "(absolute) ";
     break;
   case MachO::N_INDR:
-    outs() << "(indirect) ";
+    OS << "(indirect) ";
     break;
   case MachO::N_SECT: {
     if (Obj.isIR()) {
       // For llvm bitcode files print out a fake section name using the values
       // use 1, 2 and 3 for section numbers as set above.
       if (NSect == 1)
-        outs() << "(LTO,CODE) ";
+        OS << "(LTO,CODE) ";
       else if (NSect == 2)
-        outs() << "(LTO,DATA) ";
+        OS << "(LTO,DATA) ";
       else if (NSect == 3)
-        outs() << "(LTO,RODATA) ";
+        OS << "(LTO,RODATA) ";
       else
-        outs() << "(?,?) ";
+        OS << "(?,?) ";
       break;
     }
     Expected<section_iterator> SecOrErr =
       MachO->getSymbolSection(I->Sym.getRawDataRefImpl());
     if (!SecOrErr) {
       consumeError(SecOrErr.takeError());
-      outs() << "(?,?) ";
+      OS << "(?,?) ";
       break;
     }
     section_iterator Sec = *SecOrErr;
@@ -426,67 +432,67 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
     StringRef SectionName;
     MachO->getSectionName(Ref, SectionName);
     StringRef SegmentName = MachO->getSectionFinalSegmentName(Ref);
-    outs() << "(" << SegmentName << "," << SectionName << ") ";
+    OS << "(" << SegmentName << "," << SectionName << ") ";
     break;
   }
   default:
-    outs() << "(?) ";
+    OS << "(?) ";
     break;
   }
 
   if (NType & MachO::N_EXT) {
     if (NDesc & MachO::REFERENCED_DYNAMICALLY)
-      outs() << "[referenced dynamically] ";
+      OS << "[referenced dynamically] ";
     if (NType & MachO::N_PEXT) {
       if ((NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF)
-        outs() << "weak private external ";
+        OS << "weak private external ";
       else
-        outs() << "private external ";
+        OS << "private external ";
     } else {
       if ((NDesc & MachO::N_WEAK_REF) == MachO::N_WEAK_REF ||
           (NDesc & MachO::N_WEAK_DEF) == MachO::N_WEAK_DEF) {
         if ((NDesc & (MachO::N_WEAK_REF | MachO::N_WEAK_DEF)) ==
             (MachO::N_WEAK_REF | MachO::N_WEAK_DEF))
-          outs() << "weak external automatically hidden ";
+          OS << "weak external automatically hidden ";
         else
-          outs() << "weak external ";
+          OS << "weak external ";
       } else
-        outs() << "external ";
+        OS << "external ";
     }
   } else {
     if (NType & MachO::N_PEXT)
-      outs() << "non-external (was a private external) ";
+      OS << "non-external (was a private external) ";
     else
-      outs() << "non-external ";
+      OS << "non-external ";
   }
 
   if (Filetype == MachO::MH_OBJECT &&
       (NDesc & MachO::N_NO_DEAD_STRIP) == MachO::N_NO_DEAD_STRIP)
-    outs() << "[no dead strip] ";
+    OS << "[no dead strip] ";
 
   if (Filetype == MachO::MH_OBJECT &&
       ((NType & MachO::N_TYPE) != MachO::N_UNDF) &&
       (NDesc & MachO::N_SYMBOL_RESOLVER) == MachO::N_SYMBOL_RESOLVER)
-    outs() << "[symbol resolver] ";
+    OS << "[symbol resolver] ";
 
   if (Filetype == MachO::MH_OBJECT &&
       ((NType & MachO::N_TYPE) != MachO::N_UNDF) &&
       (NDesc & MachO::N_ALT_ENTRY) == MachO::N_ALT_ENTRY)
-    outs() << "[alt entry] ";
+    OS << "[alt entry] ";
 
   if ((NDesc & MachO::N_ARM_THUMB_DEF) == MachO::N_ARM_THUMB_DEF)
-    outs() << "[Thumb] ";
+    OS << "[Thumb] ";
 
   if ((NType & MachO::N_TYPE) == MachO::N_INDR) {
-    outs() << I->Name << " (for ";
+    OS << I->Name << " (for ";
     StringRef IndirectName;
     if (!MachO ||
         MachO->getIndirectName(I->Sym.getRawDataRefImpl(), IndirectName))
-      outs() << "?)";
+      OS << "?)";
     else
-      outs() << IndirectName << ")";
+      OS << IndirectName << ")";
   } else
-    outs() << I->Name;
+    OS << I->Name;
 
   if ((Flags & MachO::MH_TWOLEVEL) == MachO::MH_TWOLEVEL &&
       (((NType & MachO::N_TYPE) == MachO::N_UNDF && NValue == 0) ||
@@ -494,21 +500,21 @@ static void darwinPrintSymbol(SymbolicFile &Obj, SymbolListT::iterator I,
     uint32_t LibraryOrdinal = MachO::GET_LIBRARY_ORDINAL(NDesc);
     if (LibraryOrdinal != 0) {
       if (LibraryOrdinal == MachO::EXECUTABLE_ORDINAL)
-        outs() << " (from executable)";
+        OS << " (from executable)";
       else if (LibraryOrdinal == MachO::DYNAMIC_LOOKUP_ORDINAL)
-        outs() << " (dynamically looked up)";
+        OS << " (dynamically looked up)";
       else {
         StringRef LibraryName;
         if (!MachO ||
             MachO->getLibraryShortNameByIndex(LibraryOrdinal - 1, LibraryName))
-          outs() << " (from bad library ordinal " << LibraryOrdinal << ")";
+          OS << " (from bad library ordinal " << LibraryOrdinal << ")";
         else
-          outs() << " (from " << LibraryName << ")";
+          OS << " (from " << LibraryName << ")";
       }
     }
   }
 
-  outs() << "\n";
+  OS << "\n";
 }
 
 // Table that maps Darwin's Mach-O stab constants to strings to allow printing.
@@ -560,7 +566,8 @@ static const char *getDarwinStabString(uint8_t NType) {
 
 // darwinPrintStab() prints the n_sect, n_desc along with a symbolic name of
 // a stab n_type value in a Mach-O file.
-static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I) {
+static void darwinPrintStab(raw_ostream &OS, MachOObjectFile *MachO,
+                            SymbolListT::iterator I) {
   MachO::nlist_64 STE_64;
   MachO::nlist STE;
   uint8_t NType;
@@ -581,49 +588,41 @@ static void darwinPrintStab(MachOObjectFile *MachO, SymbolListT::iterator I) {
 
   char Str[18] = "";
   format("%02x", NSect).print(Str, sizeof(Str));
-  outs() << ' ' << Str << ' ';
+  OS << ' ' << Str << ' ';
   format("%04x", NDesc).print(Str, sizeof(Str));
-  outs() << Str << ' ';
+  OS << Str << ' ';
   if (const char *stabString = getDarwinStabString(NType))
     format("%5.5s", stabString).print(Str, sizeof(Str));
   else
     format("   %02x", NType).print(Str, sizeof(Str));
-  outs() << Str;
+  OS << Str;
 }
 
 static bool symbolIsDefined(const NMSymbol &Sym) {
   return Sym.TypeChar != 'U' && Sym.TypeChar != 'w' && Sym.TypeChar != 'v';
 }
 
-static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
-                                   const std::string &ArchiveName,
-                                   const std::string &ArchitectureName) {
-  if (!NoSort) {
-    std::function<bool(const NMSymbol &, const NMSymbol &)> Cmp;
-    if (NumericSort)
-      Cmp = compareSymbolAddress;
-    else if (SizeSort)
-      Cmp = compareSymbolSize;
-    else
-      Cmp = compareSymbolName;
-
-    if (ReverseSort)
-      Cmp = [=](const NMSymbol &A, const NMSymbol &B) { return Cmp(B, A); };
-    std::sort(SymbolList.begin(), SymbolList.end(), Cmp);
-  }
-
+static void printSymbolListHeader(raw_ostream &OS, SymbolicFile &Obj,
+                                  bool printName) {
+  StringRef CurrentFilename = Obj.getFileName();
   if (!PrintFileName) {
     if (OutputFormat == posix && MultipleFiles && printName) {
-      outs() << '\n' << CurrentFilename << ":\n";
+      OS << '\n' << CurrentFilename << ":\n";
     } else if (OutputFormat == bsd && MultipleFiles && printName) {
-      outs() << "\n" << CurrentFilename << ":\n";
+      OS << "\n" << CurrentFilename << ":\n";
     } else if (OutputFormat == sysv) {
-      outs() << "\n\nSymbols from " << CurrentFilename << ":\n\n"
-             << "Name                  Value   Class        Type"
-             << "         Size   Line  Section\n";
+      OS << "\n\nSymbols from " << CurrentFilename << ":\n\n"
+         << "Name                  Value   Class        Type"
+         << "         Size   Line  Section\n";
     }
   }
+}
 
+static void printSymbolList(raw_ostream &OS, SymbolicFile &Obj,
+                            SymbolListT &SymbolList,
+                            const std::string &ArchiveName,
+                            const std::string &ArchitectureName) {
+  StringRef CurrentFilename = Obj.getFileName();
   const char *printBlanks, *printDashes, *printFormat;
   if (isSymbolList64Bit(Obj)) {
     printBlanks = "                ";
@@ -663,18 +662,18 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
       continue;
     if (PrintFileName) {
       if (!ArchitectureName.empty())
-        outs() << "(for architecture " << ArchitectureName << "):";
+        OS << "(for architecture " << ArchitectureName << "):";
       if (OutputFormat == posix && !ArchiveName.empty())
-        outs() << ArchiveName << "[" << CurrentFilename << "]: ";
+        OS << ArchiveName << "[" << CurrentFilename << "]: ";
       else {
         if (!ArchiveName.empty())
-          outs() << ArchiveName << ":";
-        outs() << CurrentFilename << ": ";
+          OS << ArchiveName << ":";
+        OS << CurrentFilename << ": ";
       }
     }
     if ((JustSymbolName || (UndefinedOnly && isa<MachOObjectFile>(Obj) &&
                             OutputFormat != darwin)) && OutputFormat != posix) {
-      outs() << I->Name << "\n";
+      OS << I->Name << "\n";
       continue;
     }
 
@@ -711,35 +710,55 @@ static void sortAndPrintSymbolList(SymbolicFile &Obj, bool printName,
     // OutputFormat bsd (see below).
     MachOObjectFile *MachO = dyn_cast<MachOObjectFile>(&Obj);
     if ((OutputFormat == darwin || FormatMachOasHex) && (MachO || Obj.isIR())) {
-      darwinPrintSymbol(Obj, I, SymbolAddrStr, printBlanks, printDashes,
+      darwinPrintSymbol(OS, Obj, I, SymbolAddrStr, printBlanks, printDashes,
                         printFormat);
     } else if (OutputFormat == posix) {
-      outs() << I->Name << " " << I->TypeChar << " ";
+      OS << I->Name << " " << I->TypeChar << " ";
       if (MachO)
-        outs() << SymbolAddrStr << " " << "0" /* SymbolSizeStr */ << "\n";
+        OS << SymbolAddrStr << " " << "0" /* SymbolSizeStr */ << "\n";
       else
-        outs() << SymbolAddrStr << " " << SymbolSizeStr << "\n";
+        OS << SymbolAddrStr << " " << SymbolSizeStr << "\n";
     } else if (OutputFormat == bsd || (OutputFormat == darwin && !MachO)) {
       if (PrintAddress)
-        outs() << SymbolAddrStr << ' ';
+        OS << SymbolAddrStr << ' ';
       if (PrintSize) {
-        outs() << SymbolSizeStr;
-        outs() << ' ';
+        OS << SymbolSizeStr;
+        OS << ' ';
       }
-      outs() << I->TypeChar;
+      OS << I->TypeChar;
       if (I->TypeChar == '-' && MachO)
-        darwinPrintStab(MachO, I);
-      outs() << " " << I->Name << "\n";
+        darwinPrintStab(OS, MachO, I);
+      OS << " " << I->Name << "\n";
     } else if (OutputFormat == sysv) {
       std::string PaddedName(I->Name);
       while (PaddedName.length() < 20)
         PaddedName += " ";
-      outs() << PaddedName << "|" << SymbolAddrStr << "|   " << I->TypeChar
-             << "  |                  |" << SymbolSizeStr << "|     |\n";
+      OS << PaddedName << "|" << SymbolAddrStr << "|   " << I->TypeChar
+         << "  |                  |" << SymbolSizeStr << "|     |\n";
     }
   }
+}
+
+static void sortAndPrintSymbolList(raw_ostream &OS, SymbolicFile &Obj,
+                                   SymbolListT &SymbolList, bool printName,
+                                   const std::string &ArchiveName,
+                                   const std::string &ArchitectureName) {
+  if (!NoSort) {
+    std::function<bool(const NMSymbol &, const NMSymbol &)> Cmp;
+    if (NumericSort)
+      Cmp = compareSymbolAddress;
+    else if (SizeSort)
+      Cmp = compareSymbolSize;
+    else
+      Cmp = compareSymbolName;
+
+    if (ReverseSort)
+      Cmp = [=](const NMSymbol &A, const NMSymbol &B) { return Cmp(B, A); };
+    std::sort(SymbolList.begin(), SymbolList.end(), Cmp);
+  }
 
-  SymbolList.clear();
+  printSymbolListHeader(OS, Obj, printName);
+  printSymbolList(OS, Obj, SymbolList, ArchiveName, ArchitectureName);
 }
 
 static char getSymbolNMTypeChar(ELFObjectFileBase &Obj,
@@ -968,7 +987,7 @@ static unsigned getNsectInMachO(MachOObjectFile &Obj, BasicSymbolRef Sym) {
 }
 
 static void
-dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
+dumpSymbolNamesFromObject(raw_ostream &OS, SymbolicFile &Obj, bool printName,
                           const std::string &ArchiveName = std::string(),
                           const std::string &ArchitectureName = std::string()) {
   auto Symbols = Obj.symbols();
@@ -983,7 +1002,7 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
         make_range<basic_symbol_iterator>(DynSymbols.begin(), DynSymbols.end());
   }
   std::string NameBuffer;
-  raw_string_ostream OS(NameBuffer);
+  raw_string_ostream NameOS(NameBuffer);
   // If a "-s segname sectname" option was specified and this is a Mach-O
   // file get the section number for that section in this object file.
   unsigned int Nsect = 0;
@@ -994,6 +1013,11 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
     if (Nsect == 0)
       return;
   }
+  // Without sorting there is no need to hold on to the whole symbol table;
+  // each symbol is printed as soon as it has been read.
+  SymbolListT SymbolList;
+  if (NoSort)
+    printSymbolListHeader(OS, Obj, printName);
   for (BasicSymbolRef Sym : Symbols) {
     uint32_t SymFlags = Sym.getFlags();
     if (!DebugSyms && (SymFlags & SymbolRef::SF_FormatSpecific))
@@ -1022,25 +1046,35 @@ dumpSymbolNamesFromObject(SymbolicFile &Obj, bool printName,
       S.Address = *AddressOrErr;
     }
     S.TypeChar = getNMTypeChar(Obj, Sym);
-    std::error_code EC = Sym.printName(OS);
+    std::error_code EC = Sym.printName(NameOS);
     if (EC && MachO)
-      OS << "bad string index";
+      NameOS << "bad string index";
     else
       error(EC);
-    OS << '\0';
+    NameOS << '\0';
     S.Sym = Sym;
+    if (NoSort) {
+      NameOS.flush();
+      S.Name = NameBuffer.c_str();
+      SymbolList.assign(1, S);
+      printSymbolList(OS, Obj, SymbolList, ArchiveName, ArchitectureName);
+      NameBuffer.clear();
+      continue;
+    }
     SymbolList.push_back(S);
   }
+  if (NoSort)
+    return;
 
-  OS.flush();
+  NameOS.flush();
   const char *P = NameBuffer.c_str();
   for (unsigned I = 0; I < SymbolList.size(); ++I) {
     SymbolList[I].Name = P;
     P += strlen(P) + 1;
   }
 
-  CurrentFilename = Obj.getFileName();
-  sortAndPrintSymbolList(Obj, printName, ArchiveName, ArchitectureName);
+  sortAndPrintSymbolList(OS, Obj, SymbolList, printName, ArchiveName,
+                         ArchitectureName);
 }
 
 // checkMachOAndArchFlags() checks to see if the SymbolicFile is a Mach-O file
@@ -1073,7 +1107,66 @@ static bool checkMachOAndArchFlags(SymbolicFile *O, std::string &Filename) {
   return true;
 }
 
-static void dumpSymbolNamesFromFile(std::string &Filename) {
+// Dumps the symbols of one archive member. Returns false if no further members
+// should be dumped.
+static bool dumpArchiveMember(raw_ostream &OS, const Archive::Child &C,
+                              std::string &Filename, LLVMContext &Context) {
+  Expected<std::unique_ptr<Binary>> ChildOrErr = C.getAsBinary(&Context);
+  if (!ChildOrErr) {
+    if (auto E = isNotObjectErrorInvalidFileType(ChildOrErr.takeError()))
+      error(std::move(E), Filename, C);
+    return true;
+  }
+  if (SymbolicFile *O = dyn_cast<SymbolicFile>(&*ChildOrErr.get())) {
+    if (!checkMachOAndArchFlags(O, Filename))
+      return false;
+    if (!PrintFileName) {
+      OS << "\n";
+      if (isa<MachOObjectFile>(O)) {
+        OS << Filename << "(" << O->getFileName() << ")";
+      } else
+        OS << O->getFileName();
+      OS << ":\n";
+    }
+    dumpSymbolNamesFromObject(OS, *O, false, Filename);
+  }
+  return true;
+}
+
+// Dumps the members of an archive on NumThreads threads. The member buffers
+// are referenced in place from the mapped archive; each member's output is
+// collected separately and printed in archive order, so the result is the
+// same as dumping them one after another. Thin archives can't be dumped this
+// way, because loading a member of a thin archive adds its buffer to the
+// archive.
+static bool dumpArchiveMembersInParallel(raw_ostream &OS,
+                                         ArrayRef<Archive::Child> Children,
+                                         std::string &Filename) {
+  std::vector<std::string> Output(Children.size());
+  std::vector<char> Continue(Children.size());
+  std::atomic<size_t> NextMember(0);
+  {
+    ThreadPool Pool(NumThreads);
+    for (unsigned T = 0; T != NumThreads; ++T)
+      Pool.async([&] {
+        LLVMContext Context;
+        for (size_t I = NextMember++; I < Children.size(); I = NextMember++) {
+          raw_string_ostream MemberOS(Output[I]);
+          Continue[I] = dumpArchiveMember(MemberOS, Children[I], Filename,
+                                          Context);
+        }
+      });
+  }
+
+  for (size_t I = 0, E = Children.size(); I != E; ++I) {
+    OS << Output[I];
+    if (!Continue[I])
+      return false;
+  }
+  return true;
+}
+
+static void dumpSymbolNamesFromFile(raw_ostream &OS, std::string &Filename) {
   ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
       MemoryBuffer::getFileOrSTDIN(Filename);
   if (error(BufferOrErr.getError(), Filename))
@@ -1093,7 +1186,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
       Archive::symbol_iterator I = A->symbol_begin();
       Archive::symbol_iterator E = A->symbol_end();
       if (I != E) {
-        outs() << "Archive map\n";
+        OS << "Archive map\n";
         for (; I != E; ++I) {
           Expected<Archive::Child> C = I->getMember();
           if (!C)
@@ -1104,36 +1197,30 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             return;
           }
           StringRef SymName = I->getName();
-          outs() << SymName << " in " << FileNameOrErr.get() << "\n";
+          OS << SymName << " in " << FileNameOrErr.get() << "\n";
         }
-        outs() << "\n";
+        OS << "\n";
       }
     }
 
     {
       Error Err = Error::success();
-      for (auto &C : A->children(Err)) {
-        Expected<std::unique_ptr<Binary>> ChildOrErr = C.getAsBinary(&Context);
-        if (!ChildOrErr) {
-          if (auto E = isNotObjectErrorInvalidFileType(ChildOrErr.takeError()))
-            error(std::move(E), Filename, C);
-          continue;
-        }
-        if (SymbolicFile *O = dyn_cast<SymbolicFile>(&*ChildOrErr.get())) {
-          if (!checkMachOAndArchFlags(O, Filename))
-            return;
-          if (!PrintFileName) {
-            outs() << "\n";
-            if (isa<MachOObjectFile>(O)) {
-              outs() << Filename << "(" << O->getFileName() << ")";
-            } else
-              outs() << O->getFileName();
-            outs() << ":\n";
-          }
-          dumpSymbolNamesFromObject(*O, false, Filename);
-        }
-      }
-      if (Err)
+      std::vector<Archive::Child> Children;
+      for (auto &C : A->children(Err))
+        Children.push_back(C);
+      bool Stopped;
+      if (NumThreads > 1 && !MultipleFiles && !A->isThin() &&
+          Children.size() > 1)
+        Stopped = !dumpArchiveMembersInParallel(OS, Children, Filename);
+      else
+        Stopped = !std::all_of(Children.begin(), Children.end(),
+                               [&](const Archive::Child &C) {
+                                 return dumpArchiveMember(OS, C, Filename,
+                                                          Context);
+                               });
+      if (Stopped)
+        consumeError(std::move(Err));
+      else if (Err)
         error(std::move(Err), A->getFileName());
     }
     return;
@@ -1162,11 +1249,11 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchitectureName = I->getArchTypeName();
                 else
-                  outs() << "\n" << Obj.getFileName() << " (for architecture "
-                         << I->getArchTypeName() << ")"
-                         << ":\n";
+                  OS << "\n" << Obj.getFileName() << " (for architecture "
+                     << I->getArchTypeName() << ")"
+                     << ":\n";
               }
-              dumpSymbolNamesFromObject(Obj, false, ArchiveName,
+              dumpSymbolNamesFromObject(OS, Obj, false, ArchiveName,
                                         ArchitectureName);
             } else if (auto E = isNotObjectErrorInvalidFileType(
                        ObjOrErr.takeError())) {
@@ -1195,15 +1282,15 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                     if (ArchFlags.size() > 1)
                       ArchitectureName = I->getArchTypeName();
                   } else {
-                    outs() << "\n" << A->getFileName();
-                    outs() << "(" << O->getFileName() << ")";
+                    OS << "\n" << A->getFileName();
+                    OS << "(" << O->getFileName() << ")";
                     if (ArchFlags.size() > 1) {
-                      outs() << " (for architecture " << I->getArchTypeName()
-                             << ")";
+                      OS << " (for architecture " << I->getArchTypeName()
+                         << ")";
                     }
-                    outs() << ":\n";
+                    OS << ":\n";
                   }
-                  dumpSymbolNamesFromObject(*O, false, ArchiveName,
+                  dumpSymbolNamesFromObject(OS, *O, false, ArchiveName,
                                             ArchitectureName);
                 }
               }
@@ -1239,7 +1326,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
           ArchiveName.clear();
           if (ObjOrErr) {
             ObjectFile &Obj = *ObjOrErr.get();
-            dumpSymbolNamesFromObject(Obj, false);
+            dumpSymbolNamesFromObject(OS, Obj, false);
           } else if (auto E = isNotObjectErrorInvalidFileType(
                      ObjOrErr.takeError())) {
             error(std::move(E), Filename);
@@ -1262,10 +1349,10 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
                 if (PrintFileName)
                   ArchiveName = A->getFileName();
                 else
-                  outs() << "\n" << A->getFileName() << "(" << O->getFileName()
-                         << ")"
-                         << ":\n";
-                dumpSymbolNamesFromObject(*O, false, ArchiveName);
+                  OS << "\n" << A->getFileName() << "(" << O->getFileName()
+                     << ")"
+                     << ":\n";
+                dumpSymbolNamesFromObject(OS, *O, false, ArchiveName);
               }
             }
             if (Err)
@@ -1299,13 +1386,14 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
             ArchitectureName = I->getArchTypeName();
         } else {
           if (moreThanOneArch)
-            outs() << "\n";
-          outs() << Obj.getFileName();
+            OS << "\n";
+          OS << Obj.getFileName();
           if (isa<MachOObjectFile>(Obj) && moreThanOneArch)
-            outs() << " (for architecture " << I->getArchTypeName() << ")";
-          outs() << ":\n";
+            OS << " (for architecture " << I->getArchTypeName() << ")";
+          OS << ":\n";
         }
-        dumpSymbolNamesFromObject(Obj, false, ArchiveName, ArchitectureName);
+        dumpSymbolNamesFromObject(OS, Obj, false, ArchiveName,
+                                  ArchitectureName);
       } else if (auto E = isNotObjectErrorInvalidFileType(
                  ObjOrErr.takeError())) {
         error(std::move(E), Filename, moreThanOneArch ?
@@ -1331,17 +1419,18 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
               if (isa<MachOObjectFile>(O) && moreThanOneArch)
                 ArchitectureName = I->getArchTypeName();
             } else {
-              outs() << "\n" << A->getFileName();
+              OS << "\n" << A->getFileName();
               if (isa<MachOObjectFile>(O)) {
-                outs() << "(" << O->getFileName() << ")";
+                OS << "(" << O->getFileName() << ")";
                 if (moreThanOneArch)
-                  outs() << " (for architecture " << I->getArchTypeName()
-                         << ")";
+                  OS << " (for architecture " << I->getArchTypeName()
+                     << ")";
               } else
-                outs() << ":" << O->getFileName();
-              outs() << ":\n";
+                OS << ":" << O->getFileName();
+              OS << ":\n";
             }
-            dumpSymbolNamesFromObject(*O, false, ArchiveName, ArchitectureName);
+            dumpSymbolNamesFromObject(OS, *O, false, ArchiveName,
+                                      ArchitectureName);
           }
         }
         if (Err)
@@ -1359,7 +1448,7 @@ static void dumpSymbolNamesFromFile(std::string &Filename) {
   if (SymbolicFile *O = dyn_cast<SymbolicFile>(&Bin)) {
     if (!checkMachOAndArchFlags(O, Filename))
       return;
-    dumpSymbolNamesFromObject(*O, true);
+    dumpSymbolNamesFromObject(OS, *O, true);
   }
 }
 
@@ -1414,8 +1503,26 @@ int main(int argc, char **argv) {
     error("bad number of arguments (must be two arguments)",
           "for the -s option");
 
-  std::for_each(InputFilenames.begin(), InputFilenames.end(),
-                dumpSymbolNamesFromFile);
+  if (NumThreads > 1 && MultipleFiles) {
+    // Dump the files concurrently, but print their output in command line
+    // order.
+    ThreadPool Pool(NumThreads);
+    std::vector<std::string> Output(InputFilenames.size());
+    std::vector<std::shared_future<void>> Done;
+    for (size_t I = 0, E = InputFilenames.size(); I != E; ++I)
+      Done.push_back(Pool.async([&, I] {
+        raw_string_ostream OS(Output[I]);
+        dumpSymbolNamesFromFile(OS, InputFilenames[I]);
+      }));
+    for (size_t I = 0, E = InputFilenames.size(); I != E; ++I) {
+      Done[I].wait();
+      outs() << Output[I];
+      std::string().swap(Output[I]);
+    }
+  } else {
+    for (std::string &Filename : InputFilenames)
+      dumpSymbolNamesFromFile(outs(), Filename);
+  }
 
   if (HadError)
     return 1;
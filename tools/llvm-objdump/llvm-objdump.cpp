@@ -56,8 +56,10 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstring>
 #include <system_error>
@@ -211,6 +213,12 @@ cl::opt<unsigned long long>
 cl::opt<unsigned long long>
     StopAddress("stop-address", cl::desc("Stop disassembly at address"),
                 cl::value_desc("address"), cl::init(UINT64_MAX));
+
+static cl::opt<unsigned> DisassembleThreads(
+    "threads", cl::init(1),
+    cl::desc("Number of threads used to disassemble each section "
+             "(default = 1)"));
+
 static StringRef ToolName;
 
 namespace {
@@ -1068,6 +1076,17 @@ static uint8_t getElfSymbolType(const ObjectFile *Obj, const SymbolRef &Sym) {
   llvm_unreachable("Unsupported binary format");
 }
 
+namespace {
+/// A disassembler and instruction printer for one disassembly thread.
+struct DisassemblerTools {
+  std::unique_ptr<MCObjectFileInfo> MOFI;
+  std::unique_ptr<MCContext> Ctx;
+  std::unique_ptr<MCDisassembler> DisAsm;
+  std::unique_ptr<MCInstPrinter> IP;
+  std::unique_ptr<const MCInstrAnalysis> MIA;
+};
+}
+
 static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   if (StartAddress > StopAddress)
     error("Start address should be less than stop address");
@@ -1125,6 +1144,27 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
   IP->setPrintImmHex(PrintImmHex);
   PrettyPrinter &PIP = selectPrettyPrinter(Triple(TripleName));
 
+  // With -threads, give every thread its own disassembler and
+  // instruction printer. Printing source lines goes through a shared
+  // symbolizer, and the AMDGPU disassembler is given a symbolizer per
+  // section, so those are disassembled serially.
+  std::vector<DisassemblerTools> ThreadTools;
+  if (DisassembleThreads > 1 && !PrintSource && !PrintLines &&
+      !(Obj->isELF() && Obj->getArch() == Triple::amdgcn)) {
+    ThreadTools.resize(DisassembleThreads);
+    for (DisassemblerTools &T : ThreadTools) {
+      T.MOFI.reset(new MCObjectFileInfo());
+      T.Ctx.reset(new MCContext(AsmInfo.get(), MRI.get(), T.MOFI.get()));
+      T.MOFI->InitMCObjectFileInfo(Triple(TripleName), false,
+                                   CodeModel::Default, *T.Ctx);
+      T.DisAsm.reset(TheTarget->createMCDisassembler(*STI, *T.Ctx));
+      T.IP.reset(TheTarget->createMCInstPrinter(
+          Triple(TripleName), AsmPrinterVariant, *AsmInfo, *MII, *MRI));
+      T.IP->setPrintImmHex(PrintImmHex);
+      T.MIA.reset(TheTarget->createMCInstrAnalysis(MII.get()));
+    }
+  }
+
   StringRef Fmt = Obj->getBytesInAddress() > 4 ? "\t\t%016" PRIx64 ":  " :
                                                  "\t\t\t%08" PRIx64 ":  ";
 
@@ -1289,21 +1329,28 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                                                             : ELF::STT_OBJECT));
     }
 
-    SmallString<40> Comments;
-    raw_svector_ostream CommentStream(Comments);
-
     StringRef BytesStr;
     error(Section.getContents(BytesStr));
     ArrayRef<uint8_t> Bytes(reinterpret_cast<const uint8_t *>(BytesStr.data()),
                             BytesStr.size());
 
-    uint64_t Size;
-    uint64_t Index;
+    typedef std::vector<RelocationRef>::const_iterator RelocIterator;
+    RelocIterator rel_end = Rels.end();
+    unsigned se = Symbols.size();
+
+    // Disassemble the symbol Symbols[si] to OS. rel_cur is the first
+    // relocation that hasn't been printed yet, and is advanced past the ones
+    // printed here.
+    auto DisassembleSymbol = [&](unsigned si, raw_ostream &OS,
+                                 MCDisassembler &DisAsm, MCInstPrinter &IP,
+                                 const MCInstrAnalysis *MIA,
+                                 RelocIterator &rel_cur) {
+      SmallString<40> Comments;
+      raw_svector_ostream CommentStream(Comments);
+
+      uint64_t Size;
+      uint64_t Index;
 
-    std::vector<RelocationRef>::const_iterator rel_cur = Rels.begin();
-    std::vector<RelocationRef>::const_iterator rel_end = Rels.end();
-    // Disassemble symbol by symbol.
-    for (unsigned si = 0, se = Symbols.size(); si != se; ++si) {
       uint64_t Start = std::get<0>(Symbols[si]) - SectionAddr;
       // The end is either the section end or the beginning of the next
       // symbol.
@@ -1314,13 +1361,13 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         End = SectSize;
       // If this symbol has the same address as the next symbol, then skip it.
       if (Start >= End)
-        continue;
+        return;
 
       // Check if we need to skip symbol
       // Skip if the symbol's data is not between StartAddress and StopAddress
       if (End + SectionAddr < StartAddress ||
           Start + SectionAddr > StopAddress) {
-        continue;
+        return;
       }
 
       // Stop disassembly at the stop address specified
@@ -1346,7 +1393,7 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
         }
       }
 
-      outs() << '\n' << std::get<1>(Symbols[si]) << ":\n";
+      OS << '\n' << std::get<1>(Symbols[si]) << ":\n";
 
 #ifndef NDEBUG
       raw_ostream &DebugOut = DebugFlag ? dbgs() : nulls();
@@ -1376,12 +1423,12 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
           if (DAI != DataMappingSymsAddr.end() && *DAI == Index) {
             // Switch to data.
             while (Index < End) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
+              OS << format("%8" PRIx64 ":", SectionAddr + Index);
+              OS << "\t";
               if (Index + 4 <= End) {
                 Stride = 4;
-                dumpBytes(Bytes.slice(Index, 4), outs());
-                outs() << "\t.word\t";
+                dumpBytes(Bytes.slice(Index, 4), OS);
+                OS << "\t.word\t";
                 uint32_t Data = 0;
                 if (Obj->isLittleEndian()) {
                   const auto Word =
@@ -1393,11 +1440,11 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                       Bytes.data() + Index);
                   Data = *Word;
                 }
-                outs() << "0x" << format("%08" PRIx32, Data);
+                OS << "0x" << format("%08" PRIx32, Data);
               } else if (Index + 2 <= End) {
                 Stride = 2;
-                dumpBytes(Bytes.slice(Index, 2), outs());
-                outs() << "\t\t.short\t";
+                dumpBytes(Bytes.slice(Index, 2), OS);
+                OS << "\t\t.short\t";
                 uint16_t Data = 0;
                 if (Obj->isLittleEndian()) {
                   const auto Short =
@@ -1410,15 +1457,15 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                                                                   Index);
                   Data = *Short;
                 }
-                outs() << "0x" << format("%04" PRIx16, Data);
+                OS << "0x" << format("%04" PRIx16, Data);
               } else {
                 Stride = 1;
-                dumpBytes(Bytes.slice(Index, 1), outs());
-                outs() << "\t\t.byte\t";
-                outs() << "0x" << format("%02" PRIx8, Bytes.slice(Index, 1)[0]);
+                dumpBytes(Bytes.slice(Index, 1), OS);
+                OS << "\t\t.byte\t";
+                OS << "0x" << format("%02" PRIx8, Bytes.slice(Index, 1)[0]);
               }
               Index += Stride;
-              outs() << "\n";
+              OS << "\n";
               auto TAI = std::lower_bound(TextMappingSymsAddr.begin(),
                                           TextMappingSymsAddr.end(), Index);
               if (TAI != TextMappingSymsAddr.end() && *TAI == Index)
@@ -1443,11 +1490,11 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                 ((SectionAddr + Index) > StopAddress))
               continue;
             if (NumBytes == 0) {
-              outs() << format("%8" PRIx64 ":", SectionAddr + Index);
-              outs() << "\t";
+              OS << format("%8" PRIx64 ":", SectionAddr + Index);
+              OS << "\t";
             }
             Byte = Bytes.slice(Index)[0];
-            outs() << format(" %02x", Byte);
+            OS << format(" %02x", Byte);
             AsciiData[NumBytes] = isprint(Byte) ? Byte : '.';
 
             uint8_t IndentOffset = 0;
@@ -1462,9 +1509,9 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
             }
             if (NumBytes == 8) {
               AsciiData[8] = '\0';
-              outs() << std::string(IndentOffset, ' ') << "         ";
-              outs() << reinterpret_cast<char *>(AsciiData);
-              outs() << '\n';
+              OS << std::string(IndentOffset, ' ') << "         ";
+              OS << reinterpret_cast<char *>(AsciiData);
+              OS << '\n';
               NumBytes = 0;
             }
           }
@@ -1474,16 +1521,16 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
 
         // Disassemble a real instruction or a data when disassemble all is
         // provided
-        bool Disassembled = DisAsm->getInstruction(Inst, Size, Bytes.slice(Index),
-                                                   SectionAddr + Index, DebugOut,
-                                                   CommentStream);
+        bool Disassembled = DisAsm.getInstruction(Inst, Size, Bytes.slice(Index),
+                                                  SectionAddr + Index, DebugOut,
+                                                  CommentStream);
         if (Size == 0)
           Size = 1;
 
-        PIP.printInst(*IP, Disassembled ? &Inst : nullptr,
-                      Bytes.slice(Index, Size), SectionAddr + Index, outs(), "",
+        PIP.printInst(IP, Disassembled ? &Inst : nullptr,
+                      Bytes.slice(Index, Size), SectionAddr + Index, OS, "",
                       *STI, &SP);
-        outs() << CommentStream.str();
+        OS << CommentStream.str();
         Comments.clear();
 
         // Try to resolve the target of a call, tail call, etc. to a specific
@@ -1509,7 +1556,9 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                   });
               if (SectionAddress != SectionAddresses.begin()) {
                 --SectionAddress;
-                TargetSectionSymbols = &AllSymbols[SectionAddress->second];
+                auto It = AllSymbols.find(SectionAddress->second);
+                TargetSectionSymbols =
+                    It == AllSymbols.end() ? nullptr : &It->second;
               } else {
                 TargetSectionSymbols = nullptr;
               }
@@ -1528,16 +1577,16 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
                 --TargetSym;
                 uint64_t TargetAddress = std::get<0>(*TargetSym);
                 StringRef TargetName = std::get<1>(*TargetSym);
-                outs() << " <" << TargetName;
+                OS << " <" << TargetName;
                 uint64_t Disp = Target - TargetAddress;
                 if (Disp)
-                  outs() << "+0x" << utohexstr(Disp);
-                outs() << '>';
+                  OS << "+0x" << utohexstr(Disp);
+                OS << '>';
               }
             }
           }
         }
-        outs() << "\n";
+        OS << "\n";
 
         // Print relocation for instruction.
         while (rel_cur != rel_end) {
@@ -1556,11 +1605,60 @@ static void DisassembleObject(const ObjectFile *Obj, bool InlineRelocs) {
           if (addr >= Index + Size) break;
           rel_cur->getTypeName(name);
           error(getRelocationValueString(*rel_cur, val));
-          outs() << format(Fmt.data(), SectionAddr + addr) << name
+          OS << format(Fmt.data(), SectionAddr + addr) << name
                  << "\t" << val << "\n";
           ++rel_cur;
         }
       }
+
+    };
+
+    RelocIterator rel_cur = Rels.begin();
+    if (ThreadTools.empty() || se < 2) {
+      // Disassemble symbol by symbol.
+      for (unsigned si = 0; si != se; ++si)
+        DisassembleSymbol(si, outs(), *DisAsm, *IP, MIA.get(), rel_cur);
+      continue;
+    }
+
+    // Disassemble the symbols in parallel into separate buffers. The
+    // relocations of a symbol are assumed to start at the first printable
+    // one at or after its start address. If the symbol before it stopped
+    // somewhere else, it is disassembled again from the right relocation, so
+    // the output is the same as disassembling serially.
+    std::vector<std::string> Output(se);
+    std::vector<RelocIterator> RelBegin(se), RelEnd(se);
+    std::atomic<unsigned> NextSymbol(0);
+    ThreadPool Pool(ThreadTools.size());
+    for (DisassemblerTools &T : ThreadTools)
+      Pool.async([&]() {
+        for (unsigned si = NextSymbol++; si < se; si = NextSymbol++) {
+          uint64_t Start = std::get<0>(Symbols[si]) - SectionAddr;
+          RelocIterator Begin = std::lower_bound(
+              Rels.cbegin(), rel_end, Start,
+              [](const RelocationRef &R, uint64_t Offset) {
+                return R.getOffset() < Offset;
+              });
+          while (Begin != rel_end &&
+                 (getHidden(*Begin) ||
+                  SectionAddr + Begin->getOffset() < StartAddress))
+            ++Begin;
+          RelBegin[si] = RelEnd[si] = Begin;
+          raw_string_ostream OS(Output[si]);
+          DisassembleSymbol(si, OS, *T.DisAsm, *T.IP, T.MIA.get(), RelEnd[si]);
+        }
+      });
+    Pool.wait();
+
+    for (unsigned si = 0; si != se; ++si) {
+      if (RelBegin[si] == rel_cur) {
+        rel_cur = RelEnd[si];
+      } else {
+        Output[si].clear();
+        raw_string_ostream OS(Output[si]);
+        DisassembleSymbol(si, OS, *DisAsm, *IP, MIA.get(), rel_cur);
+      }
+      outs() << Output[si];
     }
   }
 }
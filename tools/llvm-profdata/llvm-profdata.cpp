@@ -35,7 +35,13 @@
 
 using namespace llvm;
 
-enum ProfileFormat { PF_None = 0, PF_Text, PF_Binary, PF_GCC };
+enum ProfileFormat {
+  PF_None = 0,
+  PF_Text,
+  PF_Binary,
+  PF_GCC,
+  PF_Compact_Binary
+};
 
 static void exitWithError(const Twine &Message, StringRef Whence = "",
                           StringRef Hint = "") {
@@ -115,51 +121,95 @@ struct WeightedFile {
 typedef SmallVector<WeightedFile, 5> WeightedFileVector;
 
 /// Keep track of merged data and reported errors.
+///
+/// The merged profile is split into shards by function name, each with its
+/// own writer and lock. Inputs are loaded concurrently and every record goes
+/// straight into the shard that owns its function, so each function is held
+/// in memory once, however many inputs and threads there are, and a reader
+/// only ever holds the record it is currently adding.
 struct WriterContext {
+  struct Shard {
+    std::mutex Lock;
+    InstrProfWriter Writer;
+
+    Shard(bool IsSparse) : Writer(IsSparse) {}
+  };
+  std::vector<std::unique_ptr<Shard>> Shards;
+
+  /// Guards the hard error.
   std::mutex Lock;
-  InstrProfWriter Writer;
   Error Err;
-  StringRef ErrWhence;
+  std::string ErrWhence;
   std::mutex &ErrLock;
   SmallSet<instrprof_error, 4> &WriterErrorCodes;
 
-  WriterContext(bool IsSparse, std::mutex &ErrLock,
+  WriterContext(unsigned NumShards, bool IsSparse, std::mutex &ErrLock,
                 SmallSet<instrprof_error, 4> &WriterErrorCodes)
-      : Lock(), Writer(IsSparse), Err(Error::success()), ErrWhence(""),
-        ErrLock(ErrLock), WriterErrorCodes(WriterErrorCodes) {}
+      : Lock(), Err(Error::success()), ErrLock(ErrLock),
+        WriterErrorCodes(WriterErrorCodes) {
+    for (unsigned I = 0; I < NumShards; ++I)
+      Shards.emplace_back(llvm::make_unique<Shard>(IsSparse));
+  }
+
+  Shard &getShard(StringRef FuncName) {
+    return *Shards[hash_value(FuncName) % Shards.size()];
+  }
+
+  /// Record a hard error for \p Whence, unless there already is one.
+  void setError(Error E, StringRef Whence) {
+    std::unique_lock<std::mutex> Guard{Lock};
+    if (Err) {
+      consumeError(std::move(E));
+      return;
+    }
+    Err = std::move(E);
+    ErrWhence = Whence;
+  }
+
+  bool hasError() {
+    std::unique_lock<std::mutex> Guard{Lock};
+    return bool(Err);
+  }
 };
 
 /// Load an input into a writer context.
 static void loadInput(const WeightedFile &Input, WriterContext *WC) {
-  std::unique_lock<std::mutex> CtxGuard{WC->Lock};
-
   // If there's a pending hard error, don't do more work.
-  if (WC->Err)
+  if (WC->hasError())
     return;
 
-  WC->ErrWhence = Input.Filename;
-
   auto ReaderOrErr = InstrProfReader::create(Input.Filename);
   if (Error E = ReaderOrErr.takeError()) {
     // Skip the empty profiles by returning sliently.
     instrprof_error IPE = InstrProfError::take(std::move(E));
     if (IPE != instrprof_error::empty_raw_profile)
-      WC->Err = make_error<InstrProfError>(IPE);
+      WC->setError(make_error<InstrProfError>(IPE), Input.Filename);
     return;
   }
 
   auto Reader = std::move(ReaderOrErr.get());
   bool IsIRProfile = Reader->isIRLevelProfile();
-  if (WC->Writer.setIsIRLevelProfile(IsIRProfile)) {
-    WC->Err = make_error<StringError>(
-        "Merge IR generated profile with Clang generated profile.",
-        std::error_code());
+  // Only the first shard's writer is written out, so it alone tracks the
+  // kind of profile.
+  WriterContext::Shard &First = *WC->Shards[0];
+  std::unique_lock<std::mutex> FirstGuard{First.Lock};
+  Error KindErr = First.Writer.setIsIRLevelProfile(IsIRProfile);
+  FirstGuard.unlock();
+  if (KindErr) {
+    consumeError(std::move(KindErr));
+    WC->setError(make_error<StringError>(
+                     "Merge IR generated profile with Clang generated profile.",
+                     std::error_code()),
+                 Input.Filename);
     return;
   }
 
   for (auto &I : *Reader) {
     const StringRef FuncName = I.Name;
-    if (Error E = WC->Writer.addRecord(std::move(I), Input.Weight)) {
+    WriterContext::Shard &S = WC->getShard(FuncName);
+    std::unique_lock<std::mutex> ShardGuard{S.Lock};
+    if (Error E = S.Writer.addRecord(std::move(I), Input.Weight)) {
+      ShardGuard.unlock();
       // Only show hint the first time an error occurs.
       instrprof_error IPE = InstrProfError::take(std::move(E));
       std::unique_lock<std::mutex> ErrGuard{WC->ErrLock};
@@ -169,13 +219,7 @@ static void loadInput(const WeightedFile &Input, WriterContext *WC) {
     }
   }
   if (Reader->hasError())
-    WC->Err = Reader->getError();
-}
-
-/// Merge the \p Src writer context into \p Dst.
-static void mergeWriterContexts(WriterContext *Dst, WriterContext *Src) {
-  if (Error E = Dst->Writer.mergeRecordsFromWriter(std::move(Src->Writer)))
-    Dst->Err = std::move(E);
+    WC->setError(Reader->getError(), Input.Filename);
 }
 
 static void mergeInstrProfile(const WeightedFileVector &Inputs,
@@ -201,51 +245,35 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
     NumThreads = std::max(1U, std::min(std::thread::hardware_concurrency(),
                                        unsigned(Inputs.size() / 2)));
 
-  // Initialize the writer contexts.
-  SmallVector<std::unique_ptr<WriterContext>, 4> Contexts;
-  for (unsigned I = 0; I < NumThreads; ++I)
-    Contexts.emplace_back(llvm::make_unique<WriterContext>(
-        OutputSparse, ErrorLock, WriterErrorCodes));
+  // Use several shards per thread to keep lock contention low.
+  WriterContext WC(NumThreads == 1 ? 1 : NumThreads * 8, OutputSparse,
+                   ErrorLock, WriterErrorCodes);
 
   if (NumThreads == 1) {
     for (const auto &Input : Inputs)
-      loadInput(Input, Contexts[0].get());
+      loadInput(Input, &WC);
   } else {
+    // At most NumThreads inputs are open at a time.
     ThreadPool Pool(NumThreads);
-
-    // Load the inputs in parallel (N/NumThreads serial steps).
-    unsigned Ctx = 0;
-    for (const auto &Input : Inputs) {
-      Pool.async(loadInput, Input, Contexts[Ctx].get());
-      Ctx = (Ctx + 1) % NumThreads;
-    }
+    for (const auto &Input : Inputs)
+      Pool.async(loadInput, Input, &WC);
     Pool.wait();
-
-    // Merge the writer contexts together (~ lg(NumThreads) serial steps).
-    unsigned Mid = Contexts.size() / 2;
-    unsigned End = Contexts.size();
-    assert(Mid > 0 && "Expected more than one context");
-    do {
-      for (unsigned I = 0; I < Mid; ++I)
-        Pool.async(mergeWriterContexts, Contexts[I].get(),
-                   Contexts[I + Mid].get());
-      Pool.wait();
-      if (End & 1) {
-        Pool.async(mergeWriterContexts, Contexts[0].get(),
-                   Contexts[End - 1].get());
-        Pool.wait();
-      }
-      End = Mid;
-      Mid /= 2;
-    } while (Mid > 0);
   }
 
   // Handle deferred hard errors encountered during merging.
-  for (std::unique_ptr<WriterContext> &WC : Contexts)
-    if (WC->Err)
-      exitWithError(std::move(WC->Err), WC->ErrWhence);
+  if (WC.Err)
+    exitWithError(std::move(WC.Err), WC.ErrWhence);
+
+  // The shards hold disjoint sets of functions; move them all into the first
+  // one, releasing each as soon as it has been moved.
+  InstrProfWriter &Writer = WC.Shards[0]->Writer;
+  for (unsigned I = 1, N = WC.Shards.size(); I < N; ++I) {
+    if (Error E = Writer.mergeRecordsFromWriter(
+            std::move(WC.Shards[I]->Writer)))
+      exitWithError(std::move(E));
+    WC.Shards[I].reset();
+  }
 
-  InstrProfWriter &Writer = Contexts[0]->Writer;
   if (OutputFormat == PF_Text)
     Writer.writeText(Output);
   else
@@ -254,7 +282,7 @@ static void mergeInstrProfile(const WeightedFileVector &Inputs,
 
 static sampleprof::SampleProfileFormat FormatMap[] = {
     sampleprof::SPF_None, sampleprof::SPF_Text, sampleprof::SPF_Binary,
-    sampleprof::SPF_GCC};
+    sampleprof::SPF_GCC, sampleprof::SPF_Compact_Binary};
 
 static void mergeSampleProfile(const WeightedFileVector &Inputs,
                                StringRef OutputFilename,
@@ -269,6 +297,7 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
   StringMap<FunctionSamples> ProfileMap;
   SmallVector<std::unique_ptr<sampleprof::SampleProfileReader>, 5> Readers;
   LLVMContext Context;
+  bool UseMD5 = false;
   for (const auto &Input : Inputs) {
     auto ReaderOrErr = SampleProfileReader::create(Input.Filename, Context);
     if (std::error_code EC = ReaderOrErr.getError())
@@ -283,6 +312,14 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
     if (std::error_code EC = Reader->read())
       exitWithErrorCode(EC, Input.Filename);
 
+    // A hashed name can't be matched with the name it was computed from.
+    if (Readers.size() == 1)
+      UseMD5 = Reader->useMD5();
+    else if (Reader->useMD5() != UseMD5)
+      exitWithError("cannot merge profiles with MD5 function names and "
+                    "profiles with plain function names",
+                    Input.Filename);
+
     StringMap<FunctionSamples> &Profiles = Reader->getProfiles();
     for (StringMap<FunctionSamples>::iterator I = Profiles.begin(),
                                               E = Profiles.end();
@@ -296,6 +333,8 @@ static void mergeSampleProfile(const WeightedFileVector &Inputs,
       }
     }
   }
+  if (UseMD5)
+    Writer->setUseMD5();
   Writer->write(ProfileMap);
 }
 
@@ -403,6 +442,10 @@ static int merge_main(int argc, const char *argv[]) {
   cl::opt<ProfileFormat> OutputFormat(
       cl::desc("Format of output profile"), cl::init(PF_Binary),
       cl::values(clEnumValN(PF_Binary, "binary", "Binary encoding (default)"),
+                 clEnumValN(PF_Compact_Binary, "compbinary",
+                            "Compact binary encoding with MD5 names and a "
+                            "function offset table (only meaningful for "
+                            "-sample)"),
                  clEnumValN(PF_Text, "text", "Text encoding"),
                  clEnumValN(PF_GCC, "gcc",
                             "GCC encoding (only meaningful for -sample)")));
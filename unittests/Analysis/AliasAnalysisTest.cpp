@@ -84,7 +84,10 @@ struct TestCustomAAResult : AAResultBase<TestCustomAAResult> {
   TestCustomAAResult(TestCustomAAResult &&Arg)
       : AAResultBase(std::move(Arg)), CB(std::move(Arg.CB)) {}
 
-  bool invalidate(Function &, const PreservedAnalyses &) { return false; }
+  bool invalidate(Function &, const PreservedAnalyses &,
+                  FunctionAnalysisManager::Invalidator &) {
+    return false;
+  }
 
   AliasResult alias(const MemoryLocation &LocA, const MemoryLocation &LocB) {
     CB();
@@ -94,6 +97,27 @@ struct TestCustomAAResult : AAResultBase<TestCustomAAResult> {
 }
 
 namespace {
+/// An analysis for the new pass manager that produces the above custom AA
+/// result.
+class TestCustomAAAnalysis : public AnalysisInfoMixin<TestCustomAAAnalysis> {
+  friend AnalysisInfoMixin<TestCustomAAAnalysis>;
+  static AnalysisKey Key;
+
+  std::function<void()> CB;
+
+public:
+  typedef TestCustomAAResult Result;
+
+  explicit TestCustomAAAnalysis(std::function<void()> CB)
+      : CB(std::move(CB)) {}
+
+  TestCustomAAResult run(Function &, FunctionAnalysisManager &) {
+    return TestCustomAAResult(CB);
+  }
+};
+
+AnalysisKey TestCustomAAAnalysis::Key;
+
 /// A wrapper pass for the legacy pass manager to use with the above custom AA
 /// result.
 class TestCustomAAWrapperPass : public ImmutablePass {
@@ -204,6 +228,92 @@ TEST_F(AliasAnalysisTest, getModRefInfo) {
   EXPECT_EQ(AA.getModRefInfo(AtomicRMW), MRI_ModRef);
 }
 
+TEST_F(AliasAnalysisTest, QueryCache) {
+  // Setup function.
+  FunctionType *FTy =
+      FunctionType::get(Type::getVoidTy(C), std::vector<Type *>(), false);
+  auto *F = cast<Function>(M.getOrInsertFunction("f", FTy));
+  auto *BB = BasicBlock::Create(C, "entry", F);
+  auto IntType = Type::getInt32Ty(C);
+  auto *A1 = new AllocaInst(IntType, "a1", BB);
+  auto *A2 = new AllocaInst(IntType, "a2", BB);
+  auto *Ret = ReturnInst::Create(C, nullptr, BB);
+
+  unsigned NumQueries = 0;
+  TestCustomAAResult CustomAA([&] { ++NumQueries; });
+  AAResults AAR(TLI);
+  AAR.addAAResult(CustomAA);
+  AAR.setQueryCacheEnabled(true);
+
+  // Repeated and swapped queries are answered from the cache.
+  EXPECT_EQ(AAR.alias(A1, A2), MayAlias);
+  EXPECT_EQ(AAR.alias(A1, A2), MayAlias);
+  EXPECT_EQ(AAR.alias(A2, A1), MayAlias);
+  EXPECT_EQ(AAR.alias(A1, A1), MayAlias);
+  EXPECT_EQ(NumQueries, 2U);
+
+  // Deleting a queried value drops every cached result.
+  A2->eraseFromParent();
+  EXPECT_EQ(AAR.alias(A1, A1), MayAlias);
+  EXPECT_EQ(NumQueries, 3U);
+
+  auto *A3 = new AllocaInst(IntType, "a3", Ret);
+  EXPECT_EQ(AAR.alias(A1, A3), MayAlias);
+  AAR.clearQueryCache();
+  EXPECT_EQ(AAR.alias(A1, A3), MayAlias);
+  EXPECT_EQ(NumQueries, 5U);
+
+  // Nothing is cached while the cache is disabled.
+  AAR.setQueryCacheEnabled(false);
+  EXPECT_EQ(AAR.alias(A1, A3), MayAlias);
+  EXPECT_EQ(AAR.alias(A1, A3), MayAlias);
+  EXPECT_EQ(NumQueries, 7U);
+}
+
+TEST_F(AliasAnalysisTest, QueryCacheInvalidation) {
+  // Setup function.
+  FunctionType *FTy =
+      FunctionType::get(Type::getVoidTy(C), std::vector<Type *>(), false);
+  auto *F = cast<Function>(M.getOrInsertFunction("f", FTy));
+  auto *BB = BasicBlock::Create(C, "entry", F);
+  auto IntType = Type::getInt32Ty(C);
+  auto *A1 = new AllocaInst(IntType, "a1", BB);
+  auto *A2 = new AllocaInst(IntType, "a2", BB);
+  ReturnInst::Create(C, nullptr, BB);
+
+  unsigned NumQueries = 0;
+  FunctionAnalysisManager FAM;
+  FAM.registerPass([] { return TargetLibraryAnalysis(); });
+  FAM.registerPass([&] { return TestCustomAAAnalysis([&] { ++NumQueries; }); });
+  FAM.registerPass([] {
+    AAManager AA;
+    AA.registerFunctionAnalysis<TestCustomAAAnalysis>();
+    return AA;
+  });
+
+  AAResults &AAR = FAM.getResult<AAManager>(*F);
+  AAR.setQueryCacheEnabled(true);
+  EXPECT_EQ(AAR.alias(A1, A2), MayAlias);
+  EXPECT_EQ(AAR.alias(A1, A2), MayAlias);
+  EXPECT_EQ(NumQueries, 1U);
+
+  // A pass that changed nothing keeps the cached results.
+  FAM.invalidate(*F, PreservedAnalyses::all());
+  EXPECT_EQ(AAR.alias(A1, A2), MayAlias);
+  EXPECT_EQ(NumQueries, 1U);
+
+  // A pass that changed the function but preserved the alias analyses keeps
+  // the results object, but not the cached results.
+  PreservedAnalyses PA;
+  PA.preserve<TargetLibraryAnalysis>();
+  PA.preserve<TestCustomAAAnalysis>();
+  PA.preserve<AAManager>();
+  FAM.invalidate(*F, PA);
+  ASSERT_EQ(&FAM.getResult<AAManager>(*F), &AAR);
+  EXPECT_EQ(AAR.alias(A1, A2), MayAlias);
+  EXPECT_EQ(NumQueries, 2U);
+}
+
 class AAPassInfraTest : public testing::Test {
 protected:
   LLVMContext C;
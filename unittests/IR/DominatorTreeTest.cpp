@@ -251,6 +251,172 @@ namespace llvm {
       Passes.add(P);
       Passes.run(*M);
     }
+
+    TEST(DominatorTree, BatchedUpdates) {
+      const char *ModuleString =
+        "define void @f(i1 %c) {\n"
+        "entry:\n"
+        "  br i1 %c, label %a, label %b\n"
+        "a:\n"
+        "  br label %exit\n"
+        "b:\n"
+        "  br label %exit\n"
+        "exit:\n"
+        "  ret void\n"
+        "}\n";
+      LLVMContext Context;
+      SMDiagnostic Err;
+      std::unique_ptr<Module> M = parseAssemblyString(ModuleString, Err,
+                                                      Context);
+      ASSERT_TRUE(M != nullptr);
+      Function *F = M->getFunction("f");
+      Function::iterator FI = F->begin();
+      BasicBlock *Entry = &*FI++;
+      BasicBlock *A = &*FI++;
+      BasicBlock *B = &*FI++;
+      BasicBlock *Exit = &*FI++;
+      Value *Cond = &*F->arg_begin();
+
+      DominatorTree DT(*F);
+      PostDominatorTree PDT;
+      PDT.recalculate(*F);
+
+      auto ExpectUpToDate = [&]() {
+        DominatorTree FreshDT(*F);
+        EXPECT_FALSE(DT.compare(FreshDT));
+        PostDominatorTree FreshPDT;
+        FreshPDT.recalculate(*F);
+        EXPECT_FALSE(PDT.compare(FreshPDT));
+      };
+
+      // Delete entry -> b; b becomes unreachable.
+      Entry->getTerminator()->eraseFromParent();
+      BranchInst::Create(A, Entry);
+      DT.deleteEdge(Entry, B);
+      PDT.deleteEdge(Entry, B);
+      EXPECT_TRUE(DT.hasPendingUpdates());
+      EXPECT_FALSE(DT.isReachableFromEntry(B));
+      EXPECT_FALSE(DT.hasPendingUpdates());
+      EXPECT_TRUE(DT.dominates(A, Exit));
+      ExpectUpToDate();
+
+      // Insert it again; a no longer dominates exit.
+      Entry->getTerminator()->eraseFromParent();
+      BranchInst::Create(A, B, Cond, Entry);
+      DT.insertEdge(Entry, B);
+      PDT.insertEdge(Entry, B);
+      EXPECT_FALSE(DT.dominates(A, Exit));
+      EXPECT_EQ(DT.getNode(Exit)->getIDom()->getBlock(), Entry);
+      ExpectUpToDate();
+
+      // Insert a -> b, which does not change dominance.
+      A->getTerminator()->eraseFromParent();
+      BranchInst::Create(Exit, B, Cond, A);
+      DT.insertEdge(A, B);
+      PDT.insertEdge(A, B);
+      ExpectUpToDate();
+
+      // An insertion and deletion of the same edge cancel out.
+      DT.applyUpdates({{DominatorTree::UpdateKind::Insert, B, A},
+                       {DominatorTree::UpdateKind::Delete, B, A}});
+      PDT.insertEdge(B, A);
+      PDT.deleteEdge(B, A);
+      DT.flush();
+      EXPECT_FALSE(DT.hasPendingUpdates());
+      ExpectUpToDate();
+    }
+
+    // Apply batches of pseudo-random edge insertions and deletions to a small
+    // CFG, and check after each batch that the incrementally updated trees
+    // match freshly computed ones.
+    TEST(DominatorTree, IncrementalUpdatesMatchRecalculation) {
+      const unsigned NumBlocks = 12;
+      LLVMContext Context;
+      Module M("m", Context);
+      IntegerType *I32 = Type::getInt32Ty(Context);
+      Function *F = Function::Create(
+          FunctionType::get(Type::getVoidTy(Context), {I32}, false),
+          GlobalValue::ExternalLinkage, "f", &M);
+      Value *X = &*F->arg_begin();
+
+      std::vector<BasicBlock *> Blocks;
+      std::vector<std::vector<BasicBlock *>> Succs(NumBlocks);
+      for (unsigned i = 0; i != NumBlocks; ++i)
+        Blocks.push_back(BasicBlock::Create(Context, "", F));
+
+      // Blocks without successors return, the others switch on %x.
+      auto SetTerminator = [&](unsigned i) {
+        BasicBlock *BB = Blocks[i];
+        if (TerminatorInst *TI = BB->getTerminator())
+          TI->eraseFromParent();
+        if (Succs[i].empty()) {
+          ReturnInst::Create(Context, BB);
+          return;
+        }
+        SwitchInst *SI =
+            SwitchInst::Create(X, Succs[i][0], Succs[i].size() - 1, BB);
+        for (unsigned j = 1; j != Succs[i].size(); ++j)
+          SI->addCase(ConstantInt::get(I32, j), Succs[i][j]);
+      };
+
+      // Start with a chain, so that most blocks are reachable.
+      for (unsigned i = 0; i + 1 != NumBlocks; ++i)
+        Succs[i].push_back(Blocks[i + 1]);
+      for (unsigned i = 0; i != NumBlocks; ++i)
+        SetTerminator(i);
+
+      DominatorTree DT(*F);
+      PostDominatorTree PDT;
+      PDT.recalculate(*F);
+
+      auto ExpectLevelsValid = [](const DomTreeNode *Root) {
+        SmallVector<const DomTreeNode *, 16> WorkList(1, Root);
+        EXPECT_EQ(Root->getLevel(), 0u);
+        while (!WorkList.empty()) {
+          const DomTreeNode *N = WorkList.pop_back_val();
+          for (const DomTreeNode *C : *N) {
+            EXPECT_EQ(C->getLevel(), N->getLevel() + 1);
+            WorkList.push_back(C);
+          }
+        }
+      };
+
+      uint32_t Seed = 42;
+      auto Random = [&Seed](unsigned N) {
+        Seed = Seed * 1103515245 + 12345;
+        return (Seed >> 16) % N;
+      };
+
+      for (unsigned Batch = 0; Batch != 300; ++Batch) {
+        for (unsigned k = 0, e = 1 + Random(4); k != e; ++k) {
+          // Nothing branches back to the entry block.
+          unsigned From = Random(NumBlocks);
+          unsigned To = 1 + Random(NumBlocks - 1);
+          auto &FromSuccs = Succs[From];
+          auto I = std::find(FromSuccs.begin(), FromSuccs.end(), Blocks[To]);
+          if (I != FromSuccs.end()) {
+            FromSuccs.erase(I);
+            DT.deleteEdge(Blocks[From], Blocks[To]);
+            PDT.deleteEdge(Blocks[From], Blocks[To]);
+          } else {
+            FromSuccs.push_back(Blocks[To]);
+            DT.insertEdge(Blocks[From], Blocks[To]);
+            PDT.insertEdge(Blocks[From], Blocks[To]);
+          }
+          SetTerminator(From);
+        }
+
+        DominatorTree FreshDT(*F);
+        EXPECT_FALSE(DT.compare(FreshDT)) << "after batch " << Batch;
+        ExpectLevelsValid(DT.getRootNode());
+
+        PostDominatorTree FreshPDT;
+        FreshPDT.recalculate(*F);
+        EXPECT_FALSE(PDT.compare(FreshPDT)) << "after batch " << Batch;
+        if (PDT.getRootNode())
+          ExpectLevelsValid(PDT.getRootNode());
+      }
+    }
   }
 }
 
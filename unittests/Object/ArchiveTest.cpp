@@ -0,0 +1,165 @@
+//===- ArchiveTest.cpp - Tests for Archive.cpp ----------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/Archive.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+struct TestSymbol {
+  const char *Name;
+  unsigned Member;
+};
+
+static void writeMemberHeader(raw_ostream &OS, StringRef Name, size_t Size) {
+  OS << left_justify(Name, 16) << left_justify("0", 12) << left_justify("0", 6)
+     << left_justify("0", 6) << left_justify("644", 8)
+     << left_justify(std::to_string(Size), 10) << "`\n";
+}
+
+static void writeBE32(raw_ostream &OS, uint32_t V) {
+  OS << char(V >> 24) << char(V >> 16) << char(V >> 8) << char(V);
+}
+
+// Builds a GNU archive with the members "a.o", "b.o" and "c.o", each holding
+// four bytes of data, and a symbol table with Symbols in the given order.
+// Without symbols, the archive has no symbol table.
+static std::string makeArchive(ArrayRef<TestSymbol> Symbols) {
+  const unsigned NumMembers = 3;
+  const size_t MemberSize = 60 + 4;
+
+  std::string SymTab;
+  if (!Symbols.empty()) {
+    size_t SymTabSize = 4 + 4 * Symbols.size();
+    for (const TestSymbol &Sym : Symbols)
+      SymTabSize += strlen(Sym.Name) + 1;
+    size_t FirstMember = 8 + 60 + SymTabSize + (SymTabSize & 1);
+
+    raw_string_ostream OS(SymTab);
+    writeBE32(OS, Symbols.size());
+    for (const TestSymbol &Sym : Symbols)
+      writeBE32(OS, FirstMember + Sym.Member * MemberSize);
+    for (const TestSymbol &Sym : Symbols)
+      OS << Sym.Name << '\0';
+  }
+
+  std::string Archive;
+  raw_string_ostream OS(Archive);
+  OS << "!<arch>\n";
+  if (!SymTab.empty()) {
+    writeMemberHeader(OS, "/", SymTab.size());
+    OS << SymTab;
+    if (SymTab.size() & 1)
+      OS << '\n';
+  }
+  for (unsigned I = 0; I != NumMembers; ++I) {
+    writeMemberHeader(OS, std::string(1, 'a' + I) + ".o/", 4);
+    OS << "data";
+  }
+  return OS.str();
+}
+
+static std::unique_ptr<Archive> createArchive(StringRef Data) {
+  Expected<std::unique_ptr<Archive>> ArchiveOrErr =
+      Archive::create(MemoryBufferRef(Data, "test.a"));
+  if (!ArchiveOrErr) {
+    consumeError(ArchiveOrErr.takeError());
+    return nullptr;
+  }
+  return std::move(*ArchiveOrErr);
+}
+
+static std::string getMemberName(const Optional<Archive::Child> &C) {
+  if (!C)
+    return "<none>";
+  Expected<StringRef> NameOrErr = C->getName();
+  if (!NameOrErr) {
+    consumeError(NameOrErr.takeError());
+    return "<error>";
+  }
+  return *NameOrErr;
+}
+
+static std::string findMember(const Archive &A, StringRef Name) {
+  Expected<Optional<Archive::Child>> ChildOrErr = A.findSym(Name);
+  if (!ChildOrErr) {
+    consumeError(ChildOrErr.takeError());
+    return "<error>";
+  }
+  return getMemberName(*ChildOrErr);
+}
+
+TEST(ArchiveTest, FindSym) {
+  std::string Data = makeArchive({{"foo", 0}, {"bar", 1}, {"baz", 2}});
+  std::unique_ptr<Archive> A = createArchive(Data);
+  ASSERT_TRUE(A != nullptr);
+  ASSERT_TRUE(A->hasSymbolTable());
+
+  EXPECT_EQ("a.o", findMember(*A, "foo"));
+  EXPECT_EQ("b.o", findMember(*A, "bar"));
+  EXPECT_EQ("c.o", findMember(*A, "baz"));
+  EXPECT_EQ("<none>", findMember(*A, "qux"));
+  EXPECT_EQ("<none>", findMember(*A, "fo"));
+}
+
+TEST(ArchiveTest, FindSymFirstDefinitionWins) {
+  // Both b.o and c.o define dup; the symbol table lists b.o first, so that
+  // is what a linear scan of the table would return.
+  std::string Data = makeArchive({{"dup", 1}, {"foo", 0}, {"dup", 2}});
+  std::unique_ptr<Archive> A = createArchive(Data);
+  ASSERT_TRUE(A != nullptr);
+
+  EXPECT_EQ("b.o", findMember(*A, "dup"));
+  EXPECT_EQ("a.o", findMember(*A, "foo"));
+}
+
+TEST(ArchiveTest, FindSymWithoutSymbolTable) {
+  std::string Data = makeArchive({});
+  std::unique_ptr<Archive> A = createArchive(Data);
+  ASSERT_TRUE(A != nullptr);
+  ASSERT_FALSE(A->hasSymbolTable());
+
+  EXPECT_EQ("<none>", findMember(*A, "foo"));
+
+  Expected<std::vector<Optional<Archive::Child>>> MembersOrErr =
+      A->findSyms({"foo", "bar"});
+  ASSERT_TRUE(bool(MembersOrErr));
+  ASSERT_EQ(2u, MembersOrErr->size());
+  EXPECT_FALSE((*MembersOrErr)[0]);
+  EXPECT_FALSE((*MembersOrErr)[1]);
+}
+
+TEST(ArchiveTest, FindSyms) {
+  std::string Data =
+      makeArchive({{"foo", 0}, {"bar", 1}, {"dup", 1}, {"dup", 2}});
+  std::unique_ptr<Archive> A = createArchive(Data);
+  ASSERT_TRUE(A != nullptr);
+
+  Expected<std::vector<Optional<Archive::Child>>> MembersOrErr =
+      A->findSyms({"bar", "missing", "dup", "foo", "bar"});
+  ASSERT_TRUE(bool(MembersOrErr));
+  std::vector<Optional<Archive::Child>> &Members = *MembersOrErr;
+  ASSERT_EQ(5u, Members.size());
+  EXPECT_EQ("b.o", getMemberName(Members[0]));
+  EXPECT_EQ("<none>", getMemberName(Members[1]));
+  EXPECT_EQ("b.o", getMemberName(Members[2]));
+  EXPECT_EQ("a.o", getMemberName(Members[3]));
+  EXPECT_EQ("b.o", getMemberName(Members[4]));
+
+  Expected<std::vector<Optional<Archive::Child>>> NoneOrErr = A->findSyms({});
+  ASSERT_TRUE(bool(NoneOrErr));
+  EXPECT_TRUE(NoneOrErr->empty());
+}
+
+} // end anonymous namespace
@@ -0,0 +1,214 @@
+//===- ELFObjectFileTest.cpp - Tests for ELFObjectFile.h ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/Object/ELFObjectFile.h"
+#include "gtest/gtest.h"
+#include <cstring>
+
+using namespace llvm;
+using namespace llvm::object;
+
+namespace {
+
+typedef ELF64LE::Ehdr Elf_Ehdr;
+typedef ELF64LE::Shdr Elf_Shdr;
+
+struct TestSection {
+  const char *Name;
+  uint32_t Type;
+  uint32_t Info;
+};
+
+// Builds a little-endian ELF64 file of type \p Type with the given sections
+// after the null section, followed by .shstrtab. The sections have no
+// contents; section I has the address I * 0x100 so that tests can tell them
+// apart.
+static std::string makeELF(ArrayRef<TestSection> Sections,
+                           uint16_t Type = ELF::ET_REL) {
+  std::string StrTab(1, '\0');
+  std::vector<uint32_t> NameOffsets;
+  for (const TestSection &Sec : Sections) {
+    NameOffsets.push_back(StrTab.size());
+    StrTab += Sec.Name;
+    StrTab += '\0';
+  }
+  uint32_t ShStrTabName = StrTab.size();
+  StrTab += ".shstrtab";
+  StrTab += '\0';
+
+  uint64_t StrTabOffset = sizeof(Elf_Ehdr);
+  uint64_t ShOffset = alignTo(StrTabOffset + StrTab.size(), 8);
+  unsigned NumSections = Sections.size() + 2;
+
+  std::string Data(ShOffset + NumSections * sizeof(Elf_Shdr), '\0');
+  Elf_Ehdr Header;
+  memset(&Header, 0, sizeof(Header));
+  memcpy(Header.e_ident, ELF::ElfMagic, strlen(ELF::ElfMagic));
+  Header.e_ident[ELF::EI_CLASS] = ELF::ELFCLASS64;
+  Header.e_ident[ELF::EI_DATA] = ELF::ELFDATA2LSB;
+  Header.e_ident[ELF::EI_VERSION] = ELF::EV_CURRENT;
+  Header.e_type = Type;
+  Header.e_machine = ELF::EM_X86_64;
+  Header.e_version = ELF::EV_CURRENT;
+  Header.e_ehsize = sizeof(Elf_Ehdr);
+  Header.e_shentsize = sizeof(Elf_Shdr);
+  Header.e_shoff = ShOffset;
+  Header.e_shnum = NumSections;
+  Header.e_shstrndx = NumSections - 1;
+  memcpy(&Data[0], &Header, sizeof(Header));
+  memcpy(&Data[StrTabOffset], StrTab.data(), StrTab.size());
+
+  std::vector<Elf_Shdr> Shdrs(NumSections);
+  memset(Shdrs.data(), 0, NumSections * sizeof(Elf_Shdr));
+  for (unsigned I = 0, E = Sections.size(); I != E; ++I) {
+    Elf_Shdr &Shdr = Shdrs[I + 1];
+    Shdr.sh_name = NameOffsets[I];
+    Shdr.sh_type = Sections[I].Type;
+    Shdr.sh_info = Sections[I].Info;
+    Shdr.sh_addr = (I + 1) * 0x100;
+    if (Shdr.sh_type == ELF::SHT_REL)
+      Shdr.sh_entsize = sizeof(ELF64LE::Rel);
+    else if (Shdr.sh_type == ELF::SHT_RELA)
+      Shdr.sh_entsize = sizeof(ELF64LE::Rela);
+  }
+  Elf_Shdr &ShStrTab = Shdrs.back();
+  ShStrTab.sh_name = ShStrTabName;
+  ShStrTab.sh_type = ELF::SHT_STRTAB;
+  ShStrTab.sh_offset = StrTabOffset;
+  ShStrTab.sh_size = StrTab.size();
+  memcpy(&Data[ShOffset], Shdrs.data(), NumSections * sizeof(Elf_Shdr));
+  return Data;
+}
+
+static std::unique_ptr<ELFObjectFileBase> createObject(StringRef Data) {
+  ErrorOr<std::unique_ptr<ObjectFile>> ObjOrErr =
+      ObjectFile::createELFObjectFile(MemoryBufferRef(Data, "test.o"));
+  if (!ObjOrErr)
+    return nullptr;
+  return std::unique_ptr<ELFObjectFileBase>(
+      cast<ELFObjectFileBase>(ObjOrErr->release()));
+}
+
+// Returns the addresses of Sections, which identify them.
+static std::vector<uint64_t> getAddresses(ArrayRef<SectionRef> Sections) {
+  std::vector<uint64_t> Addresses;
+  for (const SectionRef &Sec : Sections)
+    Addresses.push_back(Sec.getAddress());
+  return Addresses;
+}
+
+TEST(ELFObjectFileTest, RelocationSections) {
+  std::string Data = makeELF({{".text", ELF::SHT_PROGBITS, 0},       // 1
+                              {".data", ELF::SHT_PROGBITS, 0},       // 2
+                              {".rel.text", ELF::SHT_REL, 1},        // 3
+                              {".rela.data", ELF::SHT_RELA, 2},      // 4
+                              {".rela.text", ELF::SHT_RELA, 1},      // 5
+                              {".rela.bad", ELF::SHT_RELA, 1000},    // 6
+                              {".rela.null", ELF::SHT_RELA, 0},      // 7
+                              {".bss", ELF::SHT_NOBITS, 0}});        // 8
+  std::unique_ptr<ELFObjectFileBase> Obj = createObject(Data);
+  ASSERT_TRUE(Obj != nullptr);
+
+  std::vector<SectionRef> Sections(Obj->section_begin(), Obj->section_end());
+  ASSERT_EQ(10u, Sections.size());
+
+  // Several relocation sections apply to .text; they come in section table
+  // order, each matching getRelocatedSection().
+  ArrayRef<SectionRef> TextRels = Obj->getRelocationSections(Sections[1]);
+  EXPECT_EQ(std::vector<uint64_t>({0x300, 0x500}), getAddresses(TextRels));
+  for (const SectionRef &RelSec : TextRels)
+    EXPECT_EQ(Sections[1], *RelSec.getRelocatedSection());
+
+  EXPECT_EQ(std::vector<uint64_t>({0x400}),
+            getAddresses(Obj->getRelocationSections(Sections[2])));
+  EXPECT_EQ(std::vector<uint64_t>({0x700}),
+            getAddresses(Obj->getRelocationSections(Sections[0])));
+
+  // A relocation section whose sh_info is out of range applies to nothing.
+  for (const SectionRef &Sec : Sections)
+    for (const SectionRef &RelSec : Obj->getRelocationSections(Sec))
+      EXPECT_NE(0x600u, RelSec.getAddress());
+
+  EXPECT_TRUE(Obj->getRelocationSections(Sections[3]).empty());
+  EXPECT_TRUE(Obj->getRelocationSections(Sections[8]).empty());
+}
+
+TEST(ELFObjectFileTest, NoRelocationSectionsOutsideRelocatableFiles) {
+  // Like getRelocatedSection(), the index only applies to ET_REL files.
+  std::string Data = makeELF({{".text", ELF::SHT_PROGBITS, 0},
+                              {".rela.text", ELF::SHT_RELA, 1}},
+                             ELF::ET_EXEC);
+  std::unique_ptr<ELFObjectFileBase> Obj = createObject(Data);
+  ASSERT_TRUE(Obj != nullptr);
+
+  std::vector<SectionRef> Sections(Obj->section_begin(), Obj->section_end());
+  ASSERT_EQ(4u, Sections.size());
+  EXPECT_TRUE(Obj->getRelocationSections(Sections[1]).empty());
+}
+
+TEST(ELFObjectFileTest, FindSectionByName) {
+  std::string Data = makeELF({{".text", ELF::SHT_PROGBITS, 0},   // 1
+                              {".opd", ELF::SHT_PROGBITS, 0},    // 2
+                              {".text", ELF::SHT_PROGBITS, 0},   // 3
+                              {".rela.opd", ELF::SHT_RELA, 2},   // 4
+                              {".opd", ELF::SHT_PROGBITS, 0},    // 5
+                              {".rela.opd", ELF::SHT_RELA, 5}}); // 6
+  std::unique_ptr<ELFObjectFileBase> Obj = createObject(Data);
+  ASSERT_TRUE(Obj != nullptr);
+
+  // With duplicate names, the first section wins.
+  section_iterator Text = Obj->findSectionByName(".text");
+  ASSERT_NE(Obj->section_end(), Text);
+  EXPECT_EQ(0x100u, Text->getAddress());
+  EXPECT_EQ(std::vector<uint64_t>({0x100, 0x300}),
+            getAddresses(Obj->findSectionsByName(".text")));
+
+  ArrayRef<SectionRef> OPDs = Obj->findSectionsByName(".opd");
+  EXPECT_EQ(std::vector<uint64_t>({0x200, 0x500}), getAddresses(OPDs));
+  ASSERT_EQ(2u, OPDs.size());
+  EXPECT_EQ(std::vector<uint64_t>({0x400}),
+            getAddresses(Obj->getRelocationSections(OPDs[0])));
+  EXPECT_EQ(std::vector<uint64_t>({0x600}),
+            getAddresses(Obj->getRelocationSections(OPDs[1])));
+
+  section_iterator ShStrTab = Obj->findSectionByName(".shstrtab");
+  ASSERT_NE(Obj->section_end(), ShStrTab);
+  EXPECT_EQ(0u, ShStrTab->getAddress());
+
+  EXPECT_EQ(Obj->section_end(), Obj->findSectionByName(".missing"));
+  EXPECT_TRUE(Obj->findSectionsByName(".missing").empty());
+  EXPECT_EQ(Obj->section_end(), Obj->findSectionByName(".tex"));
+}
+
+TEST(ELFObjectFileTest, RelocationSectionsForSeveralSections) {
+  // The relocation sections come in the reverse order of the sections they
+  // apply to, and span more than 256 bytes of section headers.
+  std::string Data = makeELF({{".opd", ELF::SHT_PROGBITS, 0},       // 1
+                              {".opd", ELF::SHT_PROGBITS, 0},       // 2
+                              {".opd", ELF::SHT_PROGBITS, 0},       // 3
+                              {".text", ELF::SHT_PROGBITS, 0},      // 4
+                              {".rela.opd", ELF::SHT_RELA, 3},      // 5
+                              {".rela.text", ELF::SHT_RELA, 4},     // 6
+                              {".rela.opd", ELF::SHT_RELA, 2},      // 7
+                              {".rela.opd", ELF::SHT_RELA, 1},      // 8
+                              {".rela.opd", ELF::SHT_RELA, 3}});    // 9
+  std::unique_ptr<ELFObjectFileBase> Obj = createObject(Data);
+  ASSERT_TRUE(Obj != nullptr);
+
+  EXPECT_EQ(std::vector<uint64_t>({0x500, 0x700, 0x800, 0x900}),
+            getAddresses(Obj->getRelocationSectionsFor(
+                Obj->findSectionsByName(".opd"))));
+
+  ArrayRef<SectionRef> Texts = Obj->findSectionsByName(".text");
+  EXPECT_EQ(std::vector<uint64_t>({0x600}),
+            getAddresses(Obj->getRelocationSectionsFor(Texts)));
+  EXPECT_TRUE(Obj->getRelocationSectionsFor(None).empty());
+}
+
+} // end anonymous namespace
@@ -579,6 +579,39 @@ TEST_P(CoverageMappingTest, skip_duplicate_function_record) {
   ASSERT_EQ(1U, NumFuncs);
 }
 
+TEST_P(CoverageMappingTest, get_covered_functions_for_file) {
+  InstrProfRecord Record1("func1", 0x1234, {1});
+  InstrProfRecord Record2("func2", 0x2345, {2});
+  InstrProfRecord Record3("func3", 0x3456, {3});
+  NoError(ProfileWriter.addRecord(std::move(Record1)));
+  NoError(ProfileWriter.addRecord(std::move(Record2)));
+  NoError(ProfileWriter.addRecord(std::move(Record3)));
+
+  startFunction("func1", 0x1234);
+  addCMR(Counter::getCounter(0), "file1", 1, 1, 9, 9);
+  startFunction("func2", 0x2345);
+  addCMR(Counter::getCounter(0), "file2", 1, 1, 9, 9);
+  startFunction("func3", 0x3456);
+  addCMR(Counter::getCounter(0), "file1", 11, 1, 19, 9);
+
+  loadCoverageMapping();
+
+  std::vector<std::string> Names;
+  for (const auto &Func : LoadedCoverage->getCoveredFunctions("file1"))
+    Names.push_back(Func.Name);
+  ASSERT_EQ(2U, Names.size());
+  EXPECT_EQ("func1", Names[0]);
+  EXPECT_EQ("func3", Names[1]);
+
+  auto Funcs = LoadedCoverage->getCoveredFunctions("file3");
+  EXPECT_EQ(Funcs.begin(), Funcs.end());
+
+  CoverageData Data = LoadedCoverage->getCoverageForFile("file2");
+  std::vector<CoverageSegment> Segments(Data.begin(), Data.end());
+  ASSERT_EQ(2U, Segments.size());
+  EXPECT_EQ(CoverageSegment(1, 1, 2, true), Segments[0]);
+}
+
 // FIXME: Use ::testing::Combine() when llvm updates its copy of googletest.
 INSTANTIATE_TEST_CASE_P(ParameterizedCovMapTest, CoverageMappingTest,
                         ::testing::Values(std::pair<bool, bool>({false, false}),
@@ -140,6 +140,43 @@ TEST_P(MaybeSparseInstrProfTest, get_function_counts) {
   ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, std::move(E2)));
 }
 
+TEST_P(MaybeSparseInstrProfTest, get_instr_prof_record_view) {
+  InstrProfRecord Record1("foo", 0x1234, {1, 2});
+  InstrProfRecord Record2("foo", 0x1235, {3, 4, 5});
+  Record1.reserveSites(IPVK_IndirectCallTarget, 1);
+  InstrProfValueData VD0[] = {{1000, 1}, {2000, 2}};
+  Record1.addValueData(IPVK_IndirectCallTarget, 0, VD0, 2, nullptr);
+  NoError(Writer.addRecord(std::move(Record1)));
+  NoError(Writer.addRecord(std::move(Record2)));
+  auto Profile = Writer.writeBuffer();
+  readProfile(std::move(Profile));
+
+  InstrProfRecordView View;
+  ASSERT_TRUE(NoError(Reader->getInstrProfRecordView("foo", 0x1235, View)));
+  ASSERT_EQ(StringRef("foo"), View.Name);
+  ASSERT_EQ(0x1235U, View.Hash);
+  ASSERT_EQ(3U, View.Counts.size());
+  ASSERT_EQ(3U, View.Counts[0]);
+  ASSERT_EQ(5U, View.Counts[2]);
+
+  ASSERT_TRUE(NoError(Reader->getInstrProfRecordView("foo", 0x1234, View)));
+  ASSERT_EQ(2U, View.Counts.size());
+  ASSERT_EQ(1U, View.Counts[0]);
+  ASSERT_EQ(2U, View.Counts[1]);
+
+  InstrProfRecord R;
+  ASSERT_TRUE(NoError(View.materialize(R)));
+  ASSERT_EQ(2U, R.Counts.size());
+  ASSERT_EQ(1U, R.getNumValueSites(IPVK_IndirectCallTarget));
+  ASSERT_EQ(2U, R.getNumValueDataForSite(IPVK_IndirectCallTarget, 0));
+
+  Error E1 = Reader->getInstrProfRecordView("foo", 0x5678, View);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::hash_mismatch, std::move(E1)));
+
+  Error E2 = Reader->getInstrProfRecordView("bar", 0x1234, View);
+  ASSERT_TRUE(ErrorEquals(instrprof_error::unknown_function, std::move(E2)));
+}
+
 // Profile data is copied from general.proftext
 TEST_F(InstrProfTest, get_profile_summary) {
   InstrProfRecord Record1("func1", 0x1234, {97531});
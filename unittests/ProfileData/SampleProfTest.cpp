@@ -9,6 +9,7 @@
 
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Instructions.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
@@ -168,6 +169,101 @@ TEST_F(SampleProfTest, roundtrip_binary_profile) {
   testRoundTrip(SampleProfileFormat::SPF_Binary);
 }
 
+TEST_F(SampleProfTest, compact_binary_profile_on_demand) {
+  createWriter(SampleProfileFormat::SPF_Compact_Binary);
+
+  StringRef FooName("_Z3fooi");
+  FunctionSamples FooSamples;
+  FooSamples.setName(FooName);
+  FooSamples.addTotalSamples(7711);
+  FooSamples.addHeadSamples(610);
+  FooSamples.addBodySamples(1, 0, 610);
+  FooSamples.addCalledTargetSamples(1, 0, "_Z3bari", 600);
+
+  StringRef BarName("_Z3bari");
+  FunctionSamples BarSamples;
+  BarSamples.setName(BarName);
+  BarSamples.addTotalSamples(20301);
+  BarSamples.addHeadSamples(1437);
+  BarSamples.addBodySamples(1, 0, 1437);
+
+  StringMap<FunctionSamples> Profiles;
+  Profiles[FooName] = std::move(FooSamples);
+  Profiles[BarName] = std::move(BarSamples);
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  // Without a module, every function is read.
+  auto Profile = MemoryBuffer::getMemBufferCopy(Data);
+  readProfile(Profile);
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_EQ(2u, Reader->getProfiles().size());
+
+  // With a module, only the functions it defines are read.
+  Module M("my_module", Context);
+  FunctionType *FTy = FunctionType::get(Type::getVoidTy(Context), false);
+  Function *Foo =
+      Function::Create(FTy, GlobalValue::ExternalLinkage, FooName, &M);
+  ReturnInst::Create(Context, BasicBlock::Create(Context, "entry", Foo));
+  Function::Create(FTy, GlobalValue::ExternalLinkage, BarName, &M);
+
+  Profile = MemoryBuffer::getMemBufferCopy(Data);
+  readProfile(Profile);
+  Reader->collectFuncsToUse(M);
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_EQ(1u, Reader->getProfiles().size());
+
+  FunctionSamples *ReadFooSamples = Reader->getSamplesFor(*Foo);
+  ASSERT_EQ(7711u, ReadFooSamples->getTotalSamples());
+  ASSERT_EQ(610u, ReadFooSamples->getHeadSamples());
+  const SampleRecord &Rec = ReadFooSamples->getBodySamples().begin()->second;
+  ASSERT_EQ(610u, Rec.getSamples());
+  const auto &CallTargets = Rec.getCallTargets();
+  ASSERT_EQ(1u, CallTargets.size());
+  ASSERT_EQ(SampleProfileReaderCompactBinary::getMD5Name(BarName),
+            CallTargets.begin()->first());
+}
+
+TEST_F(SampleProfTest, compact_binary_profile_rewrite) {
+  createWriter(SampleProfileFormat::SPF_Compact_Binary);
+
+  // A name made of digits is still a name, and gets hashed like any other.
+  StringRef DigitsName("12345");
+  FunctionSamples DigitsSamples;
+  DigitsSamples.setName(DigitsName);
+  DigitsSamples.addTotalSamples(100);
+  DigitsSamples.addHeadSamples(10);
+  DigitsSamples.addBodySamples(1, 0, 10);
+
+  StringMap<FunctionSamples> Profiles;
+  Profiles[DigitsName] = std::move(DigitsSamples);
+  ASSERT_TRUE(NoError(Writer->write(Profiles)));
+  Writer->getOutputStream().flush();
+
+  auto Profile = MemoryBuffer::getMemBufferCopy(Data);
+  readProfile(Profile);
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_TRUE(Reader->useMD5());
+  std::string MD5Name =
+      SampleProfileReaderCompactBinary::getMD5Name(DigitsName);
+  ASSERT_EQ(1u, Reader->getProfiles().count(MD5Name));
+
+  // Writing the profiles that were read back keeps their hashes.
+  std::unique_ptr<SampleProfileReader> FirstReader = std::move(Reader);
+  Data.clear();
+  OS.reset(new raw_string_ostream(Data));
+  createWriter(SampleProfileFormat::SPF_Compact_Binary);
+  Writer->setUseMD5();
+  ASSERT_TRUE(NoError(Writer->write(FirstReader->getProfiles())));
+  Writer->getOutputStream().flush();
+
+  Profile = MemoryBuffer::getMemBufferCopy(Data);
+  readProfile(Profile);
+  ASSERT_TRUE(NoError(Reader->read()));
+  ASSERT_EQ(1u, Reader->getProfiles().size());
+  ASSERT_EQ(100u, Reader->getProfiles()[MD5Name].getTotalSamples());
+}
+
 TEST_F(SampleProfTest, sample_overflow_saturation) {
   const uint64_t Max = std::numeric_limits<uint64_t>::max();
   sampleprof_error Result;
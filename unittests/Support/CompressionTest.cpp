@@ -59,6 +59,45 @@ TEST(CompressionTest, Zlib) {
   TestZlibCompression(BinaryDataStr, zlib::DefaultCompression);
 }
 
+void TestZlibParallelCompression(StringRef Input, size_t ChunkSize) {
+  SmallString<32> Serial;
+  SmallString<32> Parallel;
+  SmallString<32> Uncompressed;
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Input, Serial, zlib::DefaultCompression, 1,
+                                   ChunkSize));
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::compressParallel(Input, Parallel, zlib::DefaultCompression,
+                                   4, ChunkSize));
+  // The stream doesn't depend on the number of threads.
+  EXPECT_EQ(Serial, Parallel);
+  EXPECT_EQ(zlib::StatusOK,
+            zlib::uncompress(Parallel, Uncompressed, Input.size()));
+  EXPECT_EQ(Input, Uncompressed);
+}
+
+TEST(CompressionTest, ZlibParallel) {
+  TestZlibParallelCompression("", 16);
+  TestZlibParallelCompression("hello, world!", 16);
+
+  std::string Data;
+  for (unsigned I = 0; I < 100000; ++I)
+    Data += "line " + std::to_string(I % 1000) + "\n";
+  TestZlibParallelCompression(Data, 1 << 20);
+  TestZlibParallelCompression(Data, 65536);
+  TestZlibParallelCompression(Data, 1000);
+  TestZlibParallelCompression(StringRef(Data).substr(0, 4096), 1);
+
+  // Priming each chunk with the preceding input keeps the ratio close to
+  // compressing in one piece.
+  SmallString<32> Whole, Chunked;
+  EXPECT_EQ(zlib::StatusOK, zlib::compress(Data, Whole));
+  EXPECT_EQ(zlib::StatusOK, zlib::compressParallel(
+                                Data, Chunked, zlib::DefaultCompression, 2,
+                                65536));
+  EXPECT_LT(Chunked.size(), Whole.size() * 11 / 10);
+}
+
 TEST(CompressionTest, ZlibCRC32) {
   EXPECT_EQ(
       0x414FA339U,